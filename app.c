@@ -35,6 +35,27 @@
 #include <unistd.h>
 #include "app.h"
 #include "app_gattdb.h"
+#include "app_link_stats.h"
+#include "app_adv_cache.h"
+#include "app_async.h"
+#include "app_adv_sets.h"
+#include "app_adv_steps.h"
+#include "app_chmap.h"
+#include "app_cust.h"
+#include "app_daemon.h"
+#include "app_dtm_model.h"
+#include "app_events.h"
+#include "app_gatt_ping.h"
+#include "app_l2cap.h"
+#include "app_link_test.h"
+#include "app_metrics.h"
+#include "app_profile.h"
+#include "app_rx_segments.h"
+#include "app_security.h"
+#include "app_shutdown.h"
+#include "app_survey.h"
+#include "app_time.h"
+#include "app_transport.h"
 #include "ncp_host.h"
 #include "app_log.h"
 #include "app_log_cli.h"
@@ -77,16 +98,51 @@
 "  --fwver_get                 Read FW revision string from Device Information (GATT)\n"\
 "  --adv                       Enter an advertisement mode with scan response for TIS/TRP chamber and connection testing (default period = 100ms)\n"\
 "  --adv_period  <period>      Set advertising period for the advertisement mode, in units of 0.625ms\n"\
+"  --adv_sets <N>              Run N advertising sets in the advertisement mode, set 0 connectable and the others non-connectable, 1-8 (default 1)\n"\
+"  --adv_set <index>:<interval>[:<phy>[:<power>[:<data>]]]  Configure a set of --adv_sets: interval in units of 0.625ms, PHY 1:1M, 2:2M, 4:Coded, power in 0.1dBm, data in ASCII hex\n"\
+"  --adv_steps <power>:<interval>:<dwell ms>[,...]  Step TX power (0.1dBm) and interval (0.625ms units) of the advertisement mode in-session, exit after the last step. '@<file>' reads the steps from a file\n"\
 "  --cust <ASCII hex string>   Allows verification/running custom BGAPI commands. Example of ASCII hex string: a50102feed\n"\
+"  --cust_script <file>        Run custom BGAPI user messages from a script file ('-' for stdin), one hex payload and optional expected response per line\n"\
+"  --cust_depth <depth>        Number of custom script messages kept in flight, 1-16 (default 1)\n"\
 "  --phy  <PHY selection for test packets/waveforms/RX mode, 1:1Mbps, 2:2Mbps, 3:125k LR coded, 4:500k LR coded.>\n"\
 "  --advscan                   Return RSSI, channel, and MAC address for advertisement scan results\n"\
 "  --advscan=<MAC>             Set optional MAC address for advertising scan filtering, e.g. 01:02:03:04:05:06\n"\
 "  --rssi_avg <number of packets to include in RSSI average reports for advscan>\n"\
+"  --adv_dedup <new|changed|stats>  Suppress repeated advscan reports: print new advertisers only, new or changed payloads, or only the per-advertiser statistics at exit\n"\
+"  --adv_window <ms>           Time after which a repeated advertiser is reported as new again (default 5000)\n"\
+"  --adv_cache <entries>       Number of advertisers tracked by --adv_dedup, least recently seen evicted first (default 256, max 1024)\n"\
+"  --scan_phy <scan PHY for advscan, 1:1M, 4:Coded, 5:1M and Coded (default 1)>\n"\
+"  --scan_interval <interval>  Set the advscan scan interval, in units of 0.625ms (default 16)\n"\
+"  --scan_window <window>      Set the advscan scan window, in units of 0.625ms, at most the scan interval (default 16)\n"\
+"  --scan_active               Scan actively in advscan mode, sending scan requests\n"\
 "  --conn=<MAC>                Connect as central to 48-bit MAC address, e.g. 01:02:03:04:05:06\n"\
 "  --conn_int <conn interval>  Set connection interval for central connection, in units of 1.25ms\n"\
+"  --conn_latency <events>     Set the peripheral latency for central connection, 0-499 connection events (default 0)\n"\
 "  --coex                      Enable coexistence on the target if available\n"\
 "  --throughput <0 or 1>       Push dummy throughput data when connected as central to another unit running BLEtest as an advertiser, with ack (1) or without ack (0)\n"\
-"  --report  <interval>        Print the channel map and throughput (if applicable) at the specified interval in milliseconds\n"
+"  --report  <interval>        Print the channel map and throughput (if applicable) and sample the link layer packet counters at the specified interval in milliseconds\n"\
+"  --gatt_profile <file>       Build the GATT database of the advertisement mode from a profile file instead of the built-in one\n"\
+"  --metrics_json <file>       Write test results as JSON Lines to a file ('-' for stdout, other output goes to stderr) at each report, DTM completion and exit\n"\
+"  --metrics_prom <file>       Write test results to a Prometheus textfile collector file at each report, DTM completion and exit\n"\
+"  --profile[=<N>]             Time each BGAPI command and count events by ID, print the top N (default 10) at exit\n"\
+"  --pipeline <depth>          Keep up to depth BGAPI commands in flight for GATT database and advertiser setup and the throughput sender, 1-16 (default 1)\n"\
+"  --event_batch <N>           Dispatch up to N pending BGAPI events per main loop pass from a preallocated pool, 1-1024\n"\
+"  --fast_io                   Buffer the NCP link I/O in BLEtest: large reads, outgoing frames written together\n"\
+"  --link_test[=<N>]           Measure the NCP link with N (default 200) user messages per phase: round trip time, bytes per second each way, UART load, and whether the link or the radio limits throughput\n"\
+"  --baud_detect               Probe the serial port at the -b rate and then at standard rates from 3000000 down, continue at the rate the NCP answers at\n"\
+"  --rx_segment <ms>           With --rx, end and restart DTM receive every ms milliseconds (10-30000) and print the packets per segment at exit\n"\
+"  --per_ref_time <ms>         With --rx, time the reference transmitter sends with the same --len and --phy, print the packet error rate with its 95%% confidence interval\n"\
+"  --per_limit <percent>       With --per_ref_time, print PASS or FAIL against this packet error rate and exit with an error on FAIL\n"\
+"  --survey[=<ms>]             Hop DTM receive over all 40 channels with ms (default 20) dwells plus a scanner window per sweep, print a live occupancy line per sweep and the channels without DTM/adv traffic seen at exit\n"\
+"  --l2cap                     With --conn, push throughput data over an L2CAP connection-oriented channel instead of GATT writes; with --adv, accept the channel and count the data\n"\
+"  --l2cap_mtu <bytes>         Largest SDU received on the L2CAP channel, 23-65535 (default 1024)\n"\
+"  --l2cap_mps <bytes>         Largest K-frame payload received on the L2CAP channel, 23-65533 (default 247)\n"\
+"  --l2cap_credits <N>         K-frames the peer may send before credits are returned, at least one SDU worth (default 16)\n"\
+"  --encrypt <jw|sc>           Encrypt connections: pair with Just Works (jw) or require LE Secure Connections (sc); the central starts throughput once the link is encrypted and the advertiser requires encryption for the throughput characteristics\n"\
+"  --bond                      With --encrypt, store the keys; the central then reconnects once to time encryption with the stored keys\n"\
+"  --gatt_ping <count>         With --conn, time count GATT round trips, alternating reads and writes with response of a few bytes, and print a round trip histogram in connection intervals\n"\
+"  --fast_start                Skip the NCP reset at startup if the NCP responds and can be returned to idle in place\n"\
+"  --daemon <socket path>      Keep the NCP session open and accept test commands on a Unix domain socket (send \"help\" for the command list)\n"
 
   #define LONG_OPT_VERSION 0
   #define LONG_OPT_TIME 1
@@ -111,6 +167,40 @@
   #define LONG_OPT_COEX 20u
   #define LONG_OPT_THROUGHPUT 21u
   #define LONG_OPT_REPORT 22u
+  #define LONG_OPT_CUST_SCRIPT 23u
+  #define LONG_OPT_CUST_DEPTH 24u
+  #define LONG_OPT_FAST_START 25u
+  #define LONG_OPT_GATT_PROFILE 26u
+  #define LONG_OPT_METRICS_JSON 27u
+  #define LONG_OPT_METRICS_PROM 28u
+  #define LONG_OPT_ADV_DEDUP 29u
+  #define LONG_OPT_ADV_WINDOW 30u
+  #define LONG_OPT_ADV_CACHE 31u
+  #define LONG_OPT_SCAN_PHY 32u
+  #define LONG_OPT_SCAN_INTERVAL 33u
+  #define LONG_OPT_SCAN_WINDOW 34u
+  #define LONG_OPT_SCAN_ACTIVE 35u
+  #define LONG_OPT_ADV_SETS 36u
+  #define LONG_OPT_ADV_SET 37u
+  #define LONG_OPT_ADV_STEPS 38u
+  #define LONG_OPT_PROFILE 39u
+  #define LONG_OPT_PIPELINE 40u
+  #define LONG_OPT_EVENT_BATCH 41u
+  #define LONG_OPT_FAST_IO 42u
+  #define LONG_OPT_LINK_TEST 43u
+  #define LONG_OPT_BAUD_DETECT 44u
+  #define LONG_OPT_RX_SEGMENT 45u
+  #define LONG_OPT_PER_REF_TIME 46u
+  #define LONG_OPT_PER_LIMIT 47u
+  #define LONG_OPT_SURVEY 48u
+  #define LONG_OPT_L2CAP 49u
+  #define LONG_OPT_L2CAP_MTU 50u
+  #define LONG_OPT_L2CAP_MPS 51u
+  #define LONG_OPT_L2CAP_CREDITS 52u
+  #define LONG_OPT_ENCRYPT 53u
+  #define LONG_OPT_BOND 54u
+  #define LONG_OPT_GATT_PING 55u
+  #define LONG_OPT_CONN_LATENCY 56u
 
   static struct option long_options[] = {
              {"version",    no_argument,       0,  LONG_OPT_VERSION },
@@ -135,6 +225,41 @@
              {"coex",       no_argument,       0,  LONG_OPT_COEX },
              {"throughput", required_argument, 0,  LONG_OPT_THROUGHPUT},
              {"report",     required_argument, 0,  LONG_OPT_REPORT},
+             {"cust_script",required_argument, 0,  LONG_OPT_CUST_SCRIPT},
+             {"cust_depth", required_argument, 0,  LONG_OPT_CUST_DEPTH},
+             {"daemon",     required_argument, 0,  LONG_OPT_DAEMON},
+             {"fast_start", no_argument,       0,  LONG_OPT_FAST_START},
+             {"gatt_profile",required_argument,0,  LONG_OPT_GATT_PROFILE},
+             {"metrics_json",required_argument,0,  LONG_OPT_METRICS_JSON},
+             {"metrics_prom",required_argument,0,  LONG_OPT_METRICS_PROM},
+             {"adv_dedup",  required_argument, 0,  LONG_OPT_ADV_DEDUP},
+             {"adv_window", required_argument, 0,  LONG_OPT_ADV_WINDOW},
+             {"adv_cache",  required_argument, 0,  LONG_OPT_ADV_CACHE},
+             {"scan_phy",   required_argument, 0,  LONG_OPT_SCAN_PHY},
+             {"scan_interval",required_argument,0, LONG_OPT_SCAN_INTERVAL},
+             {"scan_window",required_argument, 0,  LONG_OPT_SCAN_WINDOW},
+             {"scan_active",no_argument,       0,  LONG_OPT_SCAN_ACTIVE},
+             {"adv_sets",   required_argument, 0,  LONG_OPT_ADV_SETS},
+             {"adv_set",    required_argument, 0,  LONG_OPT_ADV_SET},
+             {"adv_steps",  required_argument, 0,  LONG_OPT_ADV_STEPS},
+             {"profile",    optional_argument, 0,  LONG_OPT_PROFILE},
+             {"pipeline",   required_argument, 0,  LONG_OPT_PIPELINE},
+             {"event_batch",required_argument, 0,  LONG_OPT_EVENT_BATCH},
+             {"fast_io",    no_argument,       0,  LONG_OPT_FAST_IO},
+             {"link_test",  optional_argument, 0,  LONG_OPT_LINK_TEST},
+             {"baud_detect",no_argument,       0,  LONG_OPT_BAUD_DETECT},
+             {"rx_segment", required_argument, 0,  LONG_OPT_RX_SEGMENT},
+             {"per_ref_time",required_argument,0,  LONG_OPT_PER_REF_TIME},
+             {"per_limit",  required_argument, 0,  LONG_OPT_PER_LIMIT},
+             {"survey",     optional_argument, 0,  LONG_OPT_SURVEY},
+             {"l2cap",      no_argument,       0,  LONG_OPT_L2CAP},
+             {"l2cap_mtu",  required_argument, 0,  LONG_OPT_L2CAP_MTU},
+             {"l2cap_mps",  required_argument, 0,  LONG_OPT_L2CAP_MPS},
+             {"l2cap_credits",required_argument,0, LONG_OPT_L2CAP_CREDITS},
+             {"encrypt",    required_argument, 0,  LONG_OPT_ENCRYPT},
+             {"bond",       no_argument,       0,  LONG_OPT_BOND},
+             {"gatt_ping",  required_argument, 0,  LONG_OPT_GATT_PING},
+             {"conn_latency",required_argument,0,  LONG_OPT_CONN_LATENCY},
              {0,           0,                 0,  0  }};
 
 // The advertising set handle allocated from Bluetooth stack.
@@ -197,6 +322,8 @@ static uint8_t selected_phy=DEFAULT_PHY;
 static uint16_t adv_period = TEST_ADV_INTERVAL_MS_DEFAULT/ADV_INTERVAL_UNIT;
 static uint8_t adv_data[] = {0x02, 0x01, 0x06, 0x03, 0x03, 0x02, 0x18}; //LE general discoverable, FIND ME service (0x1802)
 /* 20 byte length, 0x09 (full name), "Blue Gecko Test App" */
+static uint8_t adv_set_count = 1; //number of advertising sets in the advertisement mode
+static size_t adv_step_index = 0; //current step of the --adv_steps schedule
 static uint8_t scan_rsp_data[] = {20,0x09,0x42,0x6c,0x75,0x65,0x20,0x47,0x65,0x63,0x6b,0x6f,0x20,0x54,0x65,0x73,0x74,0x20,0x41,0x70,0x70};
 
 /* flash write state machine */
@@ -219,11 +346,16 @@ static enum app_states {
   dtm_tx_started,
   default_state,
   verify_custom_bgapi,
+  run_custom_script,
   advscan_wait,
   advscan_run,
   conn_initiate,
   conn_pending,
-  connected
+  connected,
+  link_self_test,
+  survey_begin,
+  survey_run,
+  daemon_idle
 } app_state =   default_state;
 
 /*
@@ -232,10 +364,15 @@ static enum app_states {
 enum throughput_states {
   THROUGHPUT_NONE,   // default state
   THROUGHPUT_CONNECT,
+  THROUGHPUT_ENCRYPT, // waiting for link encryption
   THROUGHPUT_FIND_SERVICES,  // find throughput service
   THROUGHPUT_FIND_CHARACTERISTICS,  // find throughput control&data attributes
   THROUGHPUT_NOACK,  // Running throughput test no ACK
   THROUGHPUT_ACK,   // Running throughput test with ACK
+  THROUGHPUT_PING,  // Running GATT round trip test
+  THROUGHPUT_L2CAP_OPEN, // opening the L2CAP channel
+  THROUGHPUT_L2CAP,      // Running throughput test over L2CAP, sending
+  THROUGHPUT_L2CAP_RX,   // Running throughput test over L2CAP, receiving
 } throughput_state = THROUGHPUT_NONE;
 void throughput_change_state(enum throughput_states new_state);
 
@@ -263,10 +400,13 @@ uint64_t bletest_throughput_total_bytes = 0;
 void timer_on_report(void);
 
 #define REPORT_TIMER_HANDLE 42u //random number for timer handle
+#define ADV_STEP_TIMER_HANDLE 43u //timer handle of the --adv_steps schedule
+#define CONN_TIMER_HANDLE 44u //timer handle of the daemon connection timeout
 
-#define MAX_CUST_BGAPI_STRING_LEN  16u
-uint8_t cust_bgapi_data[MAX_CUST_BGAPI_STRING_LEN/2]; //half of string length due to ascii hex data in string
+uint8_t cust_bgapi_data[APP_CUST_MAX_PAYLOAD_LEN];
 size_t cust_bgapi_len; //how many bytes in cust_bgapi_data
+static char *cust_script_path; //custom BGAPI script file, "-" for stdin
+static uint8_t cust_depth = 1u; //custom BGAPI script messages in flight
 
 #define CTUNE_PSKEY_LENGTH	2u
 #define MAX_CTUNE_VALUE 511u
@@ -285,6 +425,54 @@ static uint32_t scan_counter; //scan result count
 static uint32_t rssi_len; //number of packets to average
 static int32_t rssi_sum; //signed sum of RSSI
 static uint32_t rssi_count;
+/* advscan duplicate suppression */
+static enum adv_dedup_modes {
+  adv_dedup_off,
+  adv_dedup_new,      // print the first report of each advertiser
+  adv_dedup_changed,  // also print reports with a changed payload
+  adv_dedup_stats     // print nothing but the statistics at exit
+} adv_dedup_mode = adv_dedup_off;
+static uint32_t adv_window_ms = 5000;
+static uint32_t adv_cache_size = 256;
+/* scanner settings */
+#define SCAN_TIMING_DEFAULT 16u //10 ms scan interval and window
+#define SCAN_TIMING_MIN 4u
+#define SCAN_TIMING_MAX 0x4000u
+#define SCAN_UNIT_MS 0.625
+static uint8_t scan_phy = sl_bt_scanner_scan_phy_1m;
+static uint8_t scan_mode = sl_bt_scanner_scan_mode_passive;
+static uint16_t scan_interval = SCAN_TIMING_DEFAULT;
+static uint16_t scan_window = SCAN_TIMING_DEFAULT;
+/* capture statistics, counted after the MAC filter */
+#define ADV_REPORT_EXTENDED 0x01u
+#define ADV_REPORT_CODED 0x02u     //received on the Coded primary PHY
+#define ADV_REPORT_TRUNCATED 0x04u //extended report with incomplete data
+static uint32_t scan_extended_count;
+static uint32_t scan_coded_count;
+static uint32_t scan_truncated_count;
+static int64_t scan_start_us;
+/* chained extended advertising data, joined into one report */
+#define ADV_DATA_MAX_LEN 1650
+static struct {
+  bool active;
+  bd_addr address;
+  uint8_t address_type;
+  uint8_t adv_sid;
+  uint8_t channel;
+  int8_t rssi;
+  uint8_t flags;
+  size_t len;
+  uint8_t data[ADV_DATA_MAX_LEN];
+} adv_chain;
+static sl_status_t start_scanner(void);
+static void print_scan_capture(void);
+static void on_adv_report(const bd_addr *address, uint8_t address_type,
+                          uint8_t channel, int8_t rssi, uint8_t flags,
+                          const uint8_t *data, size_t len);
+static void on_extended_adv_report(const bd_addr *address, uint8_t address_type,
+                                   uint8_t adv_sid, uint8_t channel, int8_t rssi,
+                                   uint8_t flags, uint8_t data_completeness,
+                                   const uint8array *data);
 
 static size_t ctune_ret_len;
 
@@ -305,34 +493,144 @@ static uint8_t timeout_count=0;
 static uint16_t conn_interval=CONN_INTERVAL_DEFAULT; //connection interval for central connection
 #define SUP_TIMEOUT_FACTOR 4u   //how many connection intervals pass before timeout occurs
 #define SUP_TIMEOUT_VAL_MIN 10u //minimum timeout value in API
+#define SUP_TIMEOUT_VAL_MAX 3200u //maximum timeout value in API
+#define CONN_LATENCY_MAX 499u
+static uint16_t conn_latency=0; //peripheral latency for central connection
 
 static uint8_t coex_enabled=false;
 
 static uint16_t map_interval_ms=0;
+static int64_t link_interval_start_us=0; //start of the current link counter interval
+static app_link_stats_coex_t coex_last; //coex counters at the start of the interval
+static uint8_t coex_last_valid=false;
+static sl_status_t read_coex_counters(app_link_stats_coex_t *coex_counters);
+static void sample_link_counters(float throughput_bps);
+
+/* metrics export */
+static char *metrics_json_path; //JSON Lines output, NULL unless --metrics_json
+static char *metrics_prom_path; //Prometheus textfile, NULL unless --metrics_prom
+static unsigned profile_top = 0; //rows of the BGAPI profile, 0 unless --profile
+static uint8_t pipeline_depth = 1; //BGAPI commands in flight, 1 for synchronous commands
+static uint16_t event_batch = 0; //events dispatched per main loop pass, 0 unless --event_batch
+static uint8_t fast_io = false; //buffered NCP link I/O instead of the SDK transport
+static uint16_t link_test_count; //user messages per link self-test phase
+static uint8_t baud_detect = false; //probe for the NCP baud rate at startup
+static uint8_t serial_link = false; //NCP on a serial port (-u) rather than TCP
+static uint32_t link_baud = 115200; //serial port rate, the ncp_host default unless -b
+static void publish_dtm_result(uint16_t packets);
+
+/* DTM packet model */
+static uint32_t per_ref_time_ms = 0; //reference transmitter time for the receive PER, 0 unless --per_ref_time
+static float per_limit = -1; //PER pass/fail limit in percent, negative unless --per_limit
+static int64_t dtm_start_us = 0; //DTM test command sent
+static int64_t dtm_stop_us = 0; //DTM end command sent
+static uint8_t dtm_per_failed = false; //PER above --per_limit
+static void report_dtm_model(uint16_t packets);
+
+/* channel survey */
+#define SURVEY_DWELL_DEFAULT_MS 20u
+#define SURVEY_DWELL_MAX_MS 1000u
+#define SURVEY_SCAN_STEP APP_SURVEY_CHANNELS //step of the scanner window after the DTM dwells
+static uint16_t survey_dwell_ms = 0; //DTM dwell per channel, 0 unless --survey
+static uint8_t survey_step = 0; //RF channel of the DTM dwell, or SURVEY_SCAN_STEP
+static int64_t survey_step_start_us = 0; //receiver or scanner started, 0 while starting
+static int64_t survey_step_stop_us = 0; //DTM end command sent, 0 while receiving
+static void survey_start_step(uint8_t step);
+static void on_survey_dtm_completed(uint16_t packets);
+
+/* L2CAP throughput */
+#define L2CAP_SEND_BURST 8u //SDUs sent per main loop pass at most
+static uint8_t l2cap_enabled = false; //throughput over an L2CAP channel
+static uint16_t l2cap_mtu = APP_L2CAP_MTU_DEFAULT;
+static uint16_t l2cap_mps = APP_L2CAP_MPS_DEFAULT;
+static uint16_t l2cap_credits = APP_L2CAP_CREDITS_DEFAULT;
+static void on_l2cap_closed(uint16_t cid);
+static void start_throughput(void);
+static bool throughput_running(void);
+
+/* link encryption */
+#define SM_CONFIG_SC_ONLY 0x04u //sl_bt_sm_configure() flag, no legacy pairing
+static enum encrypt_modes {
+  encrypt_none,
+  encrypt_jw, // Just Works, legacy or Secure Connections as the peer supports
+  encrypt_sc  // LE Secure Connections only
+} encrypt_mode = encrypt_none;
+static uint8_t bond_enabled = false; //store keys, and time a bonded reconnect as central
+static uint8_t bond_reconnect_pending = false; //closed after bonding, waiting to re-encrypt
+static uint8_t bond_reconnect_done = false; //bonded reconnect measured, or skipped
+static uint8_t encrypt_failed = false; //pairing failed
+static void configure_security(void);
+static void on_link_encrypted(void);
+static void on_bonded(uint8_t bonding);
+
+/* GATT round trip test */
+#define GATT_PING_PAYLOAD_LEN 4u
+static uint32_t gatt_ping_count = 0; //round trips to time, 0 unless --gatt_ping
+static uint32_t gatt_ping_sent = 0; //round trips started
+static int64_t gatt_ping_start_us = 0; //command of the round trip in flight sent
+static void gatt_ping_send(void);
+static void on_gatt_ping_completed(uint16_t result);
+
+/* segmented DTM receive */
+#define RX_SEGMENT_MIN_MS 10u
+#define RX_SEGMENT_MAX_MS 30000u //keeps the 16-bit packet count from wrapping
+static uint32_t rx_segment_ms = 0; //DTM receive segment length, 0 unless --rx_segment
+static int64_t rx_segment_start_us = 0; //receiver started, 0 while DTM restarts
+static int64_t rx_segment_stop_us = 0; //end command of the segment sent, 0 while receiving
+static int64_t rx_segment_gap_us = 0; //receiver off before the current segment
+static int64_t rx_test_end_us = 0; //end of the segmented test, 0 in infinite mode
+static void on_rx_segment_started(void);
+static void on_rx_segment_completed(uint16_t packets);
+static void add_rx_segment(uint16_t packets);
+static void finish_rx_segments(void);
+
+/* daemon mode */
+static char *daemon_socket_path; //control socket, NULL unless --daemon
+static uint8_t daemon_active=false; //true once the control socket is open
+/* daemon requests answered by a later event */
+static enum daemon_ops {
+  daemon_op_none,
+  daemon_op_dtm,
+  daemon_op_conn,
+  daemon_op_disconnect,
+  daemon_op_reset
+} daemon_op = daemon_op_none;
+static int64_t daemon_dtm_end_us=0; //end time of a timed daemon DTM request, 0 if none
+#define DAEMON_CONN_TIMEOUT_MS 10000u //give up a daemon conn request after this long
+static uint8_t daemon_conn_timed_out=false; //pending daemon connection closed by the timeout
+static void daemon_start(void);
+
+/* startup accounting */
+static uint8_t fast_start=false; //try to reuse the running NCP instead of resetting it
+static uint32_t ncp_reset_count=0; //number of NCP resets issued by this run
+static uint8_t ncp_boot_seen=false; //NCP booted during this run, so no GATT database of an earlier run is left
+static int64_t startup_time_us=0; //monotonic time at app_init
+#define FAST_START_MAX_ADV_SETS 8u //advertising sets to clean up on fast start
+#define FAST_START_MAX_CONNECTIONS 32u //connection handles to close on fast start, the stack maximum; the NCP configuration isn't visible to the host
+#define FAST_START_DRAIN_US 50000 //quiet time ending the fast start cleanup
+#define GATTDB_STATE_PREFIX "/tmp/bletest_gattdb_" //host-side layout of the committed GATT database, per NCP link
+static char *ncp_link_name = "default"; //-u or -t argument, names the GATT database state file
+static void ncp_reset(void);
+static sl_status_t ncp_fast_start(void);
 
 static void print_address(bd_addr address);
 static void initiate_connection(void);
+static sl_status_t open_connection(void);
+static sl_status_t start_advertising(void);
+static void apply_adv_step(size_t index);
 void print_packet_counters(void);
 void print_coex_counters(void);
 
 static int64_t cur_time_us(void);
 
-unsigned int toInt(char c) {
-  /* Convert ASCII hex to binary, return -1 if error */
-  if (c >= '0' && c <= '9') {
-    return      c - '0';
-  } else if (c >= 'A' && c <= 'F') {
-    return 10 + c - 'A';
-  } else if (c >= 'a' && c <= 'f') {
-    return 10 + c - 'a';
-  } else {
-    return -1; //error
-  }
-
-}
-
 // Initialize GATT database dynamically.
 static void initialize_gatt_database(void);
+static void ensure_gatt_database(void);
+static const char *gattdb_state_path(void);
+static uint8_t gattdb_ready = false; //GATT database set up since the last NCP boot
+
+// Common setup once the NCP is ready.
+static void on_ncp_ready(void);
 
 static void main_app_handler(void);
 
@@ -347,11 +645,9 @@ void app_init(int argc, char *argv[])
   char *temp;
   uint8_t i; //local counter variable
   int values[8]; //local vars for bluetooth address
+  int value; //numeric option value before range checks
 
-  /* locals for custom bgapi string */
-  uint8_t string_len;
-  int8_t upper_nib;
-  int8_t lower_nib;
+  startup_time_us = app_time_mono_us();
 
   // Process command line options.
   while ((opt = getopt_long(argc, argv, OPTSTRING, long_options, &option_index)) != -1) {
@@ -468,27 +764,32 @@ void app_init(int argc, char *argv[])
 
       case LONG_OPT_CUST:
         /* Verify custom BGAPI by sending a custom BGAPI command and printing the response */
-        string_len = strlen(optarg);
-        cust_bgapi_len = string_len/2;
-        if (string_len > MAX_CUST_BGAPI_STRING_LEN)
-        {
-          printf("String too long in -b argument: string length %zu, max = %d\n",strlen(optarg),MAX_CUST_BGAPI_STRING_LEN);
+        sc = app_cust_parse_hex(optarg, cust_bgapi_data, sizeof(cust_bgapi_data), &cust_bgapi_len);
+        if (sc == SL_STATUS_WOULD_OVERFLOW) {
+          printf("String too long in --cust argument: string length %zu, max = %d\n",strlen(optarg),2*APP_CUST_MAX_PAYLOAD_LEN);
+          exit(EXIT_FAILURE);
+        } else if (sc != SL_STATUS_OK) {
+          /* Problem with conversion - print error and exit */
+          printf("Error! \"%s\" is an invalid ascii hex string. The characters need to be A-F, a-f, or 0-9.\n",optarg);
           exit(EXIT_FAILURE);
         }
+        app_state = verify_custom_bgapi;
+        break;
 
-        for (i=0; i != cust_bgapi_len; i++) {
-          /* Convert arg string (e.g. "040101") to binary data */
-          upper_nib = toInt(optarg[2*i]);
-          lower_nib = toInt(optarg[2*i+1]);
-          if (lower_nib < 0 || upper_nib < 0) {
-            /* Problem with conversion - print error and exit */
-            printf("Error! \"%s\" is an invalid ascii hex string. The characters need to be A-F, a-f, or 0-9.\n",optarg);
-            exit(EXIT_FAILURE);
-          } else {
-            cust_bgapi_data[i] = (uint8_t) (16*upper_nib) + lower_nib;
-          }
+      case LONG_OPT_CUST_SCRIPT:
+        /* Run a script of custom BGAPI commands in one session */
+        cust_script_path = optarg;
+        app_state = run_custom_script;
+        break;
+
+      case LONG_OPT_CUST_DEPTH:
+        /* number of custom script commands in flight */
+        value = atoi(optarg);
+        if (value < 1 || value > (int)APP_CUST_MAX_DEPTH) {
+          printf("Error in cust_depth: must be in the range 1-%d\n", (int)APP_CUST_MAX_DEPTH);
+          exit(EXIT_FAILURE);
         }
-        app_state = verify_custom_bgapi;
+        cust_depth = (uint8_t)value;
         break;
 
       case LONG_OPT_PHY:
@@ -529,6 +830,71 @@ void app_init(int argc, char *argv[])
         }
         break;
 
+      case LONG_OPT_ADV_DEDUP:
+        if (strcmp(optarg, "new") == 0) {
+          adv_dedup_mode = adv_dedup_new;
+        } else if (strcmp(optarg, "changed") == 0) {
+          adv_dedup_mode = adv_dedup_changed;
+        } else if (strcmp(optarg, "stats") == 0) {
+          adv_dedup_mode = adv_dedup_stats;
+        } else {
+          printf("Error in adv_dedup: mode must be new, changed or stats\n");
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case LONG_OPT_ADV_WINDOW:
+        value = atoi(optarg);
+        if (value < 1) {
+          printf("Error in adv_window: must be a positive number of milliseconds\n");
+          exit(EXIT_FAILURE);
+        }
+        adv_window_ms = (uint32_t)value;
+        break;
+
+      case LONG_OPT_ADV_CACHE:
+        adv_cache_size = atoi(optarg);
+        if (adv_cache_size < 1 || adv_cache_size > APP_ADV_CACHE_MAX_ENTRIES) {
+          printf("Error in adv_cache: must be in the range 1-%d\n", APP_ADV_CACHE_MAX_ENTRIES);
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case LONG_OPT_SCAN_PHY:
+        scan_phy = atoi(optarg);
+        if (scan_phy != sl_bt_scanner_scan_phy_1m && scan_phy != sl_bt_scanner_scan_phy_coded
+            && scan_phy != sl_bt_scanner_scan_phy_1m_and_coded) {
+          printf("Error! Invalid scan_phy argument, %s\n", optarg);
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case LONG_OPT_SCAN_INTERVAL:
+        value = (int)strtol(optarg, &temp, 0);
+        if (*optarg == '\0' || *temp != '\0'
+            || value < (int)SCAN_TIMING_MIN || value > (int)SCAN_TIMING_MAX) {
+          printf("Error in scan_interval: must be in the range %u-0x%x\n",
+                 SCAN_TIMING_MIN, SCAN_TIMING_MAX);
+          exit(EXIT_FAILURE);
+        }
+        scan_interval = (uint16_t)value;
+        break;
+
+      case LONG_OPT_SCAN_WINDOW:
+        value = (int)strtol(optarg, &temp, 0);
+        if (*optarg == '\0' || *temp != '\0'
+            || value < (int)SCAN_TIMING_MIN || value > (int)SCAN_TIMING_MAX) {
+          printf("Error in scan_window: must be in the range %u-0x%x\n",
+                 SCAN_TIMING_MIN, SCAN_TIMING_MAX);
+          exit(EXIT_FAILURE);
+        }
+        scan_window = (uint16_t)value;
+        break;
+
+      case LONG_OPT_SCAN_ACTIVE:
+        scan_mode = sl_bt_scanner_scan_mode_active;
+        break;
+
       case LONG_OPT_CONN:
         app_state = conn_initiate;
         /* set bluetooth address */
@@ -553,11 +919,51 @@ void app_init(int argc, char *argv[])
         conn_interval = atoi(optarg);
         break;
 
+      case LONG_OPT_CONN_LATENCY:
+        /* peripheral latency for central connection */
+        if (atoi(optarg) < 0 || atoi(optarg) > (int)CONN_LATENCY_MAX) {
+          printf("Error in conn_latency: must be in the range 0-%u\n", CONN_LATENCY_MAX);
+          exit(EXIT_FAILURE);
+        }
+        conn_latency = atoi(optarg);
+        break;
+
       case LONG_OPT_ADV_PERIOD:
         /* advertising period for advertising mode */
         adv_period = atoi(optarg);
         break;
 
+      case LONG_OPT_ADV_SETS:
+        /* number of concurrent advertising sets */
+        adv_set_count = atoi(optarg);
+        if (adv_set_count < 1 || adv_set_count > APP_ADV_SETS_MAX) {
+          printf("Error in adv_sets: must be in the range 1-%d\n", APP_ADV_SETS_MAX);
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case LONG_OPT_ADV_SET:
+        /* parameters of one of the additional advertising sets */
+        if (app_adv_sets_configure(optarg) != SL_STATUS_OK) {
+          printf("Error in adv_set \"%s\": expected <index 1-%d>:<interval>[:<phy>[:<power>[:<data>]]]\n",
+                 optarg, APP_ADV_SETS_MAX - 1);
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case LONG_OPT_ADV_STEPS:
+        /* TX power and interval schedule for advertising mode */
+        sc = app_adv_steps_parse(optarg);
+        if (sc == SL_STATUS_NOT_FOUND) {
+          printf("Error! Cannot open step schedule \"%s\"\n", optarg + 1);
+          exit(EXIT_FAILURE);
+        } else if (sc != SL_STATUS_OK) {
+          printf("Error in adv_steps \"%s\": expected <power>:<interval 32-65535>:<dwell ms>[,...], at most %d steps\n",
+                 optarg, APP_ADV_STEPS_MAX);
+          exit(EXIT_FAILURE);
+        }
+        break;
+
       case LONG_OPT_COEX:
         /* enable coexistence on the target */
         coex_enabled = true;
@@ -576,8 +982,195 @@ void app_init(int argc, char *argv[])
         map_interval_ms = atoi(optarg);
         break;
 
+      case LONG_OPT_DAEMON:
+        /* keep the session open and serve requests on a control socket */
+        daemon_socket_path = optarg;
+        break;
+
+      case LONG_OPT_FAST_START:
+        /* skip the startup reset if the NCP is already running */
+        fast_start = true;
+        break;
+
+      case LONG_OPT_METRICS_JSON:
+        /* export results as JSON Lines */
+        metrics_json_path = optarg;
+        break;
+
+      case LONG_OPT_METRICS_PROM:
+        /* export results for the Prometheus textfile collector */
+        metrics_prom_path = optarg;
+        break;
+
+      case LONG_OPT_PROFILE:
+        /* profile the BGAPI commands and events */
+        profile_top = APP_PROFILE_TOP_DEFAULT;
+        if (optarg != NULL) {
+          if (atoi(optarg) < 1) {
+            printf("Error in profile: the number of rows must be at least 1\n");
+            exit(EXIT_FAILURE);
+          }
+          profile_top = atoi(optarg);
+        }
+        break;
+
+      case LONG_OPT_PIPELINE:
+        /* pipelined BGAPI commands */
+        if (atoi(optarg) < 1 || atoi(optarg) > APP_ASYNC_MAX_DEPTH) {
+          printf("Error in pipeline: depth must be in the range 1-%d\n", APP_ASYNC_MAX_DEPTH);
+          exit(EXIT_FAILURE);
+        }
+        pipeline_depth = atoi(optarg);
+        break;
+
+      case LONG_OPT_EVENT_BATCH:
+        /* batched event dispatch */
+        if (atoi(optarg) < 1 || atoi(optarg) > APP_EVENTS_MAX_BATCH) {
+          printf("Error in event_batch: must be in the range 1-%d\n", APP_EVENTS_MAX_BATCH);
+          exit(EXIT_FAILURE);
+        }
+        event_batch = atoi(optarg);
+        break;
+
+      case LONG_OPT_FAST_IO:
+        /* buffered NCP link I/O */
+        fast_io = true;
+        break;
+
+      case LONG_OPT_LINK_TEST:
+        /* NCP link self-test */
+        link_test_count = APP_LINK_TEST_COUNT_DEFAULT;
+        if (optarg != NULL) {
+          if (atoi(optarg) < 1 || atoi(optarg) > APP_LINK_TEST_MAX_COUNT) {
+            printf("Error in link_test: count must be in the range 1-%d\n", APP_LINK_TEST_MAX_COUNT);
+            exit(EXIT_FAILURE);
+          }
+          link_test_count = atoi(optarg);
+        }
+        app_state = link_self_test;
+        break;
+
+      case LONG_OPT_RX_SEGMENT:
+        /* segmented DTM receive */
+        rx_segment_ms = atoi(optarg);
+        if (rx_segment_ms < RX_SEGMENT_MIN_MS || rx_segment_ms > RX_SEGMENT_MAX_MS) {
+          printf("Error in rx_segment: must be in the range %u-%u ms\n", RX_SEGMENT_MIN_MS, RX_SEGMENT_MAX_MS);
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case LONG_OPT_PER_REF_TIME:
+        /* receive PER against the packet model */
+        if (atoi(optarg) < 1) {
+          printf("Error in per_ref_time: must be at least 1 ms\n");
+          exit(EXIT_FAILURE);
+        }
+        per_ref_time_ms = atoi(optarg);
+        break;
+
+      case LONG_OPT_PER_LIMIT:
+        /* PER pass/fail limit */
+        per_limit = atof(optarg);
+        if (per_limit < 0 || per_limit > 100) {
+          printf("Error in per_limit: must be in the range 0-100 percent\n");
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case LONG_OPT_SURVEY:
+        /* channel occupancy survey */
+        survey_dwell_ms = SURVEY_DWELL_DEFAULT_MS;
+        if (optarg != NULL) {
+          if (atoi(optarg) < 1 || atoi(optarg) > (int)SURVEY_DWELL_MAX_MS) {
+            printf("Error in survey: dwell must be in the range 1-%u ms\n", SURVEY_DWELL_MAX_MS);
+            exit(EXIT_FAILURE);
+          }
+          survey_dwell_ms = atoi(optarg);
+        }
+        app_state = survey_begin;
+        break;
+
+      case LONG_OPT_L2CAP:
+        /* throughput over an L2CAP connection-oriented channel */
+        l2cap_enabled = true;
+        break;
+
+      case LONG_OPT_L2CAP_MTU:
+        /* L2CAP SDU size */
+        if (atoi(optarg) < APP_L2CAP_MIN_MTU || atoi(optarg) > UINT16_MAX) {
+          printf("Error in l2cap_mtu: must be in the range %d-%d\n", APP_L2CAP_MIN_MTU, UINT16_MAX);
+          exit(EXIT_FAILURE);
+        }
+        l2cap_mtu = atoi(optarg);
+        break;
+
+      case LONG_OPT_L2CAP_MPS:
+        /* L2CAP K-frame size */
+        if (atoi(optarg) < APP_L2CAP_MIN_MPS || atoi(optarg) > APP_L2CAP_MAX_MPS) {
+          printf("Error in l2cap_mps: must be in the range %d-%d\n", APP_L2CAP_MIN_MPS, APP_L2CAP_MAX_MPS);
+          exit(EXIT_FAILURE);
+        }
+        l2cap_mps = atoi(optarg);
+        break;
+
+      case LONG_OPT_L2CAP_CREDITS:
+        /* L2CAP credits given to the peer */
+        if (atoi(optarg) < 1 || atoi(optarg) > UINT16_MAX) {
+          printf("Error in l2cap_credits: must be in the range 1-%d\n", UINT16_MAX);
+          exit(EXIT_FAILURE);
+        }
+        l2cap_credits = atoi(optarg);
+        break;
+
+      case LONG_OPT_ENCRYPT:
+        /* link encryption */
+        if (strcmp(optarg, "jw") == 0) {
+          encrypt_mode = encrypt_jw;
+        } else if (strcmp(optarg, "sc") == 0) {
+          encrypt_mode = encrypt_sc;
+        } else {
+          printf("Error in encrypt: expected jw or sc\n");
+          exit(EXIT_FAILURE);
+        }
+        break;
+
+      case LONG_OPT_BOND:
+        /* store the keys */
+        bond_enabled = true;
+        break;
+
+      case LONG_OPT_GATT_PING:
+        /* GATT round trip test when connecting as a central */
+        if (atoi(optarg) < 1 || atoi(optarg) > APP_GATT_PING_MAX) {
+          printf("Error in gatt_ping: must be in the range 1-%d\n", APP_GATT_PING_MAX);
+          exit(EXIT_FAILURE);
+        }
+        gatt_ping_count = atoi(optarg);
+        break;
+
+      case LONG_OPT_BAUD_DETECT:
+        /* find the NCP baud rate */
+        baud_detect = true;
+        break;
+
+      case LONG_OPT_GATT_PROFILE:
+        /* replace the built-in GATT database layout */
+        if (app_gattdb_load_profile(optarg) != SL_STATUS_OK) {
+          exit(EXIT_FAILURE);
+        }
+        break;
+
       // Process options for other modules.
       default:
+        // note the link type and rate for the link self-test and baud detection
+        if (opt == 'u') {
+          serial_link = true;
+        }
+        if ((opt == 'u' || opt == 't') && optarg != NULL) {
+          ncp_link_name = optarg;
+        } else if (opt == 'b' && optarg != NULL) {
+          link_baud = strtoul(optarg, NULL, 10);
+        }
         sc = ncp_host_set_option((char)opt, optarg);
         if (sc == SL_STATUS_NOT_FOUND) {
           sc = app_log_set_option((char)opt, optarg);
@@ -590,6 +1183,78 @@ void app_init(int argc, char *argv[])
     }
   }
 
+  if (rx_segment_ms != 0 && (app_state != dtm_rx_begin || daemon_socket_path != NULL)) {
+    printf("Error! rx_segment needs --rx and can't be used with --daemon\n");
+    exit(EXIT_FAILURE);
+  }
+
+  if (per_ref_time_ms != 0 && (app_state != dtm_rx_begin || rx_segment_ms != 0)) {
+    printf("Error! per_ref_time needs --rx and can't be used with --rx_segment\n");
+    exit(EXIT_FAILURE);
+  }
+  if (per_limit >= 0 && per_ref_time_ms == 0) {
+    printf("Error! per_limit needs --per_ref_time\n");
+    exit(EXIT_FAILURE);
+  }
+
+  if (l2cap_enabled == true) {
+    if (daemon_socket_path != NULL || (throughput_state != THROUGHPUT_NONE)) {
+      printf("Error! l2cap can't be used with --daemon or --throughput\n");
+      exit(EXIT_FAILURE);
+    }
+    if (l2cap_credits < app_l2cap_min_credits(l2cap_mtu, l2cap_mps)) {
+      printf("Error in l2cap_credits: an SDU of %u bytes needs at least %u credits with an MPS of %u\n",
+             l2cap_mtu, app_l2cap_min_credits(l2cap_mtu, l2cap_mps), l2cap_mps);
+      exit(EXIT_FAILURE);
+    }
+    app_l2cap_configure(l2cap_mtu, l2cap_mps, l2cap_credits);
+  }
+
+  if (gatt_ping_count != 0) {
+    if (throughput_state != THROUGHPUT_NONE || l2cap_enabled == true || daemon_socket_path != NULL) {
+      printf("Error! gatt_ping can't be used with --throughput, --l2cap or --daemon\n");
+      exit(EXIT_FAILURE);
+    }
+    // find the throughput characteristics as for the throughput test
+    throughput_state = THROUGHPUT_CONNECT;
+  }
+  if ((1u + conn_latency) * conn_interval * CONN_INTERVAL_UNIT_MS * 2 >= SUP_TIMEOUT_VAL_MAX * 10) {
+    printf("Error! The connection interval (%d) and latency (%d) are too long for the longest supervision timeout\n",
+           conn_interval, conn_latency);
+    exit(EXIT_FAILURE);
+  }
+
+  if (bond_enabled == true && encrypt_mode == encrypt_none) {
+    printf("Error! bond needs --encrypt\n");
+    exit(EXIT_FAILURE);
+  }
+  if (encrypt_mode != encrypt_none) {
+    if (daemon_socket_path != NULL) {
+      printf("Error! encrypt can't be used with --daemon\n");
+      exit(EXIT_FAILURE);
+    }
+    app_gattdb_require_encryption();
+  }
+
+  if (scan_window > scan_interval) {
+    printf("Error! The scan window (%d) can't be longer than the scan interval (%d)\n",
+           scan_window, scan_interval);
+    exit(EXIT_FAILURE);
+  }
+
+  if (event_batch != 0) {
+    sc = app_events_init(event_batch);
+    app_assert_status(sc);
+  }
+
+  if (metrics_json_path != NULL || metrics_prom_path != NULL) {
+    sc = app_metrics_init(metrics_json_path, metrics_prom_path);
+    if (sc != SL_STATUS_OK) {
+      printf("Error! Cannot open metrics output, result=0x%04X\n", sc);
+      exit(EXIT_FAILURE);
+    }
+  }
+
   // Initialize NCP connection.
   sc = ncp_host_init();
   if (sc == SL_STATUS_INVALID_PARAMETER) {
@@ -597,12 +1262,43 @@ void app_init(int argc, char *argv[])
     exit(EXIT_FAILURE);
   }
   app_assert_status(sc);
+  if (baud_detect == true) {
+    if (serial_link == false) {
+      printf("Error! baud_detect needs a serial port (-u) NCP link\n");
+      exit(EXIT_FAILURE);
+    }
+    printf("Detecting NCP baud rate...\n");
+    sc = app_link_test_detect_baud(link_baud, &link_baud);
+    if (sc == SL_STATUS_ABORT) {
+      return; // interrupted, the main loop runs app_deinit()
+    }
+    if (sc != SL_STATUS_OK) {
+      printf("Error! The NCP did not answer at any baud rate\n");
+      exit(EXIT_FAILURE);
+    }
+    printf("NCP answers at %u baud\n", link_baud);
+  }
+  if (fast_io == true) {
+    app_transport_init();
+  }
+  if (profile_top != 0) {
+    app_profile_init(profile_top);
+  }
+  if (pipeline_depth > 1) {
+    sc = app_async_init(pipeline_depth);
+    app_assert_status(sc);
+  }
 
   printf("\n------------------------\n");
+  if (fast_start == true && ncp_fast_start() == SL_STATUS_OK) {
+    // NCP was already running and is back in a defined state
+    on_ncp_ready();
+    return;
+  }
   printf("Waiting for boot pkt...\n");
   // Reset NCP to ensure it gets into a defined state.
   // Once the chip successfully boots, boot event should be received.
-  sl_bt_system_reset(sl_bt_system_boot_mode_normal);
+  ncp_reset();
 
   /////////////////////////////////////////////////////////////////////////////
   // Put your additional application init code here!                         //
@@ -621,7 +1317,52 @@ void app_process_action(void)
   // Do not call blocking functions from here!                               //
   /////////////////////////////////////////////////////////////////////////////
   sl_status_t sc;
-  if ((app_state == advscan_run || app_state ==  adv_test_advertising || app_state == adv_test_connected ||
+
+  // with --event_batch, handle the events backed up since the last pass
+  app_events_process();
+  if (daemon_active == true) {
+    // serve control socket requests
+    app_daemon_process();
+    if (daemon_dtm_end_us != 0 && cur_time_us() > daemon_dtm_end_us) {
+      // timed DTM request done, the reply is sent by the DTM completed event
+      daemon_dtm_end_us = 0;
+      sc = sl_bt_test_dtm_end();
+      if (sc != SL_STATUS_OK) {
+        app_state = daemon_idle;
+        daemon_op = daemon_op_none;
+        app_daemon_reply(sc, "dtm_end failed");
+      }
+    }
+  } else if (rx_segment_ms != 0 && app_state == dtm_rx_started && rx_segment_stop_us == 0) {
+    // end the segment, the completed event restarts the receiver
+    if (cur_time_us() >= rx_segment_start_us + (int64_t)rx_segment_ms * 1000) {
+      rx_segment_stop_us = cur_time_us();
+      sc = sl_bt_test_dtm_end();
+      app_assert_status(sc);
+    }
+  } else if (app_state == survey_run && survey_step_start_us != 0 && survey_step_stop_us == 0) {
+    // end the dwell, the scanner window counts for all three advertising channels
+    if (cur_time_us() >= survey_step_start_us
+        + (int64_t)survey_dwell_ms * 1000 * (survey_step == SURVEY_SCAN_STEP ? 3 : 1)) {
+      survey_step_stop_us = cur_time_us();
+      if (survey_step < SURVEY_SCAN_STEP) {
+        // the completed event starts the next channel
+        sc = sl_bt_test_dtm_end();
+        app_assert_status(sc);
+      } else {
+        sc = sl_bt_scanner_stop();
+        app_assert_status(sc);
+        app_survey_add_scan_time((uint32_t)(survey_step_stop_us - survey_step_start_us));
+        app_survey_end_sweep();
+        if (duration_usec != 0 && cur_time_us() > start_time_us + duration_usec) {
+          app_state = default_state; // nothing left running
+          app_deinit();
+        } else {
+          survey_start_step(0);
+        }
+      }
+    }
+  } else if ((app_state == advscan_run || app_state ==  adv_test_advertising || app_state == adv_test_connected ||
         app_state == connected) && duration_usec != 0) {
     // Check for advscan, connection, or advertising timeout here (deinit to stop, print, exit)
     if (cur_time_us() > start_time_us + duration_usec ) {
@@ -633,20 +1374,37 @@ void app_process_action(void)
   if (throughput_state == THROUGHPUT_NOACK && bletest_throughput_ack == false ) {
       if (cur_time_us() > last_send_time_us + 1000) {
         // send notifications from central to peripheral if enabled
-        uint16_t bytes_written;
         printf(".");
         fflush(stdout);
-        sc = sl_bt_gatt_write_characteristic_value_without_response(conn_handle,
+        // with --pipeline, the loop doesn't wait for the response
+        sc = app_async_gatt_write_characteristic_value_without_response(conn_handle,
                                                   bletest_throughput_write_no_response_handle,
                                                   sizeof(bletest_throughput_payload_data),
                                                   bletest_throughput_payload_data,
-                                                  &bytes_written);
+                                                  NULL);
+        app_assert_status(sc);
+        sc = app_async_poll();
         app_assert_status(sc);
         last_send_time_us = cur_time_us();
         bletest_throughput_total_bytes += sizeof(bletest_throughput_payload_data);
       }
 
   }
+
+  // over L2CAP, send as fast as the peer returns credits
+  if (throughput_state == THROUGHPUT_L2CAP) {
+    uint32_t sent;
+    for (uint8_t i = 0; i < L2CAP_SEND_BURST; i++) {
+      sc = app_l2cap_send(&sent);
+      app_assert_status(sc);
+      if (sent == 0) {
+        break;
+      }
+      printf(".");
+      bletest_throughput_total_bytes += sent;
+    }
+    fflush(stdout);
+  }
 }
 
 /**************************************************************************//**
@@ -654,111 +1412,183 @@ void app_process_action(void)
  *****************************************************************************/
 void app_deinit(void)
 {
-  time_t start_time;
-  uint8_t exitwhile=false;
+  int64_t deadline_us;
+  uint8_t wait_dtm=false;
+  uint8_t wait_close=false;
   sl_status_t sc;
   sl_bt_msg_t evt;
 
-  /* if DTM is in process, end it prior to closing */
-  if (app_state == dtm_rx_begin || app_state == dtm_tx_begin)
+  app_shutdown_begin();
+  if (daemon_active == true) {
+    app_daemon_deinit();
+  }
+
+  /* start the teardown of the running test, then wait for all of it at once */
+  if (app_state == dtm_rx_begin || app_state == dtm_tx_begin ||
+      app_state == dtm_rx_started || app_state == dtm_tx_started)
   {
+    /* if DTM is in process, end it prior to closing */
     printf("Canceling DTM in progress...\n");
-    start_time = time(NULL);
-    sc = sl_bt_test_dtm_end();
-    app_assert_status(sc);
-    do {
-      sc = sl_bt_pop_event(&evt);
-
-      if (sc == SL_STATUS_OK) {
-        if (SL_BGAPI_MSG_ID(evt.header) == sl_bt_evt_test_dtm_completed_id) {
-          if (app_state == dtm_rx_begin) {
-            // Process dtm_completed thrown when started
-            app_state = dtm_rx_started;
-          } else if (app_state == dtm_tx_begin) {
-            // Process dtm_completed thrown when started
-            app_state = dtm_tx_started;
-          } else if (app_state == dtm_tx_started) {
-          printf("DTM completed, number of packets transmitted: %d\n",evt.data.evt_test_dtm_completed.number_of_packets);
-          exitwhile = true;
-        } else if (app_state == dtm_rx_started) {
-          printf("DTM completed, number of packets received: %d\n",evt.data.evt_test_dtm_completed.number_of_packets);
-          exitwhile = true;
-        } else {
-          printf("sl_bt_evt_test_dtm_completed_id with unknown app state\n");
-          exitwhile = true;
-        }
-        }
-      }
-
-      if ((time(NULL) - start_time) >= CANCEL_TIMEOUT_SECONDS) { //timeout in seconds
-        exitwhile = true;
-      }
-
-    } while (exitwhile == false);
-
+    if (rx_segment_ms == 0 || app_state != dtm_rx_started || rx_segment_stop_us == 0) {
+      rx_segment_stop_us = cur_time_us();
+      dtm_stop_us = rx_segment_stop_us;
+      sc = sl_bt_test_dtm_end();
+      app_assert_status(sc);
+    } // else the end of the segment is already on its way
+    wait_dtm = true;
+  } else if (app_state == survey_run) {
+    // stop the current dwell, its partial result is dropped
+    if (survey_step == SURVEY_SCAN_STEP) {
+      (void)sl_bt_scanner_stop();
+    } else if (survey_step_stop_us == 0) {
+      (void)sl_bt_test_dtm_end();
+    }
   } else if (app_state == advscan_run) {
     // Turn off scan and print the number of scan results received
     printf("Exiting scan mode, total scan packets received = %u\r\n", scan_counter);
+    app_metrics_set_counter("scan_packets", scan_counter);
+    print_scan_capture();
+    app_adv_sets_print_reception();
+    if (adv_dedup_mode != adv_dedup_off) {
+      app_adv_cache_print();
+    }
     sc = sl_bt_scanner_stop();
     app_assert_status(sc);
   } else if (app_state == connected || app_state == adv_test_connected) {
     // clean up connetion if connected
     printf("Disconnecting...\r\n");
-    start_time = time(NULL);
     sc = sl_bt_connection_close(conn_handle);
     app_log_debug("sl_bt_connection_close, status=0x%x\r\n", sc);
-    do {
-      sc = sl_bt_pop_event(&evt);
-      app_log_debug("sl_bt_pop_event, status=0x%x\r\n", sc);
-      if (sc == SL_STATUS_OK) {
-        if (SL_BGAPI_MSG_ID(evt.header) == sl_bt_evt_connection_closed_id) {
-          printf("Disconnected!\r\n");
-          exitwhile = true;
-        }
-      }
-
-      if ((time(NULL) - start_time) >= CANCEL_TIMEOUT_SECONDS) { //timeout in seconds
-        exitwhile = true;
-      }
-
-    } while (exitwhile == false);
-    print_packet_counters();
+    wait_close = (sc == SL_STATUS_OK);
   } else if (app_state == adv_test_advertising) {
     printf("Stopping advertisements...\r\n");
     sc = sl_bt_advertiser_stop(advertising_set_handle);
     app_assert_status(sc);
   }
-  if (app_state == adv_test_connected || app_state == adv_test_advertising || app_state == connected || app_state == conn_pending \
-        || app_state == conn_initiate) {
-    app_log_debug("Supervision timeout count: %d\r\n", timeout_count);
-    if (coex_enabled == true) {
-      /* try to print coex counters */
-      print_coex_counters();
+  if (app_state == adv_test_advertising || app_state == adv_test_connected) {
+    app_adv_sets_stop();
+    if (app_adv_steps_count() != 0) {
+      (void)sl_bt_system_set_lazy_soft_timer(0, 0, ADV_STEP_TIMER_HANDLE, false);
     }
   }
-  ncp_host_deinit();
-
-  /////////////////////////////////////////////////////////////////////////////
-  // Put your additional application deinit code here!                       //
-  // This is called once during termination.                                 //
-  /////////////////////////////////////////////////////////////////////////////
-
-  // Force exit here
-  exit(EXIT_SUCCESS);
-}
 
-/**************************************************************************//**
- * Bluetooth stack event handler.
- * This overrides the dummy weak implementation.
+  deadline_us = app_time_mono_us() + (int64_t)CANCEL_TIMEOUT_SECONDS * 1000000;
+  while (wait_dtm == true || wait_close == true) {
+    if (app_time_mono_us() > deadline_us) {
+      printf("Teardown timed out after %d s:%s%s\n", CANCEL_TIMEOUT_SECONDS,
+             wait_dtm == true ? " no DTM completed event" : "",
+             wait_close == true ? " connection not closed" : "");
+      break;
+    }
+    sc = sl_bt_pop_event(&evt);
+    if (sc != SL_STATUS_OK) {
+      usleep(1000);
+      continue;
+    }
+    switch (SL_BGAPI_MSG_ID(evt.header)) {
+      case sl_bt_evt_test_dtm_completed_id:
+        if (wait_dtm == false) {
+          break;
+        }
+        if (app_state == dtm_rx_begin) {
+          // Process dtm_completed thrown when started
+          app_state = dtm_rx_started;
+        } else if (app_state == dtm_tx_begin) {
+          // Process dtm_completed thrown when started
+          app_state = dtm_tx_started;
+        } else if (app_state == dtm_tx_started) {
+          printf("DTM completed, number of packets transmitted: %d\n",evt.data.evt_test_dtm_completed.number_of_packets);
+          publish_dtm_result(evt.data.evt_test_dtm_completed.number_of_packets);
+          wait_dtm = false;
+        } else if (app_state == dtm_rx_started && rx_segment_ms != 0) {
+          add_rx_segment(evt.data.evt_test_dtm_completed.number_of_packets);
+          wait_dtm = false;
+        } else if (app_state == dtm_rx_started) {
+          printf("DTM completed, number of packets received: %d\n",evt.data.evt_test_dtm_completed.number_of_packets);
+          publish_dtm_result(evt.data.evt_test_dtm_completed.number_of_packets);
+          wait_dtm = false;
+        } else {
+          printf("sl_bt_evt_test_dtm_completed_id with unknown app state\n");
+          wait_dtm = false;
+        }
+        break;
+
+      case sl_bt_evt_connection_closed_id:
+        if (wait_close == true) {
+          printf("Disconnected!\r\n");
+          wait_close = false;
+        }
+        break;
+
+      default:
+        break;
+    }
+  }
+  if (rx_segment_ms != 0) {
+    finish_rx_segments();
+  }
+  if (survey_dwell_ms != 0) {
+    app_survey_print();
+    app_survey_publish();
+  }
+  if (l2cap_enabled == true) {
+    if (app_l2cap_is_open() == true) {
+      app_l2cap_print();
+    }
+    app_l2cap_publish();
+  }
+  if (throughput_running() == true) {
+    // the part since the last report
+    app_security_add_throughput(bletest_throughput_total_bytes, cur_time_us() - last_report_time_us);
+  }
+  if (gatt_ping_count != 0) {
+    app_gatt_ping_print();
+    app_gatt_ping_publish();
+  }
+  app_security_print();
+  if (encrypt_mode != encrypt_none || throughput_state != THROUGHPUT_NONE || l2cap_enabled == true) {
+    app_security_publish();
+  }
+  if (app_state == connected || app_state == adv_test_connected) {
+    print_packet_counters();
+  }
+  if (app_state == adv_test_connected || app_state == adv_test_advertising || app_state == connected || app_state == conn_pending \
+        || app_state == conn_initiate) {
+    app_log_debug("Supervision timeout count: %d\r\n", timeout_count);
+    if (coex_enabled == true) {
+      /* try to print coex counters */
+      print_coex_counters();
+    }
+  }
+  app_chmap_print();
+  app_link_stats_print();
+  app_events_print();
+  app_events_publish();
+  app_metrics_export("exit");
+  app_metrics_deinit();
+  app_transport_flush();
+  app_transport_print();
+  ncp_host_deinit();
+  app_shutdown_print();
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Put your additional application deinit code here!                       //
+  // This is called once during termination.                                 //
+  /////////////////////////////////////////////////////////////////////////////
+
+  // Force exit here
+  exit((dtm_per_failed == true || encrypt_failed == true) ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/**************************************************************************//**
+ * Bluetooth stack event handler.
+ * This overrides the dummy weak implementation.
  *
  * @param[in] evt Event coming from the Bluetooth stack.
  *****************************************************************************/
 void sl_bt_on_event(sl_bt_msg_t *evt)
 {
   sl_status_t sc;
-  bd_addr address;
-  uint8_t address_type;
-  int16_t power_level_set_min, power_level_set_max;
   uint16_t null_var;
   int8_t rssi;
 
@@ -767,6 +1597,9 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
     // This event indicates the device has started and the radio is ready.
     // Do not call any stack command before receiving this boot event!
     case sl_bt_evt_system_boot_id:
+      // NCP database is cleared on boot, set it up again when needed
+      gattdb_ready = false;
+      ncp_boot_seen = true;
       /* Store version info */
       version_major = evt->data.evt_system_boot.major;
       version_minor = evt->data.evt_system_boot.minor;
@@ -779,33 +1612,7 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
                evt->data.evt_system_boot.build,
                evt->data.evt_system_boot.bootloader,
                evt->data.evt_system_boot.hw);
-      // Extract unique ID from BT Address.
-      sc = sl_bt_system_get_identity_address(&address, &address_type);
-      app_assert_status(sc);
-      printf("MAC address: %02X:%02X:%02X:%02X:%02X:%02X\n",
-        address.addr[5], // <-- address is little-endian
-        address.addr[4],
-        address.addr[3],
-        address.addr[2],
-        address.addr[1],
-        address.addr[0]);
-
-      // Set power limits to max (note - max will generally be internally
-      // limited to 10 dBm without AFH component)
-      sc = sl_bt_system_set_tx_power(MIN_POWER_LEVEL, MAX_POWER_LEVEL, &power_level_set_min, &power_level_set_max);
-      app_assert_status(sc);
-
-      // Initialize GATT database dynamically.
-      initialize_gatt_database();
-
-      if (throughput_state != THROUGHPUT_NONE) {
-        /* Init test data buffer with alphabet pattern */
-        for (int i=0; i < (sizeof(bletest_throughput_payload_data)/sizeof(*bletest_throughput_payload_data)); i++){
-          bletest_throughput_payload_data[i] = 'a' + (i % 26);
-        }
-      }
-
-      main_app_handler();
+      on_ncp_ready();
       break;
 
     // -------------------------------
@@ -813,6 +1620,7 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
     case sl_bt_evt_connection_opened_id:
 
       printf("Connection opened." APP_LOG_NL);
+      app_security_on_opened(evt->data.evt_connection_opened.bonding, app_time_mono_us());
       // reset connection packet debug counters
       sc = sl_bt_system_get_counters(true, &null_var, &null_var,
                                     &null_var, &null_var);
@@ -827,12 +1635,20 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       if (app_state == conn_pending) {
         // handle connection mode as central
         app_state = connected;
-        if (throughput_state != THROUGHPUT_NONE) {
-        sc = sl_bt_gatt_discover_primary_services_by_uuid(conn_handle,
-                                                        UUID_LEN,
-                                                        bletest_throughput_service_uuid);
-        app_assert_status(sc);     
-        throughput_state = THROUGHPUT_FIND_SERVICES;              
+        if (daemon_op == daemon_op_conn) {
+          (void)sl_bt_system_set_lazy_soft_timer(0, 0, CONN_TIMER_HANDLE, false);
+          daemon_op = daemon_op_none;
+          app_daemon_reply(SL_STATUS_OK, "connection=%d rssi=%d", conn_handle, rssi);
+        }
+        if (encrypt_mode != encrypt_none) {
+          // pair, or encrypt with the stored keys, before the throughput test
+          sc = sl_bt_sm_increase_security(conn_handle);
+          app_assert_status(sc);
+          if (l2cap_enabled == true || throughput_state != THROUGHPUT_NONE) {
+            throughput_state = THROUGHPUT_ENCRYPT;
+          }
+        } else {
+          start_throughput();
         }
       } else if (app_state == adv_test_advertising) {
         app_state = adv_test_connected;
@@ -844,6 +1660,15 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
                                           REPORT_TIMER_HANDLE,
                                           false);
         app_assert_status(sc);
+        // start the first link counter interval from zero
+        uint16_t unused_counter;
+        sc = sl_bt_system_get_counters(true, &unused_counter, &unused_counter,
+                                       &unused_counter, &unused_counter);
+        app_assert_status(sc);
+        link_interval_start_us = app_time_mono_us();
+        // coex counters can't be reset without losing the totals, keep a baseline
+        coex_last_valid = (coex_enabled == true
+                           && read_coex_counters(&coex_last) == SL_STATUS_OK);
       }
       break;
 
@@ -863,11 +1688,27 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       printf("Disconnected from central" APP_LOG_NL);
       app_log_debug("Disconnect reason:0x%2x\r\n",evt->data.evt_connection_closed.reason);
       print_packet_counters();
+      on_l2cap_closed(0);
       if (evt->data.evt_connection_closed.reason == SL_STATUS_BT_CTRL_CONNECTION_TIMEOUT) {
         // increment supervision timeout counter
         timeout_count++;
       }
 
+      if (daemon_op == daemon_op_disconnect || daemon_op == daemon_op_conn) {
+        // disconnect requested, or connection failed, over the control socket
+        if (daemon_op == daemon_op_disconnect) {
+          sc = SL_STATUS_OK;
+        } else {
+          (void)sl_bt_system_set_lazy_soft_timer(0, 0, CONN_TIMER_HANDLE, false);
+          sc = (daemon_conn_timed_out == true) ? SL_STATUS_TIMEOUT : SL_STATUS_FAIL;
+        }
+        app_daemon_reply(sc, "reason=0x%04x", evt->data.evt_connection_closed.reason);
+        daemon_op = daemon_op_none;
+        throughput_state = THROUGHPUT_NONE;
+        app_state = daemon_idle;
+        break;
+      }
+
       // Restart advertising after client has disconnected.
       if (app_state == adv_test_connected)
       {
@@ -908,58 +1749,88 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
         if (app_state == dtm_rx_begin) {
           //This is just an acknowledgement of the DTM start - set a flag for the next event which is the end
           app_state = dtm_rx_started;
+          if (rx_segment_ms != 0) {
+            on_rx_segment_started();
+          }
+        } else if (app_state == survey_run) {
+          //Start or end of a survey dwell
+          on_survey_dtm_completed(evt->data.evt_test_dtm_completed.number_of_packets);
+        } else if (app_state == dtm_rx_started && rx_segment_ms != 0) {
+          //End of a segment - restart the receiver unless the test is over
+          on_rx_segment_completed(evt->data.evt_test_dtm_completed.number_of_packets);
         } else if (app_state == dtm_tx_begin ) {
           //This is just an acknowledgement of the DTM start - set a flag for the next event which is the end
           app_state = dtm_tx_started;
 
+        } else if (daemon_active == true) {
+          // DTM ended on request over the control socket
+          app_state = daemon_idle;
+          daemon_op = daemon_op_none;
+          app_daemon_reply(SL_STATUS_OK, "packets=%d", evt->data.evt_test_dtm_completed.number_of_packets);
         } else if (app_state == dtm_rx_started) {
           //This is the event received at the end of the test
           printf("DTM receive completed. Number of packets received: %d\n",evt->data.evt_test_dtm_completed.number_of_packets);
-          exit(EXIT_SUCCESS);	//test done - terminate
+          publish_dtm_result(evt->data.evt_test_dtm_completed.number_of_packets);
+          exit(dtm_per_failed == true ? EXIT_FAILURE : EXIT_SUCCESS);	//test done - terminate
         } else if (app_state == dtm_tx_started ) {
           /* Not sure how we got here - but exit anyways */
           printf("DTM completed, number of packets transmitted: %d\n",evt->data.evt_test_dtm_completed.number_of_packets);
+          publish_dtm_result(evt->data.evt_test_dtm_completed.number_of_packets);
           exit(EXIT_SUCCESS); //test done - terminate
         }
         break;
 
       case sl_bt_evt_scanner_legacy_advertisement_report_id:
-        if (scan_filt_flag == true) {
-          if (evt->data.evt_scanner_legacy_advertisement_report.address.addr[5] != scan_filt_address.addr[5] ||
-            evt->data.evt_scanner_legacy_advertisement_report.address.addr[4] != scan_filt_address.addr[4] ||
-            evt->data.evt_scanner_legacy_advertisement_report.address.addr[3] != scan_filt_address.addr[3] ||
-            evt->data.evt_scanner_legacy_advertisement_report.address.addr[2] != scan_filt_address.addr[2] ||
-            evt->data.evt_scanner_legacy_advertisement_report.address.addr[1] != scan_filt_address.addr[1] ||
-            evt->data.evt_scanner_legacy_advertisement_report.address.addr[0] != scan_filt_address.addr[0] )
-           {
-            // scan doesn't match the filter - discard
-            break;
-          }
-        }
-        scan_counter++;
-        // print scan packet info if not averaging
-        if (rssi_len == 0) {
-          printf("ADV RCVD from MAC ");
-	        print_address(evt->data.evt_scanner_legacy_advertisement_report.address);
-          printf(", Channel: %d",evt->data.evt_scanner_legacy_advertisement_report.channel);
-			    printf(", RSSI: %d\r\n", evt->data.evt_scanner_legacy_advertisement_report.rssi);
-        } else {
-          // Handle averaging
-          rssi_sum += evt->data.evt_scanner_legacy_advertisement_report.rssi;
-          rssi_count++;
-          if (rssi_count >= rssi_len) {
-            // print average and reset totals
-            printf("AVG RSSI REPORT: %2.2f\r\n",(float)rssi_sum/(float)rssi_count);
-            rssi_count = 0;
-            rssi_sum = 0;
-          }
-        }
+        on_adv_report(&evt->data.evt_scanner_legacy_advertisement_report.address,
+                      evt->data.evt_scanner_legacy_advertisement_report.address_type,
+                      evt->data.evt_scanner_legacy_advertisement_report.channel,
+                      evt->data.evt_scanner_legacy_advertisement_report.rssi,
+                      0,
+                      evt->data.evt_scanner_legacy_advertisement_report.data.data,
+                      evt->data.evt_scanner_legacy_advertisement_report.data.len);
+    break;
+
+      case sl_bt_evt_scanner_extended_advertisement_report_id:
+        on_extended_adv_report(&evt->data.evt_scanner_extended_advertisement_report.address,
+                               evt->data.evt_scanner_extended_advertisement_report.address_type,
+                               evt->data.evt_scanner_extended_advertisement_report.adv_sid,
+                               evt->data.evt_scanner_extended_advertisement_report.channel,
+                               evt->data.evt_scanner_extended_advertisement_report.rssi,
+                               ADV_REPORT_EXTENDED
+                               | ((evt->data.evt_scanner_extended_advertisement_report.primary_phy
+                                   == sl_bt_gap_phy_coded) ? ADV_REPORT_CODED : 0),
+                               evt->data.evt_scanner_extended_advertisement_report.data_completeness,
+                               &evt->data.evt_scanner_extended_advertisement_report.data);
     break;
 
     case sl_bt_evt_connection_parameters_id:
       app_log_debug("Conn params interval=%3f ms, timeout: %d ms\r\n",
                     (float)evt->data.evt_connection_parameters.interval * 1.25,
                     evt->data.evt_connection_parameters.timeout * 10);
+      app_gatt_ping_set_params(evt->data.evt_connection_parameters.interval,
+                               evt->data.evt_connection_parameters.latency);
+      // the security mode changes here when the link is encrypted
+      if (app_security_on_mode(evt->data.evt_connection_parameters.security_mode,
+                               app_time_mono_us()) == true && app_state == connected) {
+        on_link_encrypted();
+      }
+      break;
+
+    case sl_bt_evt_sm_bonded_id:
+      app_security_on_bonded(evt->data.evt_sm_bonded.bonding, app_time_mono_us());
+      if (app_state == connected) {
+        on_bonded(evt->data.evt_sm_bonded.bonding);
+      }
+      break;
+
+    case sl_bt_evt_sm_bonding_failed_id:
+      app_security_on_failed(evt->data.evt_sm_bonding_failed.reason);
+      printf("Error! Pairing failed, reason 0x%04x\n", evt->data.evt_sm_bonding_failed.reason);
+      encrypt_failed = true;
+      if (app_state == connected) {
+        // the central can't run the test without encryption
+        app_deinit();
+      }
       break;
 
     case sl_bt_evt_gatt_mtu_exchanged_id:
@@ -977,6 +1848,26 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
     case sl_bt_evt_system_soft_timer_id:
       if (evt->data.evt_system_soft_timer.handle == REPORT_TIMER_HANDLE){
         timer_on_report();
+      } else if (evt->data.evt_system_soft_timer.handle == CONN_TIMER_HANDLE) {
+        if (daemon_op == daemon_op_conn && app_state == conn_pending) {
+          // the connection closed event answers the request
+          printf("Connection timed out\r\n");
+          daemon_conn_timed_out = true;
+          sc = sl_bt_connection_close(conn_handle);
+          if (sc != SL_STATUS_OK) {
+            app_daemon_reply(sc, "connection timeout");
+            daemon_op = daemon_op_none;
+            throughput_state = THROUGHPUT_NONE;
+            app_state = daemon_idle;
+          }
+        }
+      } else if (evt->data.evt_system_soft_timer.handle == ADV_STEP_TIMER_HANDLE) {
+        if (adv_step_index + 1 < app_adv_steps_count()) {
+          apply_adv_step(adv_step_index + 1);
+        } else {
+          printf("Step schedule complete\n");
+          app_deinit();
+        }
       }
       break;
 
@@ -994,6 +1885,71 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       fflush(stdout);
       break;
 
+    case sl_bt_evt_l2cap_le_channel_open_request_id:
+      // the peer opens the throughput channel, accept it only with --l2cap
+      sc = app_l2cap_on_open_request(evt->data.evt_l2cap_le_channel_open_request.connection,
+                                     evt->data.evt_l2cap_le_channel_open_request.spsm,
+                                     evt->data.evt_l2cap_le_channel_open_request.cid,
+                                     evt->data.evt_l2cap_le_channel_open_request.max_sdu,
+                                     evt->data.evt_l2cap_le_channel_open_request.max_pdu,
+                                     evt->data.evt_l2cap_le_channel_open_request.credit,
+                                     l2cap_enabled == true && app_state == adv_test_connected);
+      if (sc == SL_STATUS_NOT_SUPPORTED) {
+        app_log_info("Rejected L2CAP channel on SPSM 0x%04x\r\n",
+                     evt->data.evt_l2cap_le_channel_open_request.spsm);
+        break;
+      }
+      app_assert_status(sc);
+      app_l2cap_print_channel();
+      last_report_time_us = cur_time_us();
+      bletest_throughput_total_bytes = 0;
+      throughput_state = THROUGHPUT_L2CAP_RX;
+      break;
+
+    case sl_bt_evt_l2cap_le_channel_open_response_id:
+      if (throughput_state != THROUGHPUT_L2CAP_OPEN) {
+        break;
+      }
+      sc = app_l2cap_on_open_response(evt->data.evt_l2cap_le_channel_open_response.cid,
+                                      evt->data.evt_l2cap_le_channel_open_response.max_sdu,
+                                      evt->data.evt_l2cap_le_channel_open_response.max_pdu,
+                                      evt->data.evt_l2cap_le_channel_open_response.credit,
+                                      evt->data.evt_l2cap_le_channel_open_response.errorcode);
+      if (sc == SL_STATUS_NOT_FOUND) {
+        break;
+      }
+      if (sc != SL_STATUS_OK) {
+        printf("BLEtest L2CAP channel not available - skipping throughput test\r\n");
+        throughput_state = THROUGHPUT_NONE;
+        break;
+      }
+      app_l2cap_print_channel();
+      printf("Running throughput test over L2CAP\r\n");
+      last_report_time_us = cur_time_us();
+      bletest_throughput_total_bytes = 0;
+      throughput_state = THROUGHPUT_L2CAP;
+      break;
+
+    case sl_bt_evt_l2cap_channel_credit_id:
+      app_l2cap_on_credit(evt->data.evt_l2cap_channel_credit.cid,
+                          evt->data.evt_l2cap_channel_credit.credit);
+      break;
+
+    case sl_bt_evt_l2cap_channel_data_id:
+      // receiving throughput data over L2CAP - show something
+      bletest_throughput_total_bytes += app_l2cap_on_data(evt->data.evt_l2cap_channel_data.cid,
+                                                          evt->data.evt_l2cap_channel_data.data.len);
+      printf(".");
+      fflush(stdout);
+      break;
+
+    case sl_bt_evt_l2cap_channel_closed_id:
+      app_log_debug("L2CAP channel 0x%04x closed, reason 0x%04x\r\n",
+                    evt->data.evt_l2cap_channel_closed.cid,
+                    evt->data.evt_l2cap_channel_closed.reason);
+      on_l2cap_closed(evt->data.evt_l2cap_channel_closed.cid);
+      break;
+
     case sl_bt_evt_connection_phy_status_id:
       // report phy changes
       app_log_info("PHY update procedure completed, new phy = 0x%x\r\n", (uint8_t) evt->data.evt_connection_phy_status.phy);
@@ -1015,15 +1971,82 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
   }
 }
 
+/**************************************************************************//**
+ * Common setup once the NCP is ready, either after the boot event or after
+ * a fast start without reset.
+ *****************************************************************************/
+static void on_ncp_ready(void)
+{
+  sl_status_t sc;
+  bd_addr address;
+  uint8_t address_type;
+  int16_t power_level_set_min, power_level_set_max;
+
+  // Extract unique ID from BT Address.
+  sc = sl_bt_system_get_identity_address(&address, &address_type);
+  app_assert_status(sc);
+  printf("MAC address: %02X:%02X:%02X:%02X:%02X:%02X\n",
+    address.addr[5], // <-- address is little-endian
+    address.addr[4],
+    address.addr[3],
+    address.addr[2],
+    address.addr[1],
+    address.addr[0]);
+
+  // Set power limits to max (note - max will generally be internally
+  // limited to 10 dBm without AFH component)
+  sc = sl_bt_system_set_tx_power(MIN_POWER_LEVEL, MAX_POWER_LEVEL, &power_level_set_min, &power_level_set_max);
+  app_assert_status(sc);
+
+  if (daemon_active == true) {
+    // NCP reset requested over the control socket, keep serving requests
+    advertising_set_handle = 0xff;
+    app_state = daemon_idle;
+    if (daemon_op == daemon_op_reset) {
+      daemon_op = daemon_op_none;
+      app_daemon_reply(SL_STATUS_OK, "ncp=%d.%d.%d", version_major,
+                       version_minor, version_patch);
+    }
+    return;
+  }
+
+  if (encrypt_mode != encrypt_none) {
+    configure_security();
+  }
+
+  if (throughput_state != THROUGHPUT_NONE) {
+    /* Init test data buffer with alphabet pattern */
+    for (int i=0; i < (sizeof(bletest_throughput_payload_data)/sizeof(*bletest_throughput_payload_data)); i++){
+      bletest_throughput_payload_data[i] = 'a' + (i % 26);
+    }
+  }
+
+  main_app_handler();
+}
+
 /**************************************************************************//**
  * Initialize GATT database dynamically.
  *****************************************************************************/
 static void initialize_gatt_database(void)
 {
   sl_status_t sc;
+  int64_t setup_start_us = app_time_mono_us();
+  uint32_t bgapi_count;
+  gattdb_profile_t *profile = &app_gattdb_profile;
+
+  if (ncp_boot_seen == false) {
+    // NCP didn't boot, so a database added by an earlier run may still be there
+    sc = app_gattdb_find_layout(gattdb_state_path(), profile, &bgapi_count);
+    if (sc == SL_STATUS_OK) {
+      printf("GATT database already on the NCP, reused in %.1f ms (%u BGAPI commands)\n",
+             (app_time_mono_us() - setup_start_us) / 1000.0, bgapi_count);
+      return;
+    }
+  }
 
   // New session
   sc = sl_bt_gattdb_new_session(&gattdb_session);
+  bgapi_count = 1;
 
   if (sc == SL_STATUS_NOT_SUPPORTED) {
     /* If dynamic GATT is not supported, just ignore for now */
@@ -1034,26 +2057,75 @@ static void initialize_gatt_database(void)
   }
 
   // Add services
-  for (service_index_t i = (service_index_t)0; i < SERVICES_COUNT; i++) {
-    sc = app_gattdb_add_service(gattdb_session, &services[i]);
+  for (size_t i = 0; i < profile->service_count; i++) {
+    sc = app_gattdb_add_service(gattdb_session, &profile->services[i]);
     app_assert_status(sc);
+    bgapi_count++;
   }
+  // characteristics need the service handles
+  sc = app_async_barrier();
+  app_assert_status(sc);
 
   // Add characteristics
-  for (characteristic_index_t i = (characteristic_index_t)0; i < CHARACTERISTICS_COUNT; i++) {
-    sc = app_gattdb_add_characteristic(gattdb_session, &characteristics[i]);
+  for (size_t i = 0; i < profile->characteristic_count; i++) {
+    sc = app_gattdb_add_characteristic(gattdb_session, &profile->characteristics[i]);
     app_assert_status(sc);
+    bgapi_count++;
   }
 
   // Start services and child characteristics
-  for (service_index_t i = (service_index_t)0; i < SERVICES_COUNT; i++) {
-    sc = sl_bt_gattdb_start_service(gattdb_session, services[i].handle);
+  for (size_t i = 0; i < profile->service_count; i++) {
+    sc = app_async_gattdb_start_service(gattdb_session, profile->services[i].handle);
     app_assert_status(sc);
+    bgapi_count++;
   }
 
   // Commit changes
-  sc = sl_bt_gattdb_commit(gattdb_session);
+  sc = app_async_gattdb_commit(gattdb_session);
   app_assert_status(sc);
+  bgapi_count++;
+  sc = app_async_barrier();
+  app_assert_status(sc);
+  printf("GATT database built in %.1f ms (%u BGAPI commands, pipeline depth %u)\n",
+         (app_time_mono_us() - setup_start_us) / 1000.0, bgapi_count, app_async_depth());
+  if (profile->service_count != 0) {
+    // lets a later --fast_start run reuse the database
+    sc = app_gattdb_save_layout(gattdb_state_path(), profile);
+    if (sc != SL_STATUS_OK) {
+      app_log_debug("warning: cannot write %s, result=0x%04X\n", gattdb_state_path(), sc);
+    }
+  }
+}
+
+/**************************************************************************//**
+ * Get the file remembering the GATT database layout committed on this NCP.
+ *****************************************************************************/
+static const char *gattdb_state_path(void)
+{
+  static char path[256];
+
+  if (path[0] == '\0') {
+    snprintf(path, sizeof(path), "%s%s", GATTDB_STATE_PREFIX, ncp_link_name);
+    // one file name, whatever the device path or host:port looks like
+    for (char *c = &path[sizeof(GATTDB_STATE_PREFIX) - 1]; *c != '\0'; c++) {
+      if (*c == '/' || *c == ':') {
+        *c = '_';
+      }
+    }
+  }
+  return path;
+}
+
+/**************************************************************************//**
+ * Set up the GATT database on first use. Only modes acting as a GATT server
+ * need it, so other modes skip the setup round trips.
+ *****************************************************************************/
+static void ensure_gatt_database(void)
+{
+  if (gattdb_ready == false) {
+    initialize_gatt_database();
+    gattdb_ready = true;
+  }
 }
 
 /**********************************************************
@@ -1069,7 +2141,12 @@ void main_app_handler(void) {
   size_t rev_str_len;
   int16_t power_level_set_min, power_level_set_max;
   size_t user_message_response_len;
-  uint8_t user_message_response[50];
+  uint8_t user_message_response[APP_CUST_MAX_PAYLOAD_LEN];
+  FILE *cust_script;
+  int cust_failures;
+
+  printf("NCP ready %.1f ms after start, NCP resets: %u\n",
+    (app_time_mono_us() - startup_time_us) / 1000.0, ncp_reset_count);
 
   /* Immediately exit if not the right NCP version (GSDK 4.4.6 == BLE SDK 7.3.0) */
   if ((version_major < 7) || ((version_major == 7) && (version_minor < 3))) {
@@ -1111,7 +2188,7 @@ void main_app_handler(void) {
     sc = sl_bt_nvm_save(SL_BT_NVM_KEY_CTUNE, sizeof(ctune_array), ctune_array);
     app_assert_status(sc);
     ps_state = ps_none; /* reset state machine */
-    sl_bt_system_reset(sl_bt_system_boot_mode_normal);/* reset to take effect */
+    ncp_reset();/* reset to take effect */
     printf("Rebooting with new ctune value...\n");
   } else if (ps_state == ps_read_ctune)
   {
@@ -1124,11 +2201,11 @@ void main_app_handler(void) {
       app_assert_status(sc);
     }
     else {
-      printf("Stored CTUNE = 0x%04x\nRebooting...\n", (uint16_t)(ctune_array[0] | ctune_array[1] << 8));
+      printf("Stored CTUNE = 0x%04x\n", (uint16_t)(ctune_array[0] | ctune_array[1] << 8));
     }
-      /* Reset again and proceed with other commands */
-      ps_state = ps_none; /* reset state machine */
-      sl_bt_system_reset(sl_bt_system_boot_mode_normal);/* reset to take effect */
+    /* Reading doesn't change the NCP state, so proceed with other commands without a reset */
+    ps_state = ps_none; /* reset state machine */
+    main_app_handler();
 
   } else if (ps_state == ps_read_gatt_fwversion)
   {
@@ -1164,24 +2241,51 @@ void main_app_handler(void) {
     sc = sl_bt_system_set_identity_address(new_address, 0); //set public address
     app_assert_status(sc);
     ps_state = ps_none; /* reset state machine */
-    sl_bt_system_reset(sl_bt_system_boot_mode_normal);/* reset to take effect */
+    ncp_reset();/* reset to take effect */
     printf("Rebooting with new MAC address...\n");
   }
+  else if (daemon_socket_path != NULL) {
+    daemon_start();
+  }
+  else if (app_state == survey_begin)
+  {
+    printf("Surveying %u channels with %u ms DTM receive dwells on phy=0x%02X and a %u ms scanner window per sweep\n",
+           APP_SURVEY_CHANNELS, survey_dwell_ms, selected_phy, 3 * survey_dwell_ms);
+    if (duration_usec == 0) {
+      printf("Infinite mode. Press control-c to exit...\r\n");
+    }
+    start_time_us = cur_time_us();
+    app_state = survey_run;
+    survey_start_step(0);
+  }
+  else if (app_state == dtm_rx_begin && rx_segment_ms != 0)
+  {
+    printf("DTM receive enabled, freq=%d MHz, phy=0x%02X, restarting every %u ms\n",
+           2402+(2*channel), selected_phy, rx_segment_ms);
+    if (duration_usec == 0) {
+      printf("Infinite mode. Press control-c to exit...\r\n");
+    } else {
+      rx_test_end_us = cur_time_us() + duration_usec;
+    }
+    // the main loop ends each segment, the completed event starts the next
+    sc = sl_bt_test_dtm_rx(channel,selected_phy);
+    app_assert_status(sc);
+  }
   else if (app_state == dtm_rx_begin)
   {
     printf("DTM receive enabled, freq=%d MHz, phy=0x%02X\n",2402+(2*channel), selected_phy);
     sc = sl_bt_test_dtm_rx(channel,selected_phy);
     app_assert_status(sc);
-    if (duration_usec != 0) {
-      usleep(duration_usec);	/* sleep during test */
-    } else {
-        // Infinite mode
-        printf("Infinite mode. Press control-c to exit...\r\n");
-        while(1) {
-          // wait here for control-c, sleeping periodically to save host CPU cycles
-          usleep(1000);
-        }
+    dtm_start_us = cur_time_us();
+    if (duration_usec == 0) {
+      // Infinite mode
+      printf("Infinite mode. Press control-c to exit...\r\n");
     }
+    // sleep during test, or until control-c in infinite mode
+    if (app_shutdown_wait(duration_usec != 0 ? (int64_t)duration_usec : -1)) {
+      return; // app_deinit() ends the test
+    }
+    dtm_stop_us = cur_time_us();
     sc = sl_bt_test_dtm_end();
     app_assert_status(sc);
   }
@@ -1189,23 +2293,31 @@ void main_app_handler(void) {
   {
     /* begin advertisement test */
     printf("\nStarting advertisements at period = %dms\r\n", (uint16_t) (adv_period * ADV_INTERVAL_UNIT));
-    sc = sl_bt_system_set_tx_power(power_level, power_level, &power_level_set_min, &power_level_set_max);
-    app_assert_status(sc);
-    printf("Attempted power setting of %.1f dBm, actual setting %.1f dBm\n",(float)power_level/10,(float)power_level_set_max/10);
+    if (app_adv_steps_count() != 0) {
+      // allow every step of the schedule, each step sets the power of the set
+      sc = sl_bt_system_set_tx_power(MIN_POWER_LEVEL, app_adv_steps_max_power(), &power_level_set_min, &power_level_set_max);
+      app_assert_status(sc);
+      printf("Stepping through %zu steps, TX power limit %.1f dBm\n", app_adv_steps_count(), (float)power_level_set_max/10);
+      adv_period = app_adv_steps_get(0)->interval;
+    } else {
+      sc = sl_bt_system_set_tx_power(power_level, power_level, &power_level_set_min, &power_level_set_max);
+      app_assert_status(sc);
+      printf("Attempted power setting of %.1f dBm, actual setting %.1f dBm\n",(float)power_level/10,(float)power_level_set_max/10);
+    }
     printf("Press 'control-c' to end...\n");
     printf("Advertising for %d milliseconds\r\n", duration_usec/1000);
     start_time_us = cur_time_us();
-    sc = sl_bt_advertiser_create_set(&advertising_set_handle);
-    app_assert_status(sc);
-    sc = sl_bt_legacy_advertiser_set_data(advertising_set_handle, 0, sizeof(adv_data),adv_data); //advertising data
-    app_assert_status(sc);
-    sc = sl_bt_legacy_advertiser_set_data(advertising_set_handle, 1, sizeof(scan_rsp_data), scan_rsp_data); //scan response data
-    app_assert_status(sc);
-    sc = sl_bt_advertiser_set_timing(advertising_set_handle, adv_period,adv_period,0,0);
-    app_assert_status(sc);
-    sc = sl_bt_legacy_advertiser_start(advertising_set_handle, sl_bt_advertiser_connectable_scannable);
+    ensure_gatt_database();
+    sc = start_advertising();
     app_assert_status(sc);
+    if (adv_set_count > 1) {
+      sc = app_adv_sets_start(adv_set_count, adv_period, power_level);
+      app_assert_status(sc);
+    }
     app_state = adv_test_advertising;
+    if (app_adv_steps_count() != 0) {
+      apply_adv_step(0);
+    }
   } else if (app_state == verify_custom_bgapi) {
     /* Send custom BGAPI command and print response */
     printf("Sending custom user message to target...\n");
@@ -1230,6 +2342,38 @@ void main_app_handler(void) {
       }
       exit(EXIT_SUCCESS);
     }
+  } else if (app_state == run_custom_script) {
+    /* Stream custom BGAPI commands from the script over this session */
+    if (strcmp(cust_script_path, "-") == 0) {
+      cust_script = stdin;
+    } else {
+      cust_script = fopen(cust_script_path, "r");
+      if (cust_script == NULL) {
+        printf("Error! Cannot open custom script \"%s\"\n", cust_script_path);
+        exit(EXIT_FAILURE);
+      }
+    }
+    printf("Running custom user messages from %s, depth=%d...\n",
+      cust_script == stdin ? "stdin" : cust_script_path, cust_depth);
+    cust_failures = app_cust_run_script(cust_script, cust_depth);
+    if (cust_script != stdin) {
+      fclose(cust_script);
+    }
+    if (app_shutdown_requested()) {
+      return; // the main loop runs app_deinit()
+    }
+    exit(cust_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+  } else if (app_state == link_self_test) {
+    /* Measure the NCP link and report what limits throughput */
+    sc = app_link_test_run(link_test_count, serial_link == true ? link_baud : 0);
+    if (sc == SL_STATUS_ABORT) {
+      return; // interrupted, the main loop runs app_deinit()
+    }
+    if (sc != SL_STATUS_OK) {
+      printf("Error! Link self-test failed, result=0x%04X\n", sc);
+      exit(EXIT_FAILURE);
+    }
+    exit(EXIT_SUCCESS);
   } else if (app_state == advscan_wait) {
     if (scan_filt_flag == true) {
       printf("Enabling advertising scan with MAC address filter ");
@@ -1239,12 +2383,17 @@ void main_app_handler(void) {
       printf("Enabling advertising scan. ");
     }
     printf("\r\n");
-    if (rssi_len != 0) {
+    if (adv_dedup_mode != adv_dedup_off) {
+      sc = app_adv_cache_init(adv_cache_size, adv_window_ms);
+      app_assert_status(sc);
+      printf("Suppressing repeated reports within %u ms, tracking up to %u advertisers\r\n",
+             adv_window_ms, adv_cache_size);
+    } else if (rssi_len != 0) {
       printf("RSSI averaging over %d packets\r\n", rssi_len);
     } else {
       printf("No RSSI averaging - info from every packet will be printed\r\n");
     }
-    sc = sl_bt_scanner_start(1u,sl_bt_scanner_discover_observation); // scan with 1M PHY
+    sc = start_scanner();
     app_assert_status(sc);
     if (duration_usec == 0) {
       // infinite mode
@@ -1285,15 +2434,12 @@ void main_app_handler(void) {
       printf("Error running DTM TX command, result=0x%02X\n",sc);
       exit(EXIT_FAILURE);
     }
-    if (duration_usec != 0) {
-      usleep(duration_usec);	/* sleep during test */
-    } else {
-      while(1) {
-        // Infinite mode
-        // wait here for control-c, sleeping periodically
-        usleep(1000);
-      }
+    dtm_start_us = cur_time_us();
+    // sleep during test, or until control-c in infinite mode
+    if (app_shutdown_wait(duration_usec != 0 ? (int64_t)duration_usec : -1)) {
+      return; // app_deinit() ends the test
     }
+    dtm_stop_us = cur_time_us();
     sc = sl_bt_test_dtm_end();
     app_assert_status(sc);
   }
@@ -1327,8 +2473,109 @@ static int64_t cur_time_us(void) {
   return micros;
 }
 
+/* Build the advertising data of set 0, with the marker if there are more sets */
+static size_t build_adv_data(uint8_t *marked_adv_data) {
+  size_t marked_adv_data_len = sizeof(adv_data);
+
+  memcpy(marked_adv_data, adv_data, sizeof(adv_data));
+  if (adv_set_count > 1) {
+    // let a scanner tell set 0 apart from the other sets
+    marked_adv_data_len += app_adv_sets_marker(0, adv_period, &marked_adv_data[sizeof(adv_data)]);
+  }
+  return marked_adv_data_len;
+}
+
+/* Create the advertising set if needed, then start connectable advertising */
+static sl_status_t start_advertising(void) {
+  sl_status_t sc;
+  uint8_t marked_adv_data[sizeof(adv_data) + APP_ADV_SETS_MARKER_LEN];
+  size_t marked_adv_data_len;
+
+  if (advertising_set_handle == 0xff) {
+    sc = sl_bt_advertiser_create_set(&advertising_set_handle);
+    if (sc) {
+      return sc;
+    }
+  }
+  marked_adv_data_len = build_adv_data(marked_adv_data);
+  // pipelined with --pipeline, the NCP runs the commands in order
+  sc = app_async_legacy_advertiser_set_data(advertising_set_handle, 0, marked_adv_data_len, marked_adv_data); //advertising data
+  if (sc) {
+    return sc;
+  }
+  sc = app_async_legacy_advertiser_set_data(advertising_set_handle, 1, sizeof(scan_rsp_data), scan_rsp_data); //scan response data
+  if (sc) {
+    return sc;
+  }
+  sc = app_async_advertiser_set_timing(advertising_set_handle, adv_period,adv_period,0,0);
+  if (sc) {
+    return sc;
+  }
+  sc = app_async_legacy_advertiser_start(advertising_set_handle, sl_bt_advertiser_connectable_scannable);
+  if (sc) {
+    return sc;
+  }
+  return app_async_barrier();
+}
+
+/* Move the advertiser to a step of the --adv_steps schedule and arm the dwell
+ * timer. While connected only the settings change, they take effect when
+ * advertising restarts after the disconnect. */
+static void apply_adv_step(size_t index) {
+  sl_status_t sc;
+  const app_adv_step_t *step = app_adv_steps_get(index);
+  int16_t set_power;
+  int64_t step_us, wall_us;
+  uint8_t marked_adv_data[sizeof(adv_data) + APP_ADV_SETS_MARKER_LEN];
+  size_t marked_adv_data_len;
+
+  if (app_state == adv_test_advertising) {
+    sc = sl_bt_advertiser_stop(advertising_set_handle);
+    app_assert_status(sc);
+  }
+  adv_period = step->interval;
+  sc = sl_bt_advertiser_set_tx_power(advertising_set_handle, step->power, &set_power);
+  app_assert_status(sc);
+  sc = sl_bt_advertiser_set_timing(advertising_set_handle, adv_period, adv_period, 0, 0);
+  app_assert_status(sc);
+  if (adv_set_count > 1) {
+    // the marker carries the interval of set 0, keep it in step
+    marked_adv_data_len = build_adv_data(marked_adv_data);
+    sc = sl_bt_legacy_advertiser_set_data(advertising_set_handle, 0, marked_adv_data_len, marked_adv_data);
+    app_assert_status(sc);
+  }
+  if (app_state == adv_test_advertising) {
+    sc = sl_bt_legacy_advertiser_start(advertising_set_handle, sl_bt_advertiser_connectable_scannable);
+    app_assert_status(sc);
+  }
+  step_us = app_time_mono_us();
+  wall_us = app_time_wall_us();
+  // one-shot timer, 32768 ticks per second
+  sc = sl_bt_system_set_lazy_soft_timer((uint32_t)(((uint64_t)step->dwell_ms * 32768) / 1000),
+                                        0,
+                                        ADV_STEP_TIMER_HANDLE,
+                                        true);
+  app_assert_status(sc);
+  adv_step_index = index;
+  app_adv_steps_log(index, set_power, step_us, wall_us);
+  app_metrics_set_gauge("adv_step", index + 1);
+  app_metrics_set_gauge("adv_step_power_dbm", set_power / 10.0);
+  app_metrics_set_gauge("adv_step_interval_ms", adv_period * ADV_INTERVAL_UNIT);
+  app_metrics_export("adv_step");
+}
+
 static void initiate_connection(void) {
   sl_status_t sc;
+
+  sc = open_connection();
+  app_assert_status(sc);
+}
+
+// Start a connection as central. Returns the status of the first failing
+// BGAPI command, if any.
+static sl_status_t open_connection(void)
+{
+  sl_status_t sc;
   uint16_t supervision_timeout;
   int16_t power_level_set_min, power_level_set_max;
 
@@ -1336,71 +2583,98 @@ static void initiate_connection(void) {
           " to MAC ", (float)(conn_interval * CONN_INTERVAL_UNIT_MS));
   print_address(conn_address);
   printf("\r\n");
-  supervision_timeout = (conn_interval * CONN_INTERVAL_UNIT_MS *
+  supervision_timeout = (conn_interval * CONN_INTERVAL_UNIT_MS * (1u + conn_latency) *
       SUP_TIMEOUT_FACTOR) / 10;
   if (supervision_timeout < SUP_TIMEOUT_VAL_MIN) {
     supervision_timeout = SUP_TIMEOUT_VAL_MIN;
+  } else if (supervision_timeout > SUP_TIMEOUT_VAL_MAX) {
+    supervision_timeout = SUP_TIMEOUT_VAL_MAX;
   }
   sc = sl_bt_system_set_tx_power(power_level, power_level, &power_level_set_min, &power_level_set_max);
-  app_assert_status(sc);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
   printf("Attempted power setting of %.1f dBm, actual setting %.1f dBm\n",(float)power_level/10,(float)power_level_set_max/10);
   sc = sl_bt_connection_set_default_parameters(conn_interval, //min_interval
                                            conn_interval, //max_interval
-                                            0u, //latency
+                                            conn_latency, //latency
                                             supervision_timeout, //supervision timeout
                                             0u,//min_ce_length
                                             0xffff);//max_ce_length
-  app_assert_status(sc);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
 
   // proceed with connection using sl_bt_gap_phy_1m
   sc = sl_bt_connection_open(conn_address,
                              sl_bt_gap_public_address,
                             sl_bt_gap_phy_1m,
                              &conn_handle);
-  app_assert_status(sc);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
   app_state = conn_pending;
+  return SL_STATUS_OK;
 }
 
 void print_packet_counters(void) {
   /* Print packet counters */
     uint16_t tx_packets, rx_packets, crc_errors, failures;
     sl_status_t sc;
+    if (link_interval_start_us != 0) {
+      // counters are reset at each report, close the last interval instead
+      sample_link_counters(-1);
+      link_interval_start_us = 0;
+      return;
+    }
     // print counters with no reset
     sc = sl_bt_system_get_counters(false, &tx_packets, &rx_packets,
                                   &crc_errors, &failures);
     app_assert_status(sc);
     app_log_debug("Last connection packets TX:%d, RX:%d, CRC ERR:%d, failures:%d\r\n",
                                 tx_packets, rx_packets, crc_errors, failures);
+    app_metrics_set_counter("ll_tx_packets", tx_packets);
+    app_metrics_set_counter("ll_rx_packets", rx_packets);
+    app_metrics_set_counter("ll_crc_errors", crc_errors);
+    app_metrics_set_counter("ll_failures", failures);
 }
 
-void print_coex_counters(void) {
-  /* Print all the uint32_t coex counters */
+static sl_status_t read_coex_counters(app_link_stats_coex_t *coex_counters) {
+  /* Read all the uint32_t coex counters without resetting them */
   sl_status_t sc;
   size_t len;
-  struct coex_counters_t {
-    uint32_t low_pri_requested;
-    uint32_t high_pri_requested;
-    uint32_t low_pri_denied;
-    uint32_t high_pri_denied;
-    uint32_t low_pri_tx_abort;
-    uint32_t high_pri_tx_abort;
-  } coex_counters;
   sc = sl_bt_coex_get_counters(0u,
-                               sizeof(coex_counters),
+                               sizeof(*coex_counters),
                                &len,
-                               (uint8_t*)&coex_counters);
-  if (sc == SL_STATUS_NOT_SUPPORTED) {
+                               (uint8_t*)coex_counters);
+  if (sc == SL_STATUS_OK) {
+    app_log_debug("coex counters loaded %lu bytes\r\n", len);
+  }
+  return sc;
+}
+
+void print_coex_counters(void) {
+  /* Print all the uint32_t coex counters */
+  sl_status_t sc;
+  app_link_stats_coex_t coex_counters;
+  sc = read_coex_counters(&coex_counters);
+  if (sc == SL_STATUS_NOT_SUPPORTED) {
    app_log_debug("Cannot print coex counters as coexistence is not available in the NCP target.\n");
   } else if (sc) {
    app_assert_status(sc);
  } else {
-   app_log_debug("coex counters loaded %lu bytes\r\n", len);
    printf("Coex counters: low_pri_requested=%u, high_pri_requested=%u, "
            "low_pri_denied=%u, high_pri_denied=%u, "
            "low_pri_tx_abort=%u, high_pri_tx_abort=%u\r\n",
            coex_counters.low_pri_requested, coex_counters.high_pri_requested,
            coex_counters.low_pri_denied,coex_counters.high_pri_denied,
            coex_counters.low_pri_tx_abort, coex_counters.high_pri_tx_abort);
+   app_metrics_set_counter("coex_low_pri_requested", coex_counters.low_pri_requested);
+   app_metrics_set_counter("coex_high_pri_requested", coex_counters.high_pri_requested);
+   app_metrics_set_counter("coex_low_pri_denied", coex_counters.low_pri_denied);
+   app_metrics_set_counter("coex_high_pri_denied", coex_counters.high_pri_denied);
+   app_metrics_set_counter("coex_low_pri_tx_abort", coex_counters.low_pri_tx_abort);
+   app_metrics_set_counter("coex_high_pri_tx_abort", coex_counters.high_pri_tx_abort);
  }
 }
 
@@ -1430,7 +2704,11 @@ static void process_procedure_complete_event(sl_bt_msg_t *evt)
            app_log_debug("found char handles! bletest_throughput_write_with_response_handle=%d, bletest_throughput_write_no_response_handle=%d\r\n",
             bletest_throughput_write_with_response_handle, bletest_throughput_write_no_response_handle);
           last_report_time_us = cur_time_us();
-          if (bletest_throughput_ack == true) {
+          if (gatt_ping_count != 0) {
+            throughput_state = THROUGHPUT_PING;
+            printf("Running GATT round trip test, %u round trips\r\n", gatt_ping_count);
+            gatt_ping_send();
+          } else if (bletest_throughput_ack == true) {
             throughput_state = THROUGHPUT_ACK;
             printf("Running throughput test with ack\r\n");
             // write with response (next write is handled by the procedure complete event)
@@ -1467,6 +2745,10 @@ static void process_procedure_complete_event(sl_bt_msg_t *evt)
       }
       break;
 
+    case THROUGHPUT_PING:
+      on_gatt_ping_completed(procedure_result);
+      break;
+
     case THROUGHPUT_NONE:
     case THROUGHPUT_NOACK:
     case THROUGHPUT_CONNECT:
@@ -1476,6 +2758,137 @@ static void process_procedure_complete_event(sl_bt_msg_t *evt)
   }
 }
 
+// Start the throughput test of a central connection, over L2CAP or GATT.
+static void start_throughput(void)
+{
+  sl_status_t sc;
+
+  if (l2cap_enabled == true) {
+    sc = app_l2cap_open(conn_handle);
+    app_assert_status(sc);
+    throughput_state = THROUGHPUT_L2CAP_OPEN;
+  } else if (throughput_state != THROUGHPUT_NONE) {
+    sc = sl_bt_gatt_discover_primary_services_by_uuid(conn_handle,
+                                                      UUID_LEN,
+                                                      bletest_throughput_service_uuid);
+    app_assert_status(sc);
+    throughput_state = THROUGHPUT_FIND_SERVICES;
+  }
+}
+
+// Check if throughput data is being sent or received.
+static bool throughput_running(void)
+{
+  return throughput_state == THROUGHPUT_NOACK || throughput_state == THROUGHPUT_ACK
+         || throughput_state == THROUGHPUT_L2CAP || throughput_state == THROUGHPUT_L2CAP_RX;
+}
+
+// Set up the security manager for --encrypt. Neither side has a display or
+// keyboard, so pairing is always Just Works; sc only refuses legacy pairing.
+static void configure_security(void)
+{
+  sl_status_t sc;
+
+  sc = sl_bt_sm_configure(encrypt_mode == encrypt_sc ? SM_CONFIG_SC_ONLY : 0,
+                          sl_bt_sm_io_capability_noinputnooutput);
+  app_assert_status(sc);
+  sc = sl_bt_sm_set_bondable_mode(bond_enabled);
+  app_assert_status(sc);
+  // a bond from an earlier run would skip the pairing being timed
+  sc = sl_bt_sm_delete_bondings();
+  app_assert_status(sc);
+}
+
+// Central link encrypted: start the throughput test, unless still waiting
+// for the keys to be stored for the bonded reconnect.
+static void on_link_encrypted(void)
+{
+  if (bond_reconnect_pending == true) {
+    bond_reconnect_pending = false;
+    bond_reconnect_done = true;
+  } else if (bond_enabled == true && bond_reconnect_done == false) {
+    return;
+  }
+  if (throughput_state == THROUGHPUT_ENCRYPT) {
+    start_throughput();
+  }
+}
+
+// Central bonded: reconnect once to time encryption with the stored keys.
+static void on_bonded(uint8_t bonding)
+{
+  sl_status_t sc;
+
+  if (bond_enabled == false || bond_reconnect_done == true) {
+    return;
+  }
+  if (bonding == APP_SECURITY_NO_BOND) {
+    printf("Peer did not bond, skipping the bonded reconnect\n");
+    bond_reconnect_done = true;
+    on_link_encrypted();
+    return;
+  }
+  printf("Reconnecting to time encryption with the stored keys\n");
+  bond_reconnect_pending = true;
+  sc = sl_bt_connection_close(conn_handle);
+  app_assert_status(sc);
+}
+
+// Print the L2CAP totals and end the L2CAP throughput test when its channel,
+// or with cid 0 the connection, is closed.
+static void on_l2cap_closed(uint16_t cid)
+{
+  if (app_l2cap_on_closed(cid) == true) {
+    printf("\r\n");
+    app_l2cap_print();
+  }
+  if (app_l2cap_is_open() == false && (throughput_state == THROUGHPUT_L2CAP_OPEN
+      || throughput_state == THROUGHPUT_L2CAP || throughput_state == THROUGHPUT_L2CAP_RX)) {
+    throughput_state = THROUGHPUT_NONE;
+  }
+}
+
+// Start the next GATT round trip: even ones read, odd ones write a few bytes,
+// both on the write with response characteristic.
+static void gatt_ping_send(void)
+{
+  uint8_t payload[GATT_PING_PAYLOAD_LEN];
+  sl_status_t sc;
+
+  gatt_ping_start_us = app_time_mono_us();
+  if ((gatt_ping_sent & 1u) == 0) {
+    sc = sl_bt_gatt_read_characteristic_value(conn_handle,
+                                              bletest_throughput_write_with_response_handle);
+  } else {
+    memcpy(payload, &gatt_ping_sent, sizeof(payload));
+    sc = sl_bt_gatt_write_characteristic_value(conn_handle,
+                                               bletest_throughput_write_with_response_handle,
+                                               sizeof(payload),
+                                               payload);
+  }
+  app_assert_status(sc);
+  gatt_ping_sent++;
+}
+
+// Time the GATT round trip in flight and start the next one, or end the test.
+static void on_gatt_ping_completed(uint16_t result)
+{
+  int64_t rtt_us = app_time_mono_us() - gatt_ping_start_us;
+  app_gatt_ping_op_t op = ((gatt_ping_sent - 1) & 1u) ? APP_GATT_PING_WRITE : APP_GATT_PING_READ;
+
+  if (result != 0) {
+    app_gatt_ping_add_error(op, result);
+  } else {
+    app_gatt_ping_add(op, rtt_us);
+  }
+  if (app_gatt_ping_count() >= gatt_ping_count) {
+    printf("GATT round trip test complete\r\n");
+    app_deinit();
+  } else {
+    gatt_ping_send();
+  }
+}
+
 // Check if found characteristic matches the UUIDs that we are searching for.
 static void check_characteristic_uuid(sl_bt_msg_t *evt)
 {
@@ -1499,6 +2912,7 @@ void timer_on_report(void)
   size_t map_size;
   int64_t elapsed_time_us;
   uint32_t sent_bits;
+  float throughput_bps = -1;
     sc = sl_bt_connection_read_channel_map(conn_handle,
                                             sizeof(channel_map),
                                              &map_size,
@@ -1507,13 +2921,968 @@ void timer_on_report(void)
     app_log_info("\r\nChannel Map: 0x%x[4] 0x%x[3] 0x%x[2] 0x%x[1] 0x%x[0]" \
             APP_LOG_NL,channel_map[4],channel_map[3],channel_map[2],
             channel_map[1],channel_map[0]);
+    app_metrics_add_counter("channel_map_changed_channels",
+                            app_chmap_add(channel_map, map_size, app_time_mono_us()));
+    if (app_metrics_enabled() == true) {
+      int used_channels = 0;
+      for (size_t i = 0; i < map_size && i < sizeof(channel_map); i++) {
+        used_channels += __builtin_popcount(channel_map[i]);
+      }
+      app_metrics_set_gauge("channel_map_used", used_channels);
+    }
     if (throughput_state != THROUGHPUT_NONE) {
       // also print throughput since last report if running
       elapsed_time_us = cur_time_us() - last_report_time_us;
       sent_bits = bletest_throughput_total_bytes * 8;
-      app_log_info("Throughput since last report: %0.2f bps\r\n", ((float) (sent_bits * 1e6) / (float) (elapsed_time_us)));
+      throughput_bps = (float) (sent_bits * 1e6) / (float) (elapsed_time_us);
+      app_log_info("Throughput since last report: %0.2f bps\r\n", throughput_bps);
+      if (throughput_running() == true) {
+        app_security_add_throughput(bletest_throughput_total_bytes, elapsed_time_us);
+      }
+      app_metrics_set_gauge("throughput_bps", throughput_bps);
+      app_metrics_add_counter("throughput_bytes", bletest_throughput_total_bytes);
       // reset for next report
       last_report_time_us = cur_time_us();
       bletest_throughput_total_bytes = 0;
     }
+    sample_link_counters(throughput_bps);
+    app_events_publish();
+    app_metrics_export("report");
+}
+
+/**************************************************************************//**
+ * Read and reset the link layer packet counters, and add them to the time
+ * series as one interval.
+ *
+ * @param[in] throughput_bps Throughput of the interval, negative if not running.
+ *****************************************************************************/
+static void sample_link_counters(float throughput_bps)
+{
+  sl_status_t sc;
+  app_link_stats_sample_t sample;
+  app_link_stats_coex_t coex_now;
+
+  sc = sl_bt_system_get_counters(true, &sample.tx_packets, &sample.rx_packets,
+                                 &sample.crc_errors, &sample.failures);
+  app_assert_status(sc);
+  sample.time_us = app_time_mono_us();
+  sample.interval_us = (uint32_t)(sample.time_us - link_interval_start_us);
+  sample.throughput_bps = throughput_bps;
+  sample.coex_valid = false;
+  if (coex_last_valid == true && read_coex_counters(&coex_now) == SL_STATUS_OK) {
+    app_link_stats_coex_delta(&coex_now, &coex_last, &sample.coex);
+    coex_last = coex_now;
+    sample.coex_valid = true;
+  }
+  link_interval_start_us = sample.time_us;
+  app_link_stats_add(&sample);
+
+  app_metrics_add_counter("ll_tx_packets", sample.tx_packets);
+  app_metrics_add_counter("ll_rx_packets", sample.rx_packets);
+  app_metrics_add_counter("ll_crc_errors", sample.crc_errors);
+  app_metrics_add_counter("ll_failures", sample.failures);
+  app_metrics_set_gauge("ll_crc_error_rate", app_link_stats_crc_error_rate(&sample));
+  if (sample.coex_valid == true && sample.interval_us != 0) {
+    app_metrics_set_gauge("coex_high_pri_denied_per_s",
+                          sample.coex.high_pri_denied * 1e6 / sample.interval_us);
+    app_metrics_set_gauge("coex_low_pri_denied_per_s",
+                          sample.coex.low_pri_denied * 1e6 / sample.interval_us);
+    app_metrics_set_gauge("coex_tx_abort_per_s",
+                          (sample.coex.low_pri_tx_abort + sample.coex.high_pri_tx_abort)
+                          * 1e6 / sample.interval_us);
+  }
+}
+
+/**************************************************************************//**
+ * Handle an advertising report in the advscan mode
+ *****************************************************************************/
+static void on_adv_report(const bd_addr *address, uint8_t address_type,
+                          uint8_t channel, int8_t rssi, uint8_t flags,
+                          const uint8_t *data, size_t len)
+{
+  app_adv_cache_result_t result;
+
+  if (app_state == survey_run) {
+    // only the channel occupancy counts in a survey
+    app_survey_add_adv(channel, rssi);
+    return;
+  }
+  if (scan_filt_flag == true
+      && memcmp(address->addr, scan_filt_address.addr, sizeof(address->addr)) != 0) {
+    // scan doesn't match the filter - discard
+    return;
+  }
+  scan_counter++;
+  app_adv_sets_on_report(data, len, app_time_mono_us());
+  if (flags & ADV_REPORT_EXTENDED) {
+    scan_extended_count++;
+  }
+  if (flags & ADV_REPORT_CODED) {
+    scan_coded_count++;
+  }
+  if (flags & ADV_REPORT_TRUNCATED) {
+    scan_truncated_count++;
+  }
+  // print scan packet info if not averaging (results are queried in daemon mode)
+  if (daemon_active == true) {
+    rssi_sum += rssi;
+    rssi_count++;
+  } else if (adv_dedup_mode != adv_dedup_off) {
+    result = app_adv_cache_update(address, address_type, data, len,
+                                  rssi, app_time_mono_us());
+    if ((result == app_adv_cache_new && adv_dedup_mode != adv_dedup_stats)
+        || (result == app_adv_cache_changed && adv_dedup_mode == adv_dedup_changed)) {
+      printf("ADV RCVD from MAC ");
+      print_address(*address);
+      printf(", Channel: %d, RSSI: %d, %s\r\n", channel, rssi,
+             (result == app_adv_cache_new) ? "new" : "changed");
+    }
+  } else if (rssi_len == 0) {
+    printf("ADV RCVD from MAC ");
+    print_address(*address);
+    printf(", Channel: %d", channel);
+    printf(", RSSI: %d", rssi);
+    if (flags & ADV_REPORT_EXTENDED) {
+      printf(", extended, %s PHY%s", (flags & ADV_REPORT_CODED) ? "Coded" : "1M",
+             (flags & ADV_REPORT_TRUNCATED) ? ", truncated" : "");
+    }
+    printf("\r\n");
+  } else {
+    // Handle averaging
+    rssi_sum += rssi;
+    rssi_count++;
+    if (rssi_count >= rssi_len) {
+      // print average and reset totals
+      printf("AVG RSSI REPORT: %2.2f\r\n",(float)rssi_sum/(float)rssi_count);
+      app_metrics_set_gauge("adv_rssi_avg_dbm", (double)rssi_sum / rssi_count);
+      app_metrics_set_counter("scan_packets", scan_counter);
+      app_metrics_export("rssi_avg");
+      rssi_count = 0;
+      rssi_sum = 0;
+    }
+  }
+}
+
+/**************************************************************************//**
+ * Handle an extended advertising report. Fragments of chained advertising
+ * data are joined and passed on as one report once the chain ends, marked as
+ * truncated if the controller gave up on the rest of the data.
+ *****************************************************************************/
+static void on_extended_adv_report(const bd_addr *address, uint8_t address_type,
+                                   uint8_t adv_sid, uint8_t channel, int8_t rssi,
+                                   uint8_t flags, uint8_t data_completeness,
+                                   const uint8array *data)
+{
+  bool chained = adv_chain.active
+                 && adv_chain.address_type == address_type
+                 && adv_chain.adv_sid == adv_sid
+                 && memcmp(&adv_chain.address, address, sizeof(*address)) == 0;
+  size_t len;
+
+  if (adv_chain.active && !chained) {
+    // another advertiser's report before the chain ended, the rest is lost
+    adv_chain.active = false;
+    on_adv_report(&adv_chain.address, adv_chain.address_type, adv_chain.channel,
+                  adv_chain.rssi, adv_chain.flags | ADV_REPORT_TRUNCATED,
+                  adv_chain.data, adv_chain.len);
+  }
+  if (data_completeness != sl_bt_scanner_data_status_incomplete_more && !chained) {
+    on_adv_report(address, address_type, channel, rssi,
+                  flags | ((data_completeness == sl_bt_scanner_data_status_incomplete_nomore)
+                           ? ADV_REPORT_TRUNCATED : 0),
+                  data->data, data->len);
+    return;
+  }
+
+  if (!chained) {
+    adv_chain.active = true;
+    adv_chain.address = *address;
+    adv_chain.address_type = address_type;
+    adv_chain.adv_sid = adv_sid;
+    adv_chain.flags = flags;
+    adv_chain.len = 0;
+  }
+  adv_chain.channel = channel;
+  adv_chain.rssi = rssi;
+  len = data->len;
+  if (len > sizeof(adv_chain.data) - adv_chain.len) {
+    len = sizeof(adv_chain.data) - adv_chain.len;
+    adv_chain.flags |= ADV_REPORT_TRUNCATED;
+  }
+  memcpy(&adv_chain.data[adv_chain.len], data->data, len);
+  adv_chain.len += len;
+  if (data_completeness == sl_bt_scanner_data_status_incomplete_more) {
+    return;
+  }
+  adv_chain.active = false;
+  if (data_completeness == sl_bt_scanner_data_status_incomplete_nomore) {
+    adv_chain.flags |= ADV_REPORT_TRUNCATED;
+  }
+  on_adv_report(&adv_chain.address, adv_chain.address_type, adv_chain.channel,
+                adv_chain.rssi, adv_chain.flags, adv_chain.data, adv_chain.len);
+}
+
+/**************************************************************************//**
+ * Apply the scan settings and start scanning
+ *****************************************************************************/
+static sl_status_t start_scanner(void)
+{
+  sl_status_t sc;
+
+  sc = sl_bt_scanner_set_parameters(scan_mode, scan_interval, scan_window);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  scan_extended_count = 0;
+  scan_coded_count = 0;
+  scan_truncated_count = 0;
+  adv_chain.active = false;
+  scan_start_us = app_time_mono_us();
+  return sl_bt_scanner_start(scan_phy, sl_bt_scanner_discover_observation);
+}
+
+/**************************************************************************//**
+ * Print the report capture rate of the scan settings
+ *****************************************************************************/
+static void print_scan_capture(void)
+{
+  double elapsed_s = (app_time_mono_us() - scan_start_us) / 1e6;
+  double reports_per_s = (elapsed_s > 0) ? scan_counter / elapsed_s : 0.0;
+  double duty_cycle = 100.0 * scan_window / scan_interval;
+
+  printf("Scan capture: %s PHY, %s, interval %.1f ms, window %.1f ms (duty cycle %.0f%%",
+         (scan_phy == sl_bt_scanner_scan_phy_1m) ? "1M"
+         : (scan_phy == sl_bt_scanner_scan_phy_coded) ? "Coded" : "1M and Coded",
+         (scan_mode == sl_bt_scanner_scan_mode_active) ? "active" : "passive",
+         scan_interval * SCAN_UNIT_MS, scan_window * SCAN_UNIT_MS, duty_cycle);
+  if (scan_phy == sl_bt_scanner_scan_phy_1m_and_coded) {
+    // the scan time is shared between the two PHYs
+    printf(", %.0f%% per PHY", duty_cycle / 2);
+  }
+  printf(")\r\n");
+  printf("  %u reports in %.1f s (%.1f reports/s): legacy %u, extended %u "
+         "(Coded primary PHY %u, truncated %u)\r\n",
+         scan_counter, elapsed_s, reports_per_s, scan_counter - scan_extended_count,
+         scan_extended_count, scan_coded_count, scan_truncated_count);
+  app_metrics_set_gauge("scan_reports_per_s", reports_per_s);
+  app_metrics_set_counter("scan_extended_reports", scan_extended_count);
+  app_metrics_set_counter("scan_truncated_reports", scan_truncated_count);
+}
+
+/**************************************************************************//**
+ * Publish the packet count of a completed DTM test
+ *****************************************************************************/
+static void publish_dtm_result(uint16_t packets)
+{
+  report_dtm_model(packets);
+  if (app_state == dtm_rx_started) {
+    app_metrics_set_counter("dtm_rx_packets", packets);
+  } else {
+    app_metrics_set_counter("dtm_tx_packets", packets);
+  }
+  app_metrics_export("dtm_completed");
+}
+
+/**************************************************************************//**
+ * Compare a DTM packet count with the packet timing model: the efficiency
+ * of a transmit test, or with --per_ref_time the PER of a receive test
+ *****************************************************************************/
+static void report_dtm_model(uint16_t packets)
+{
+  uint32_t expected;
+  uint32_t lost;
+  double per_low;
+  double per_high;
+  double per;
+
+  if (app_state == dtm_tx_started) {
+    if (packet_type == sl_bt_test_pkt_carrier || packet_type == sl_bt_test_pkt_pn9) {
+      return; // no packets
+    }
+    expected = app_dtm_model_expected(selected_phy, packet_length, dtm_stop_us - dtm_start_us);
+  } else if (per_ref_time_ms != 0) {
+    expected = app_dtm_model_expected(selected_phy, packet_length, (int64_t)per_ref_time_ms * 1000);
+  } else {
+    return;
+  }
+  if (expected == 0) {
+    return;
+  }
+  printf("Packet model: %u byte packets on the %s PHY every %u us, %u packets expected in %.1f ms\n",
+         packet_length, app_dtm_model_phy_name(selected_phy),
+         app_dtm_model_interval_us(selected_phy, packet_length), expected,
+         app_state == dtm_tx_started ? (dtm_stop_us - dtm_start_us) / 1000.0 : (double)per_ref_time_ms);
+  if (expected > UINT16_MAX) {
+    printf("The NCP packet counter is 16 bits and wrapped, use a shorter test to compare with the model\n");
+    return;
+  }
+  if (app_state == dtm_tx_started) {
+    printf("TX efficiency: %.1f%% of the expected packets\n", 100.0 * packets / expected);
+    app_metrics_set_counter("dtm_tx_expected_packets", expected);
+    app_metrics_set_gauge("dtm_tx_efficiency", (double)packets / expected);
+    return;
+  }
+  if (packets > expected) {
+    printf("More packets than expected, check --len, --phy and --per_ref_time against the transmitter\n");
+  }
+  lost = packets < expected ? expected - packets : 0;
+  per = (double)lost / expected;
+  app_dtm_model_wilson(lost, expected, APP_DTM_MODEL_Z95, &per_low, &per_high);
+  printf("PER: %.2f%% (95%% confidence interval %.2f-%.2f%%), %u of %u packets received\n",
+         100 * per, 100 * per_low, 100 * per_high, packets, expected);
+  app_metrics_set_counter("dtm_rx_expected_packets", expected);
+  app_metrics_set_gauge("dtm_rx_per", per);
+  app_metrics_set_gauge("dtm_rx_per_low", per_low);
+  app_metrics_set_gauge("dtm_rx_per_high", per_high);
+  if (per_limit >= 0) {
+    dtm_per_failed = (100 * per > per_limit);
+    printf("PER limit %.2f%%: %s", per_limit, dtm_per_failed == true ? "FAIL" : "PASS");
+    if (100 * per_low <= per_limit && 100 * per_high > per_limit) {
+      printf(" (marginal, the limit is inside the confidence interval)");
+    }
+    printf("\n");
+    app_metrics_set_gauge("dtm_rx_per_pass", dtm_per_failed == true ? 0 : 1);
+  }
+}
+
+/**************************************************************************//**
+ * Channel survey: start the DTM dwell on an RF channel, or the scanner window
+ * after the last channel
+ *****************************************************************************/
+static void survey_start_step(uint8_t step)
+{
+  sl_status_t sc;
+
+  survey_step = step;
+  survey_step_start_us = 0;
+  survey_step_stop_us = 0;
+  if (step < SURVEY_SCAN_STEP) {
+    // the dwell starts with the completed event of the start
+    sc = sl_bt_test_dtm_rx(step, selected_phy);
+    app_assert_status(sc);
+  } else {
+    sc = start_scanner();
+    app_assert_status(sc);
+    survey_step_start_us = cur_time_us();
+  }
+}
+
+/**************************************************************************//**
+ * Channel survey: DTM completed event, the receiver started or a dwell ended
+ *****************************************************************************/
+static void on_survey_dtm_completed(uint16_t packets)
+{
+  if (survey_step >= SURVEY_SCAN_STEP) {
+    return; // late event of a dwell stopped by app_deinit()
+  }
+  if (survey_step_start_us == 0) {
+    survey_step_start_us = cur_time_us();
+    return;
+  }
+  app_survey_add_dtm(survey_step, packets, (uint32_t)(survey_step_stop_us - survey_step_start_us));
+  survey_start_step(survey_step + 1);
+}
+
+/**************************************************************************//**
+ * Segmented DTM receive: the receiver is on
+ *****************************************************************************/
+static void on_rx_segment_started(void)
+{
+  rx_segment_start_us = cur_time_us();
+  if (rx_segment_stop_us != 0) {
+    rx_segment_gap_us = rx_segment_start_us - rx_segment_stop_us;
+  }
+  rx_segment_stop_us = 0;
+}
+
+/**************************************************************************//**
+ * Segmented DTM receive: record a segment that ended
+ *****************************************************************************/
+static void add_rx_segment(uint16_t packets)
+{
+  app_rx_segment_t segment;
+
+  if (rx_segment_start_us == 0) {
+    return; // ended before the receiver started
+  }
+  segment.time_us = rx_segment_start_us;
+  segment.rx_us = (uint32_t)(rx_segment_stop_us - rx_segment_start_us);
+  segment.gap_us = (uint32_t)rx_segment_gap_us;
+  segment.packets = packets;
+  app_rx_segments_add(&segment);
+  rx_segment_start_us = 0;
+}
+
+/**************************************************************************//**
+ * Segmented DTM receive: a segment ended, restart the receiver at once
+ *****************************************************************************/
+static void on_rx_segment_completed(uint16_t packets)
+{
+  sl_status_t sc;
+
+  add_rx_segment(packets);
+  if (rx_test_end_us != 0 && cur_time_us() >= rx_test_end_us) {
+    finish_rx_segments();
+    exit(EXIT_SUCCESS); //test done - terminate
+  }
+  if (app_shutdown_requested()) {
+    // DTM is stopped, app_deinit() only prints the results
+    app_state = default_state;
+    return;
+  }
+  app_state = dtm_rx_begin;
+  sc = sl_bt_test_dtm_rx(channel,selected_phy);
+  app_assert_status(sc);
+}
+
+/**************************************************************************//**
+ * Segmented DTM receive: print and publish the packet count series
+ *****************************************************************************/
+static void finish_rx_segments(void)
+{
+  app_rx_segments_print();
+  app_rx_segments_publish();
+  app_metrics_export("dtm_completed");
+}
+
+/**************************************************************************//**
+ * Daemon mode request handlers
+ *****************************************************************************/
+static uint8_t parse_mac(const char *str, bd_addr *address)
+{
+  int values[6];
+  if (6 != sscanf(str, "%x:%x:%x:%x:%x:%x", &values[5], &values[4],
+                  &values[3], &values[2], &values[1], &values[0])) {
+    return false;
+  }
+  for (int i = 0; i < 6; i++) {
+    address->addr[i] = (uint8_t) values[i];
+  }
+  return true;
+}
+
+/* Parse a numeric request argument, answer the request if it is invalid */
+static bool daemon_arg(const char *name, const char *arg, long min, long max, long *value)
+{
+  char *end;
+
+  *value = strtol(arg, &end, 0);
+  if (end == arg || *end != '\0' || *value < min || *value > max) {
+    app_daemon_reply(SL_STATUS_INVALID_PARAMETER, "%s must be %ld-%ld", name, min, max);
+    return false;
+  }
+  return true;
+}
+
+static sl_status_t daemon_cmd_ping(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  app_daemon_reply(SL_STATUS_OK, "ncp=%d.%d.%d app=%d.%d", version_major,
+                   version_minor, version_patch, VERSION_MAJ, VERSION_MIN);
+  return SL_STATUS_OK;
+}
+
+/* Timed DTM requests are answered by the DTM completed event */
+static sl_status_t daemon_wait_dtm(uint32_t time_ms)
+{
+  if (time_ms == 0) {
+    return SL_STATUS_OK; // runs until dtm_end
+  }
+  daemon_op = daemon_op_dtm;
+  daemon_dtm_end_us = cur_time_us() + (int64_t)time_ms * 1000;
+  return SL_STATUS_IN_PROGRESS;
+}
+
+static sl_status_t daemon_cmd_dtm_tx(int argc, char *argv[])
+{
+  sl_status_t sc;
+  long type, len, ch, phy, power, time_ms;
+
+  if (argc != 7) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (app_state != daemon_idle) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  if (!daemon_arg("packet_type", argv[1], 0, UINT8_MAX, &type)
+      || !daemon_arg("len", argv[2], 0, UINT8_MAX, &len)
+      || !daemon_arg("channel", argv[3], 0, 39, &ch)
+      || !daemon_arg("phy", argv[4], 1, 4, &phy)
+      || !daemon_arg("power", argv[5], MIN_POWER_LEVEL, MAX_POWER_LEVEL, &power)
+      || !daemon_arg("time", argv[6], 0, INT32_MAX, &time_ms)) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if ((type != sl_bt_test_pkt_carrier) && (type != sl_bt_test_pkt_pn9)) {
+    sc = sl_bt_test_dtm_tx_v4((uint8_t)type, (uint8_t)len, (uint8_t)ch, (uint8_t)phy,
+                              (int8_t) (power/10));
+  } else {
+    sc = sl_bt_test_dtm_tx_cw((uint8_t)type, (uint8_t)ch, (uint8_t)phy, (int16_t)power);
+  }
+  if (sc) {
+    return sc;
+  }
+  app_state = dtm_tx_begin;
+  return daemon_wait_dtm((uint32_t)time_ms);
+}
+
+static sl_status_t daemon_cmd_dtm_rx(int argc, char *argv[])
+{
+  sl_status_t sc;
+  long ch, phy, time_ms;
+
+  if (argc != 4) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (app_state != daemon_idle) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  if (!daemon_arg("channel", argv[1], 0, 39, &ch)
+      || !daemon_arg("phy", argv[2], 1, 4, &phy)
+      || !daemon_arg("time", argv[3], 0, INT32_MAX, &time_ms)) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  sc = sl_bt_test_dtm_rx((uint8_t)ch, (uint8_t)phy);
+  if (sc) {
+    return sc;
+  }
+  app_state = dtm_rx_begin;
+  return daemon_wait_dtm((uint32_t)time_ms);
+}
+
+static sl_status_t daemon_cmd_dtm_end(int argc, char *argv[])
+{
+  sl_status_t sc;
+  (void)argc;
+  (void)argv;
+
+  if (app_state != dtm_rx_begin && app_state != dtm_tx_begin &&
+      app_state != dtm_rx_started && app_state != dtm_tx_started) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  sc = sl_bt_test_dtm_end();
+  if (sc) {
+    return sc;
+  }
+  daemon_op = daemon_op_dtm;
+  daemon_dtm_end_us = 0;
+  return SL_STATUS_IN_PROGRESS;
+}
+
+static sl_status_t daemon_cmd_scan_start(int argc, char *argv[])
+{
+  sl_status_t sc;
+
+  if (app_state != daemon_idle) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  scan_filt_flag = false;
+  if (argc > 1) {
+    if (!parse_mac(argv[1], &scan_filt_address)) {
+      return SL_STATUS_INVALID_PARAMETER;
+    }
+    scan_filt_flag = true;
+  }
+  scan_counter = 0;
+  rssi_sum = 0;
+  rssi_count = 0;
+  sc = start_scanner();
+  if (sc) {
+    return sc;
+  }
+  app_state = advscan_run;
+  return SL_STATUS_OK;
+}
+
+static sl_status_t daemon_cmd_scan_stop(int argc, char *argv[])
+{
+  sl_status_t sc;
+  (void)argc;
+  (void)argv;
+
+  if (app_state != advscan_run) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  sc = sl_bt_scanner_stop();
+  if (sc) {
+    return sc;
+  }
+  app_state = daemon_idle;
+  app_daemon_reply(SL_STATUS_OK, "reports=%u avg_rssi=%.2f", scan_counter,
+                   rssi_count ? (float)rssi_sum/(float)rssi_count : 0.0f);
+  return SL_STATUS_OK;
+}
+
+static sl_status_t daemon_cmd_adv_start(int argc, char *argv[])
+{
+  sl_status_t sc;
+  int16_t power_level_set_min, power_level_set_max;
+  long value;
+
+  if (app_state != daemon_idle) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  if (argc > 1) {
+    if (!daemon_arg("period", argv[1], 0x20, UINT16_MAX, &value)) {
+      return SL_STATUS_INVALID_PARAMETER;
+    }
+    adv_period = (uint16_t)value;
+  }
+  if (argc > 2) {
+    if (!daemon_arg("power", argv[2], MIN_POWER_LEVEL, MAX_POWER_LEVEL, &value)) {
+      return SL_STATUS_INVALID_PARAMETER;
+    }
+    power_level = (int16_t)value;
+  }
+  sc = sl_bt_system_set_tx_power(power_level, power_level, &power_level_set_min, &power_level_set_max);
+  if (sc) {
+    return sc;
+  }
+  ensure_gatt_database();
+  sc = start_advertising();
+  if (sc) {
+    return sc;
+  }
+  app_state = adv_test_advertising;
+  app_daemon_reply(SL_STATUS_OK, "period=%d power=%d", adv_period, power_level_set_max);
+  return SL_STATUS_OK;
+}
+
+static sl_status_t daemon_cmd_adv_stop(int argc, char *argv[])
+{
+  sl_status_t sc;
+  (void)argc;
+  (void)argv;
+
+  if (app_state != adv_test_advertising) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  sc = sl_bt_advertiser_stop(advertising_set_handle);
+  if (sc) {
+    return sc;
+  }
+  app_state = daemon_idle;
+  return SL_STATUS_OK;
+}
+
+static sl_status_t daemon_cmd_conn(int argc, char *argv[])
+{
+  sl_status_t sc;
+  long interval = conn_interval;
+  long ack = 0;
+
+  if (argc < 2) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (app_state != daemon_idle) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  if (!parse_mac(argv[1], &conn_address)) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if ((argc > 2 && !daemon_arg("conn interval", argv[2], 6, 3200, &interval))
+      || (argc > 3 && !daemon_arg("throughput ack", argv[3], 0, 1, &ack))) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  conn_interval = (uint16_t)interval;
+  throughput_state = THROUGHPUT_NONE;
+  if (argc > 3) {
+    throughput_state = THROUGHPUT_CONNECT;
+    bletest_throughput_ack = (ack != 0);
+    bletest_throughput_write_with_response_handle = 0xFFFF;
+    bletest_throughput_write_no_response_handle = 0xFFFF;
+    bletest_throughput_total_bytes = 0;
+  }
+  sc = open_connection();
+  if (sc != SL_STATUS_OK) {
+    throughput_state = THROUGHPUT_NONE;
+    return sc;
+  }
+  // an absent peer never answers, give up after a while
+  sc = sl_bt_system_set_lazy_soft_timer((uint32_t)32 * DAEMON_CONN_TIMEOUT_MS, 0,
+                                        CONN_TIMER_HANDLE, true);
+  if (sc != SL_STATUS_OK) {
+    (void)sl_bt_connection_close(conn_handle);
+    app_state = daemon_idle;
+    throughput_state = THROUGHPUT_NONE;
+    return sc;
+  }
+  daemon_conn_timed_out = false;
+  daemon_op = daemon_op_conn;
+  return SL_STATUS_IN_PROGRESS;
+}
+
+static sl_status_t daemon_cmd_disconnect(int argc, char *argv[])
+{
+  sl_status_t sc;
+  (void)argc;
+  (void)argv;
+
+  if (app_state != connected && app_state != adv_test_connected) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  sc = sl_bt_connection_close(conn_handle);
+  if (sc) {
+    return sc;
+  }
+  daemon_op = daemon_op_disconnect;
+  return SL_STATUS_IN_PROGRESS;
+}
+
+static sl_status_t daemon_cmd_status(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  app_daemon_reply(SL_STATUS_OK, "state=%d throughput=%d bytes=%" PRIu64,
+                   app_state, throughput_state, bletest_throughput_total_bytes);
+  return SL_STATUS_OK;
+}
+
+static sl_status_t daemon_cmd_nvm_load(int argc, char *argv[])
+{
+  sl_status_t sc;
+  uint8_t value[APP_CUST_MAX_PAYLOAD_LEN];
+  size_t value_len;
+  char hex[2 * sizeof(value) + 1];
+  long key;
+
+  if (argc != 2) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (!daemon_arg("key", argv[1], 0, UINT16_MAX, &key)) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  sc = sl_bt_nvm_load((uint16_t)key, sizeof(value), &value_len, value);
+  if (sc) {
+    return sc;
+  }
+  for (size_t i = 0; i < value_len; i++) {
+    sprintf(&hex[2 * i], "%02x", value[i]);
+  }
+  hex[2 * value_len] = '\0';
+  app_daemon_reply(SL_STATUS_OK, "value=%s", hex);
+  return SL_STATUS_OK;
+}
+
+static sl_status_t daemon_cmd_nvm_save(int argc, char *argv[])
+{
+  sl_status_t sc;
+  uint8_t value[APP_CUST_MAX_PAYLOAD_LEN];
+  size_t value_len;
+  long key;
+
+  if (argc != 3) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (!daemon_arg("key", argv[1], 0, UINT16_MAX, &key)) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  sc = app_cust_parse_hex(argv[2], value, sizeof(value), &value_len);
+  if (sc) {
+    return sc;
+  }
+  return sl_bt_nvm_save((uint16_t)key, value_len, value);
+}
+
+static sl_status_t daemon_cmd_nvm_erase(int argc, char *argv[])
+{
+  long key;
+
+  if (argc != 2) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (!daemon_arg("key", argv[1], 0, UINT16_MAX, &key)) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  return sl_bt_nvm_erase((uint16_t)key);
+}
+
+static sl_status_t daemon_cmd_cust(int argc, char *argv[])
+{
+  sl_status_t sc;
+  uint8_t data[APP_CUST_MAX_PAYLOAD_LEN];
+  size_t data_len;
+  uint8_t response[APP_CUST_MAX_PAYLOAD_LEN];
+  size_t response_len;
+  char hex[2 * sizeof(response) + 1];
+
+  if (argc != 2) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  sc = app_cust_parse_hex(argv[1], data, sizeof(data), &data_len);
+  if (sc) {
+    return sc;
+  }
+  sc = sl_bt_user_message_to_target(data_len, data, sizeof(response), &response_len, response);
+  if (sc) {
+    return sc;
+  }
+  for (size_t i = 0; i < response_len; i++) {
+    sprintf(&hex[2 * i], "%02x", response[i]);
+  }
+  hex[2 * response_len] = '\0';
+  app_daemon_reply(SL_STATUS_OK, "payload=%s", hex);
+  return SL_STATUS_OK;
+}
+
+static sl_status_t daemon_cmd_reset(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+
+  if (app_state != daemon_idle) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  daemon_op = daemon_op_reset;
+  ncp_reset();
+  return SL_STATUS_IN_PROGRESS;
+}
+
+static sl_status_t daemon_cmd_quit(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+  // reply first, the main loop closes the socket in app_deinit()
+  app_daemon_reply(SL_STATUS_OK, NULL);
+  app_shutdown_request();
+  return SL_STATUS_OK;
+}
+
+static const app_daemon_command_t daemon_commands[] = {
+  { "ping",       "",                                         daemon_cmd_ping },
+  { "status",     "",                                         daemon_cmd_status },
+  { "dtm_tx",     "<packet_type> <len> <channel> <phy> <power> <time ms, 0 until dtm_end>", daemon_cmd_dtm_tx },
+  { "dtm_rx",     "<channel> <phy> <time ms, 0 until dtm_end>", daemon_cmd_dtm_rx },
+  { "dtm_end",    "",                                         daemon_cmd_dtm_end },
+  { "scan_start", "[MAC filter]",                             daemon_cmd_scan_start },
+  { "scan_stop",  "",                                         daemon_cmd_scan_stop },
+  { "adv_start",  "[period] [power]",                         daemon_cmd_adv_start },
+  { "adv_stop",   "",                                         daemon_cmd_adv_stop },
+  { "conn",       "<MAC> [conn interval] [throughput ack 0 or 1], fails after 10 s", daemon_cmd_conn },
+  { "disconnect", "",                                         daemon_cmd_disconnect },
+  { "nvm_load",   "<key>",                                    daemon_cmd_nvm_load },
+  { "nvm_save",   "<key> <ASCII hex value>",                  daemon_cmd_nvm_save },
+  { "nvm_erase",  "<key>",                                    daemon_cmd_nvm_erase },
+  { "cust",       "<ASCII hex string>",                       daemon_cmd_cust },
+  { "reset",      "",                                         daemon_cmd_reset },
+  { "quit",       "",                                         daemon_cmd_quit },
+};
+
+/* Open the control socket, called once after the first boot */
+static void daemon_start(void)
+{
+  sl_status_t sc;
+
+  sc = app_daemon_init(daemon_socket_path, daemon_commands,
+                       sizeof(daemon_commands)/sizeof(daemon_commands[0]));
+  if (sc != SL_STATUS_OK) {
+    printf("Error! Cannot open daemon socket \"%s\"\n", daemon_socket_path);
+    exit(EXIT_FAILURE);
+  }
+  daemon_active = true;
+  app_state = daemon_idle;
+  printf("Daemon mode, listening on %s. Press control-c to exit...\n", daemon_socket_path);
+}
+
+/**************************************************************************//**
+ * Reset the NCP, the boot event continues the startup.
+ *****************************************************************************/
+static void ncp_reset(void)
+{
+  ncp_reset_count++;
+  sl_bt_system_reset(sl_bt_system_boot_mode_normal);
+}
+
+/**************************************************************************//**
+ * Try to take over a running NCP without resetting it. The NCP is probed with
+ * hello and then returned to idle: DTM ended, scanner and advertisers stopped
+ * and connections closed. Stray events are drained and discarded.
+ *
+ * @return SL_STATUS_OK if the NCP is ready, error code if a reset is needed.
+ *****************************************************************************/
+static sl_status_t ncp_fast_start(void)
+{
+  sl_status_t sc;
+  sl_bt_msg_t evt;
+  uint16_t major, minor, patch, build;
+  uint32_t bootloader, hash;
+  uint32_t open_connections = 0;
+  int64_t deadline_us;
+  int64_t quiet_us;
+
+  sc = sl_bt_system_hello();
+  if (sc != SL_STATUS_OK) {
+    app_log_debug("Fast start: no hello response (0x%04x), resetting NCP\n", sc);
+    return sc;
+  }
+  sc = sl_bt_system_get_version(&major, &minor, &patch, &build, &bootloader, &hash);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  version_major = major;
+  version_minor = minor;
+  version_patch = patch;
+  printf("\nNCP running, reset skipped: version %d.%d.%d, build %d\n",
+         version_major, version_minor, version_patch, build);
+
+  // Return the NCP to idle. Errors only mean there was nothing to stop.
+  (void)sl_bt_test_dtm_end();
+  (void)sl_bt_scanner_stop();
+  for (uint8_t handle = 0; handle < FAST_START_MAX_ADV_SETS; handle++) {
+    (void)sl_bt_advertiser_stop(handle);
+    (void)sl_bt_advertiser_delete_set(handle);
+  }
+  for (uint8_t handle = 1; handle <= FAST_START_MAX_CONNECTIONS; handle++) {
+    if (sl_bt_connection_close(handle) == SL_STATUS_OK) {
+      open_connections++;
+    }
+  }
+  (void)sl_bt_system_set_lazy_soft_timer(0, 0, REPORT_TIMER_HANDLE, false);
+  (void)sl_bt_system_set_lazy_soft_timer(0, 0, ADV_STEP_TIMER_HANDLE, false);
+  (void)sl_bt_system_set_lazy_soft_timer(0, 0, CONN_TIMER_HANDLE, false);
+
+  // Drain events until the connections are closed and the NCP is quiet
+  deadline_us = app_time_mono_us() + (int64_t)CANCEL_TIMEOUT_SECONDS * 1000000;
+  quiet_us = app_time_mono_us() + FAST_START_DRAIN_US;
+  while (open_connections > 0 || app_time_mono_us() < quiet_us) {
+    if (app_time_mono_us() > deadline_us) {
+      app_log_debug("Fast start: cleanup timed out, resetting NCP\n");
+      return SL_STATUS_TIMEOUT;
+    }
+    if (sl_bt_pop_event(&evt) != SL_STATUS_OK) {
+      usleep(1000);
+      continue;
+    }
+    quiet_us = app_time_mono_us() + FAST_START_DRAIN_US;
+    switch (SL_BT_MSG_ID(evt.header)) {
+      case sl_bt_evt_connection_closed_id:
+        if (open_connections > 0) {
+          open_connections--;
+        }
+        break;
+      case sl_bt_evt_system_boot_id:
+        // NCP rebooted on its own, it's in a defined state but without the
+        // earlier GATT database
+        ncp_boot_seen = true;
+        break;
+      default:
+        app_log_debug("Fast start: discarded event 0x%08x\n", SL_BT_MSG_ID(evt.header));
+        break;
+    }
+  }
+
+  // A database can't be taken out again, so in the modes with a GATT server
+  // a database of an earlier run with another layout, e.g. other security or
+  // profile, needs a reset
+  if (ncp_boot_seen == false
+      && (app_state == adv_test_advertising_wait || daemon_socket_path != NULL)) {
+    uint32_t lookups;
+
+    if (app_gattdb_find_layout(gattdb_state_path(), &app_gattdb_profile, &lookups)
+        == SL_STATUS_INVALID_STATE) {
+      printf("GATT database of an earlier run has another layout, resetting NCP\n");
+      return SL_STATUS_INVALID_STATE;
+    }
+  }
+  return SL_STATUS_OK;
 }
@@ -0,0 +1,259 @@
+/***************************************************************************//**
+ * @file
+ * @brief Fixed-size cache of seen advertisers for advscan duplicate suppression and rate accounting.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "app_adv_cache.h"
+
+#define NO_ENTRY 0xFFFF
+// Hash buckets, a power of two
+#define BUCKET_COUNT 512
+
+typedef struct {
+  bd_addr address;
+  uint8_t address_type;
+  int8_t last_rssi;
+  uint32_t payload_hash;
+  int64_t last_us;
+  uint32_t reports;
+  uint32_t changes;
+  // inter-arrival time, Welford's online mean and variance
+  uint32_t interval_count;
+  double interval_mean_us;
+  double interval_m2;
+  uint16_t lru_prev;      // more recently seen
+  uint16_t lru_next;      // less recently seen
+  uint16_t bucket_next;
+} adv_entry_t;
+
+static adv_entry_t entries[APP_ADV_CACHE_MAX_ENTRIES];
+static uint16_t buckets[BUCKET_COUNT];
+static size_t cache_capacity;
+static size_t entry_count;
+static int64_t window_us;
+static uint16_t lru_head = NO_ENTRY;   // most recently seen
+static uint16_t lru_tail = NO_ENTRY;   // least recently seen
+static uint32_t total_reports;
+static uint32_t repeat_reports;
+static uint32_t changed_reports;
+static uint32_t evictions;
+static int64_t first_report_us;
+static int64_t last_report_us;
+
+// 32-bit FNV-1a
+static uint32_t fnv1a(const uint8_t *data, size_t len)
+{
+  uint32_t hash = 2166136261u;
+
+  for (size_t i = 0; i < len; i++) {
+    hash = (hash ^ data[i]) * 16777619u;
+  }
+  return hash;
+}
+
+static uint16_t bucket_of(const bd_addr *address, uint8_t address_type)
+{
+  return (uint16_t)((fnv1a(address->addr, sizeof(address->addr)) ^ address_type)
+                    & (BUCKET_COUNT - 1));
+}
+
+static void lru_unlink(uint16_t index)
+{
+  adv_entry_t *entry = &entries[index];
+
+  if (entry->lru_prev != NO_ENTRY) {
+    entries[entry->lru_prev].lru_next = entry->lru_next;
+  } else {
+    lru_head = entry->lru_next;
+  }
+  if (entry->lru_next != NO_ENTRY) {
+    entries[entry->lru_next].lru_prev = entry->lru_prev;
+  } else {
+    lru_tail = entry->lru_prev;
+  }
+}
+
+static void lru_push_front(uint16_t index)
+{
+  entries[index].lru_prev = NO_ENTRY;
+  entries[index].lru_next = lru_head;
+  if (lru_head != NO_ENTRY) {
+    entries[lru_head].lru_prev = index;
+  }
+  lru_head = index;
+  if (lru_tail == NO_ENTRY) {
+    lru_tail = index;
+  }
+}
+
+static void bucket_remove(uint16_t index)
+{
+  uint16_t *link = &buckets[bucket_of(&entries[index].address,
+                                      entries[index].address_type)];
+
+  while (*link != index) {
+    link = &entries[*link].bucket_next;
+  }
+  *link = entries[index].bucket_next;
+}
+
+// Take a free entry, or evict the least recently seen advertiser.
+static uint16_t allocate_entry(void)
+{
+  uint16_t index;
+
+  if (entry_count < cache_capacity) {
+    return (uint16_t)entry_count++;
+  }
+  index = lru_tail;
+  lru_unlink(index);
+  bucket_remove(index);
+  evictions++;
+  return index;
+}
+
+// Initialize the cache.
+sl_status_t app_adv_cache_init(size_t capacity, uint32_t window_ms)
+{
+  if (capacity == 0 || capacity > APP_ADV_CACHE_MAX_ENTRIES) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  cache_capacity = capacity;
+  window_us = (int64_t)window_ms * 1000;
+  entry_count = 0;
+  lru_head = NO_ENTRY;
+  lru_tail = NO_ENTRY;
+  for (size_t i = 0; i < BUCKET_COUNT; i++) {
+    buckets[i] = NO_ENTRY;
+  }
+  total_reports = 0;
+  repeat_reports = 0;
+  changed_reports = 0;
+  evictions = 0;
+  return SL_STATUS_OK;
+}
+
+// Add an advertising report and classify it.
+app_adv_cache_result_t app_adv_cache_update(const bd_addr *address,
+                                            uint8_t address_type,
+                                            const uint8_t *data,
+                                            size_t len,
+                                            int8_t rssi,
+                                            int64_t time_us)
+{
+  uint16_t bucket = bucket_of(address, address_type);
+  uint16_t index = buckets[bucket];
+  uint32_t payload_hash = fnv1a(data, len);
+  adv_entry_t *entry;
+  app_adv_cache_result_t result;
+  double interval_us;
+  double delta;
+
+  if (total_reports++ == 0) {
+    first_report_us = time_us;
+  }
+  last_report_us = time_us;
+
+  while (index != NO_ENTRY
+         && (entries[index].address_type != address_type
+             || memcmp(&entries[index].address, address, sizeof(*address)) != 0)) {
+    index = entries[index].bucket_next;
+  }
+
+  if (index == NO_ENTRY) {
+    index = allocate_entry();
+    entry = &entries[index];
+    memset(entry, 0, sizeof(*entry));
+    entry->address = *address;
+    entry->address_type = address_type;
+    entry->bucket_next = buckets[bucket];
+    buckets[bucket] = index;
+    result = app_adv_cache_new;
+  } else {
+    entry = &entries[index];
+    lru_unlink(index);
+    interval_us = (double)(time_us - entry->last_us);
+    if (interval_us > window_us) {
+      result = app_adv_cache_new; // gone for longer than the window
+    } else {
+      entry->interval_count++;
+      delta = interval_us - entry->interval_mean_us;
+      entry->interval_mean_us += delta / entry->interval_count;
+      entry->interval_m2 += delta * (interval_us - entry->interval_mean_us);
+      if (entry->payload_hash != payload_hash) {
+        entry->changes++;
+        changed_reports++;
+        result = app_adv_cache_changed;
+      } else {
+        repeat_reports++;
+        result = app_adv_cache_repeat;
+      }
+    }
+  }
+  lru_push_front(index);
+  entry->payload_hash = payload_hash;
+  entry->last_us = time_us;
+  entry->last_rssi = rssi;
+  entry->reports++;
+  return result;
+}
+
+// Print the host report rate and the per-advertiser statistics.
+void app_adv_cache_print(void)
+{
+  double elapsed_s = (last_report_us - first_report_us) / 1e6;
+  adv_entry_t *entry;
+  double jitter_ms;
+
+  printf("\nAdvertising reports: %u in %.1f s (%.1f reports/s), %u repeated payloads, "
+         "%u changed payloads, %zu advertisers cached, %u evicted\n",
+         total_reports, elapsed_s, (elapsed_s > 0) ? total_reports / elapsed_s : 0.0,
+         repeat_reports, changed_reports, entry_count, evictions);
+  if (entry_count == 0) {
+    return;
+  }
+  printf("  address            reports  changes  interval[ms]  jitter[ms]  last RSSI\n");
+  // most recently seen first
+  for (uint16_t index = lru_head; index != NO_ENTRY; index = entry->lru_next) {
+    entry = &entries[index];
+    printf("  %02X:%02X:%02X:%02X:%02X:%02X %8u %8u",
+           entry->address.addr[5], entry->address.addr[4], entry->address.addr[3],
+           entry->address.addr[2], entry->address.addr[1], entry->address.addr[0],
+           entry->reports, entry->changes);
+    if (entry->interval_count > 0) {
+      jitter_ms = (entry->interval_count > 1)
+                  ? sqrt(entry->interval_m2 / (entry->interval_count - 1)) / 1000 : 0.0;
+      printf(" %13.1f %11.1f", entry->interval_mean_us / 1000, jitter_ms);
+    } else {
+      printf(" %13s %11s", "-", "-");
+    }
+    printf(" %10d\n", entry->last_rssi);
+  }
+}
@@ -0,0 +1,86 @@
+/***************************************************************************//**
+ * @file
+ * @brief Fixed-size cache of seen advertisers for advscan duplicate suppression and rate accounting.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_ADV_CACHE_H
+#define APP_ADV_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sl_bt_api.h"
+
+// Largest number of advertisers the cache can hold.
+#define APP_ADV_CACHE_MAX_ENTRIES 1024
+
+// Classification of an advertising report
+typedef enum {
+  app_adv_cache_new,     // advertiser not seen within the time window
+  app_adv_cache_changed, // advertiser seen, with a different payload
+  app_adv_cache_repeat   // same advertiser and payload within the window
+} app_adv_cache_result_t;
+
+/***************************************************************************//**
+ * Initialize the cache.
+ * @param[in] capacity Number of advertisers kept, at most
+ *   APP_ADV_CACHE_MAX_ENTRIES. The least recently seen one is evicted when
+ *   the cache is full.
+ * @param[in] window_ms Time after which an advertiser counts as new again.
+ * @return SL_STATUS_OK if successful. SL_STATUS_INVALID_PARAMETER if the
+ *   capacity is out of range.
+ ******************************************************************************/
+sl_status_t app_adv_cache_init(size_t capacity, uint32_t window_ms);
+
+/***************************************************************************//**
+ * Add an advertising report and classify it.
+ *
+ * Reports of the same advertiser within the window also update its
+ * inter-arrival time statistics.
+ *
+ * @param[in] address Advertiser address.
+ * @param[in] address_type Advertiser address type.
+ * @param[in] data Advertising payload.
+ * @param[in] len Payload length.
+ * @param[in] rssi Report RSSI.
+ * @param[in] time_us Report time, monotonic clock.
+ * @return Classification of the report.
+ ******************************************************************************/
+app_adv_cache_result_t app_adv_cache_update(const bd_addr *address,
+                                            uint8_t address_type,
+                                            const uint8_t *data,
+                                            size_t len,
+                                            int8_t rssi,
+                                            int64_t time_us);
+
+/***************************************************************************//**
+ * Print the host report rate, the number of reports with a repeated and with
+ * a changed payload and, for each cached advertiser, the number of
+ * reports, mean inter-arrival time and its jitter (standard deviation).
+ ******************************************************************************/
+void app_adv_cache_print(void);
+
+#endif // APP_ADV_CACHE_H
@@ -0,0 +1,289 @@
+/***************************************************************************//**
+ * @file
+ * @brief Additional advertising sets for scheduler stress tests, and their reception statistics on the scanner side.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "app_cust.h"
+#include "app_adv_sets.h"
+
+#define ADV_INTERVAL_UNIT_MS 0.625
+// Mean of the random 0-10 ms delay the controller adds to each interval
+#define ADV_DELAY_MEAN_MS 5.0
+#define LEGACY_MAX_DATA_LEN 31
+#define AD_TYPE_FLAGS 0x01
+#define AD_TYPE_MANUFACTURER 0xFF
+// Company ID reserved for testing
+#define MARKER_COMPANY_ID 0xFFFF
+// Handle of a set not created
+#define ADV_SET_HANDLE_NONE 0xFF
+
+typedef struct {
+  bool configured;
+  uint16_t interval;
+  uint8_t phy;
+  int16_t power;
+  size_t data_len;
+  uint8_t data[APP_ADV_SETS_MAX_DATA_LEN];
+  uint8_t handle;
+} adv_set_t;
+
+typedef struct {
+  uint32_t reports;
+  uint16_t interval;
+  int64_t first_us;
+  int64_t last_us;
+} set_reception_t;
+
+static adv_set_t sets[APP_ADV_SETS_MAX];
+static uint8_t started_count = 0;
+static set_reception_t reception[APP_ADV_SETS_MAX];
+
+// Configure an advertising set from a string.
+sl_status_t app_adv_sets_configure(const char *spec)
+{
+  char *end;
+  unsigned long index;
+  adv_set_t set = { .configured = true, .phy = sl_bt_gap_phy_1m };
+  int16_t power;
+
+  // set 0 is the advertisement mode set, configured by the other options
+  index = strtoul(spec, &end, 10);
+  if (end == spec || *end != ':' || index == 0 || index >= APP_ADV_SETS_MAX) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  set.interval = (uint16_t)strtoul(end + 1, &end, 0);
+  if (set.interval < 0x20) {
+    return SL_STATUS_INVALID_PARAMETER; // 20 ms minimum
+  }
+  if (*end == ':') {
+    set.phy = (uint8_t)strtoul(end + 1, &end, 0);
+    if (set.phy != sl_bt_gap_phy_1m && set.phy != sl_bt_gap_phy_2m
+        && set.phy != sl_bt_gap_phy_coded) {
+      return SL_STATUS_INVALID_PARAMETER;
+    }
+  }
+  set.power = INT16_MIN; // --power unless given
+  if (*end == ':') {
+    power = (int16_t)strtol(end + 1, &end, 0);
+    set.power = power;
+  }
+  if (*end == ':') {
+    if (app_cust_parse_hex(end + 1, set.data, sizeof(set.data), &set.data_len)
+        != SL_STATUS_OK) {
+      return SL_STATUS_INVALID_PARAMETER;
+    }
+    end += strlen(end);
+  }
+  if (*end != '\0'
+      || (set.phy == sl_bt_gap_phy_1m && set.data_len > LEGACY_MAX_DATA_LEN)) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  sets[index] = set;
+  return SL_STATUS_OK;
+}
+
+// Write the BLEtest marker.
+size_t app_adv_sets_marker(uint8_t index, uint16_t interval, uint8_t *data)
+{
+  data[0] = APP_ADV_SETS_MARKER_LEN - 1;
+  data[1] = AD_TYPE_MANUFACTURER;
+  data[2] = MARKER_COMPANY_ID & 0xFF;
+  data[3] = MARKER_COMPANY_ID >> 8;
+  data[4] = 'B';
+  data[5] = 'T';
+  data[6] = index;
+  data[7] = interval & 0xFF;
+  data[8] = interval >> 8;
+  return APP_ADV_SETS_MARKER_LEN;
+}
+
+static sl_status_t start_set(uint8_t index, adv_set_t *set)
+{
+  sl_status_t sc;
+  int16_t set_power;
+  uint8_t marker_data[3 + APP_ADV_SETS_MARKER_LEN];
+  const uint8_t *data = set->data;
+  size_t data_len = set->data_len;
+
+  if (data_len == 0) {
+    // flags (LE general discoverable, BR/EDR not supported) and the marker
+    marker_data[0] = 2;
+    marker_data[1] = AD_TYPE_FLAGS;
+    marker_data[2] = 0x06;
+    data_len = 3 + app_adv_sets_marker(index, set->interval, &marker_data[3]);
+    data = marker_data;
+  }
+
+  sc = sl_bt_advertiser_create_set(&set->handle);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  sc = sl_bt_advertiser_set_timing(set->handle, set->interval, set->interval, 0, 0);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  sc = sl_bt_advertiser_set_tx_power(set->handle, set->power, &set_power);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  if (set->phy == sl_bt_gap_phy_1m) {
+    sc = sl_bt_legacy_advertiser_set_data(set->handle, 0, data_len, data);
+    if (sc == SL_STATUS_OK) {
+      sc = sl_bt_legacy_advertiser_start(set->handle, sl_bt_advertiser_non_connectable);
+    }
+  } else {
+    // 2M is only allowed on the secondary channels, Coded on both
+    sc = sl_bt_extended_advertiser_set_phy(set->handle,
+                                           (set->phy == sl_bt_gap_phy_coded)
+                                           ? sl_bt_gap_phy_coded : sl_bt_gap_phy_1m,
+                                           set->phy);
+    if (sc == SL_STATUS_OK) {
+      sc = sl_bt_extended_advertiser_set_data(set->handle, data_len, data);
+    }
+    if (sc == SL_STATUS_OK) {
+      sc = sl_bt_extended_advertiser_start(set->handle,
+                                           sl_bt_extended_advertiser_non_connectable,
+                                           0);
+    }
+  }
+  if (sc == SL_STATUS_OK) {
+    printf("Advertising set %d: handle %d, interval %.1f ms, %s PHY, %.1f dBm, %zu data bytes\n",
+           index, set->handle, set->interval * ADV_INTERVAL_UNIT_MS,
+           (set->phy == sl_bt_gap_phy_1m) ? "1M"
+           : (set->phy == sl_bt_gap_phy_2m) ? "2M" : "Coded",
+           set_power / 10.0, data_len);
+  }
+  return sc;
+}
+
+// Create and start the advertising sets 1 to count-1.
+sl_status_t app_adv_sets_start(uint8_t count,
+                               uint16_t default_interval,
+                               int16_t default_power)
+{
+  sl_status_t sc;
+  adv_set_t *set;
+
+  for (uint8_t index = 1; index < count; index++) {
+    set = &sets[index];
+    if (!set->configured) {
+      set->interval = default_interval;
+      set->phy = sl_bt_gap_phy_1m;
+      set->data_len = 0;
+    }
+    if (!set->configured || set->power == INT16_MIN) {
+      set->power = default_power;
+    }
+    set->handle = ADV_SET_HANDLE_NONE;
+    sc = start_set(index, set);
+    if (sc != SL_STATUS_OK) {
+      printf("Error! Cannot start advertising set %d, result=0x%04X\n", index, sc);
+      // don't leave the failed set and the ones before it advertising
+      if (set->handle != ADV_SET_HANDLE_NONE) {
+        (void)sl_bt_advertiser_stop(set->handle);
+        (void)sl_bt_advertiser_delete_set(set->handle);
+      }
+      app_adv_sets_stop();
+      return sc;
+    }
+    started_count = index;
+  }
+  return SL_STATUS_OK;
+}
+
+// Stop the sets started by app_adv_sets_start().
+void app_adv_sets_stop(void)
+{
+  for (uint8_t index = 1; index <= started_count; index++) {
+    (void)sl_bt_advertiser_stop(sets[index].handle);
+    (void)sl_bt_advertiser_delete_set(sets[index].handle);
+  }
+  started_count = 0;
+}
+
+// Check an advertising report for the BLEtest marker.
+void app_adv_sets_on_report(const uint8_t *data, size_t len, int64_t time_us)
+{
+  size_t offset = 0;
+  const uint8_t *ad;
+  set_reception_t *set;
+
+  // walk the AD structures: length, type, payload
+  while (offset + 1 < len && data[offset] != 0) {
+    ad = &data[offset];
+    if (offset + 1 + ad[0] > len) {
+      return; // malformed
+    }
+    if (ad[0] == APP_ADV_SETS_MARKER_LEN - 1 && ad[1] == AD_TYPE_MANUFACTURER
+        && ad[2] == (MARKER_COMPANY_ID & 0xFF) && ad[3] == (MARKER_COMPANY_ID >> 8)
+        && ad[4] == 'B' && ad[5] == 'T' && ad[6] < APP_ADV_SETS_MAX) {
+      set = &reception[ad[6]];
+      if (set->reports++ == 0) {
+        set->first_us = time_us;
+      }
+      set->last_us = time_us;
+      set->interval = (uint16_t)(ad[7] | ad[8] << 8);
+      return;
+    }
+    offset += 1 + ad[0];
+  }
+}
+
+// Print the delivered advertising rate and the missed share of each set.
+void app_adv_sets_print_reception(void)
+{
+  set_reception_t *set;
+  double span_s;
+  double expected;
+  double event_ms;
+  bool header = false;
+
+  for (uint8_t index = 0; index < APP_ADV_SETS_MAX; index++) {
+    set = &reception[index];
+    if (set->reports == 0) {
+      continue;
+    }
+    if (!header) {
+      printf("BLEtest advertising sets received:\n"
+             "  set  interval[ms]  reports  rate[1/s]  expected[1/s]  missed[%%]\n");
+      header = true;
+    }
+    span_s = (set->last_us - set->first_us) / 1e6;
+    event_ms = set->interval * ADV_INTERVAL_UNIT_MS + ADV_DELAY_MEAN_MS;
+    // one report per advertising event at most, from the first to the last
+    expected = span_s * 1000.0 / event_ms + 1;
+    printf("  %3d %13.1f %8u %10.1f %14.1f %10.1f\n", index,
+           set->interval * ADV_INTERVAL_UNIT_MS, set->reports,
+           (span_s > 0) ? (set->reports - 1) / span_s : 0.0,
+           1000.0 / event_ms,
+           (expected > set->reports) ? 100.0 * (1.0 - set->reports / expected) : 0.0);
+  }
+}
@@ -0,0 +1,99 @@
+/***************************************************************************//**
+ * @file
+ * @brief Additional advertising sets for scheduler stress tests, and their reception statistics on the scanner side.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_ADV_SETS_H
+#define APP_ADV_SETS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sl_bt_api.h"
+
+// Largest number of advertising sets, including the connectable set 0.
+#define APP_ADV_SETS_MAX 8
+// Longest advertising data accepted for a set.
+#define APP_ADV_SETS_MAX_DATA_LEN 191
+// Length of the BLEtest marker added to advertising data.
+#define APP_ADV_SETS_MARKER_LEN 9
+
+/***************************************************************************//**
+ * Configure an advertising set from a string.
+ * @param[in] spec "<index>:<interval>[:<phy>[:<power>[:<data>]]]", where the
+ *   interval is in units of 0.625 ms, phy is 1 (1M), 2 (2M) or 4 (Coded),
+ *   power is in 0.1 dBm and data is the advertising data in ASCII hex.
+ *   Without data, the set advertises the BLEtest marker. Sets not
+ *   configured use the --adv_period interval, 1M PHY and --power.
+ *   The index is decimal, 1 to APP_ADV_SETS_MAX-1.
+ * @return SL_STATUS_OK if successful. SL_STATUS_INVALID_PARAMETER otherwise.
+ ******************************************************************************/
+sl_status_t app_adv_sets_configure(const char *spec);
+
+/***************************************************************************//**
+ * Write the BLEtest marker, a manufacturer specific AD structure holding the
+ * set index and interval, so a scanner can tell the sets apart.
+ * @param[in] index Set index.
+ * @param[in] interval Advertising interval, in units of 0.625 ms.
+ * @param[out] data Buffer of APP_ADV_SETS_MARKER_LEN bytes.
+ * @return Marker length.
+ ******************************************************************************/
+size_t app_adv_sets_marker(uint8_t index, uint16_t interval, uint8_t *data);
+
+/***************************************************************************//**
+ * Create and start the advertising sets 1 to count-1 as non-connectable
+ * sets. Sets on the 2M or Coded PHY use extended advertising.
+ * @param[in] count Total number of sets, including set 0.
+ * @param[in] default_interval Interval of sets not configured.
+ * @param[in] default_power TX power of sets not configured, in 0.1 dBm.
+ * @return SL_STATUS_OK if successful. Error code of the failed command
+ *   otherwise, after the sets already created were stopped and deleted.
+ ******************************************************************************/
+sl_status_t app_adv_sets_start(uint8_t count,
+                               uint16_t default_interval,
+                               int16_t default_power);
+
+/***************************************************************************//**
+ * Stop the sets started by app_adv_sets_start().
+ ******************************************************************************/
+void app_adv_sets_stop(void);
+
+/***************************************************************************//**
+ * Check an advertising report for the BLEtest marker and count it for its
+ * set.
+ * @param[in] data Advertising data.
+ * @param[in] len Data length.
+ * @param[in] time_us Report time, monotonic clock.
+ ******************************************************************************/
+void app_adv_sets_on_report(const uint8_t *data, size_t len, int64_t time_us);
+
+/***************************************************************************//**
+ * Print the delivered advertising rate and the missed share of each set
+ * seen by app_adv_sets_on_report().
+ ******************************************************************************/
+void app_adv_sets_print_reception(void);
+
+#endif // APP_ADV_SETS_H
@@ -0,0 +1,171 @@
+/***************************************************************************//**
+ * @file
+ * @brief TX power and interval step schedule for the advertisement mode.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include "app_adv_steps.h"
+
+#define ADV_INTERVAL_UNIT_MS 0.625
+// Advertising interval limits of the stack, in units of 0.625 ms
+#define ADV_INTERVAL_MIN 0x20
+#define ADV_INTERVAL_MAX 0xFFFF
+#define STEP_LINE_LEN 256
+
+static app_adv_step_t steps[APP_ADV_STEPS_MAX];
+static size_t step_count = 0;
+
+// Parse "<power>:<interval>:<dwell ms>" and return the end of the step.
+static const char *parse_step(const char *s, app_adv_step_t *step)
+{
+  char *end;
+  long power;
+  unsigned long interval, dwell_ms;
+
+  power = strtol(s, &end, 0);
+  if (end == s || *end != ':' || power < INT16_MIN || power > INT16_MAX) {
+    return NULL;
+  }
+  s = end + 1;
+  interval = strtoul(s, &end, 0);
+  if (end == s || *end != ':' || interval < ADV_INTERVAL_MIN
+      || interval > ADV_INTERVAL_MAX) {
+    return NULL;
+  }
+  s = end + 1;
+  dwell_ms = strtoul(s, &end, 0);
+  if (end == s || dwell_ms == 0 || dwell_ms > UINT32_MAX / 33) {
+    return NULL; // the dwell time must fit the soft timer in 32768 Hz ticks
+  }
+  step->power = (int16_t)power;
+  step->interval = (uint16_t)interval;
+  step->dwell_ms = (uint32_t)dwell_ms;
+  return end;
+}
+
+// Parse a comma or white space separated list of steps.
+static sl_status_t parse_list(const char *s)
+{
+  while (1) {
+    while (*s == ',' || isspace((unsigned char)*s)) {
+      s++;
+    }
+    if (*s == '\0' || *s == '#') {
+      return SL_STATUS_OK;
+    }
+    if (step_count == APP_ADV_STEPS_MAX) {
+      return SL_STATUS_INVALID_PARAMETER;
+    }
+    s = parse_step(s, &steps[step_count]);
+    if (s == NULL || (*s != '\0' && *s != ',' && *s != '#'
+                      && !isspace((unsigned char)*s))) {
+      return SL_STATUS_INVALID_PARAMETER;
+    }
+    step_count++;
+  }
+}
+
+// Parse a step schedule.
+sl_status_t app_adv_steps_parse(const char *spec)
+{
+  FILE *file;
+  char line[STEP_LINE_LEN];
+  sl_status_t sc = SL_STATUS_OK;
+
+  step_count = 0;
+  if (spec[0] != '@') {
+    sc = parse_list(spec);
+  } else {
+    file = fopen(spec + 1, "r");
+    if (file == NULL) {
+      return SL_STATUS_NOT_FOUND;
+    }
+    while (sc == SL_STATUS_OK && fgets(line, sizeof(line), file) != NULL) {
+      sc = parse_list(line);
+    }
+    fclose(file);
+  }
+  if (sc == SL_STATUS_OK && step_count == 0) {
+    sc = SL_STATUS_INVALID_PARAMETER;
+  }
+  if (sc != SL_STATUS_OK) {
+    step_count = 0;
+  }
+  return sc;
+}
+
+// Get the number of steps in the schedule.
+size_t app_adv_steps_count(void)
+{
+  return step_count;
+}
+
+// Get a step of the schedule.
+const app_adv_step_t *app_adv_steps_get(size_t index)
+{
+  if (index >= step_count) {
+    return NULL;
+  }
+  return &steps[index];
+}
+
+// Get the highest TX power of the schedule.
+int16_t app_adv_steps_max_power(void)
+{
+  int16_t power = INT16_MIN;
+
+  for (size_t i = 0; i < step_count; i++) {
+    if (steps[i].power > power) {
+      power = steps[i].power;
+    }
+  }
+  return power;
+}
+
+// Log a step that has just been applied.
+void app_adv_steps_log(size_t index, int16_t set_power, int64_t time_us,
+                       int64_t wall_us)
+{
+  const app_adv_step_t *step = &steps[index];
+  time_t wall_s = (time_t)(wall_us / 1000000);
+  struct tm utc;
+  char utc_str[32];
+
+  gmtime_r(&wall_s, &utc);
+  strftime(utc_str, sizeof(utc_str), "%Y-%m-%dT%H:%M:%S", &utc);
+  printf("STEP %zu/%zu mono_us=%lld utc=%s.%06lldZ power=%.1f set=%.1f dBm"
+         " interval=%u (%.3f ms) dwell=%lu ms\n",
+         index + 1, step_count, (long long)time_us, utc_str,
+         (long long)(wall_us % 1000000), (float)step->power / 10,
+         (float)set_power / 10, step->interval,
+         step->interval * ADV_INTERVAL_UNIT_MS, (unsigned long)step->dwell_ms);
+  fflush(stdout);
+}
@@ -0,0 +1,86 @@
+/***************************************************************************//**
+ * @file
+ * @brief TX power and interval step schedule for the advertisement mode.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_ADV_STEPS_H
+#define APP_ADV_STEPS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sl_status.h"
+
+// Largest number of steps in a schedule.
+#define APP_ADV_STEPS_MAX 256
+
+typedef struct {
+  int16_t power;      // TX power, in 0.1 dBm
+  uint16_t interval;  // Advertising interval, in units of 0.625 ms
+  uint32_t dwell_ms;  // Time spent in the step
+} app_adv_step_t;
+
+/***************************************************************************//**
+ * Parse a step schedule.
+ * @param[in] spec Comma separated list of "<power>:<interval>:<dwell ms>"
+ *   steps, or "@<file>" to read the steps from a file, one or more per line.
+ *   In a file, '#' starts a comment.
+ * @return SL_STATUS_OK if successful. SL_STATUS_INVALID_PARAMETER if a step
+ *   is malformed, SL_STATUS_NOT_FOUND if the file cannot be opened.
+ ******************************************************************************/
+sl_status_t app_adv_steps_parse(const char *spec);
+
+/***************************************************************************//**
+ * Get the number of steps in the schedule.
+ * @return Number of steps, 0 if no schedule was given.
+ ******************************************************************************/
+size_t app_adv_steps_count(void);
+
+/***************************************************************************//**
+ * Get a step of the schedule.
+ * @param[in] index Step index, 0 is the first step.
+ * @return Step, NULL if index is out of range.
+ ******************************************************************************/
+const app_adv_step_t *app_adv_steps_get(size_t index);
+
+/***************************************************************************//**
+ * Get the highest TX power of the schedule, to use as the system limit.
+ * @return TX power, in 0.1 dBm.
+ ******************************************************************************/
+int16_t app_adv_steps_max_power(void);
+
+/***************************************************************************//**
+ * Log a step that has just been applied. The line holds the monotonic and
+ * UTC timestamps so it can be matched with chamber measurements.
+ * @param[in] index Step index.
+ * @param[in] set_power TX power reported by the stack, in 0.1 dBm.
+ * @param[in] time_us Time the step was applied, monotonic clock.
+ * @param[in] wall_us Time the step was applied, wall clock.
+ ******************************************************************************/
+void app_adv_steps_log(size_t index, int16_t set_power, int64_t time_us,
+                       int64_t wall_us);
+
+#endif // APP_ADV_STEPS_H
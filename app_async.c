@@ -0,0 +1,605 @@
+/***************************************************************************//**
+ * @file
+ * @brief Pipelined BGAPI command submission.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sl_bt_ncp_host.h"
+#include "app_async.h"
+#include "app_time.h"
+#include "app_log.h"
+
+// Give up if the NCP doesn't answer a command within this time.
+#define RESPONSE_TIMEOUT_US       2000000
+// Sleep between polls of the NCP receive buffer.
+#define POLL_INTERVAL_US          50
+// Event flag in the first BGAPI header byte.
+#define BGAPI_EVENT_FLAG          0x80
+// Largest BGAPI payload, the length field has 11 bits.
+#define MAX_PAYLOAD_LEN           0x7FF
+// Initial size of the buffer of events handed back to the SDK.
+#define REPLAY_INITIAL_SIZE       4096
+// Longest uint8array parameter.
+#define MAX_ARRAY_LEN             255
+
+typedef struct {
+  uint32_t id;
+  int64_t sent_us;
+  app_async_callback_t callback;
+  void *ctx;
+} async_cmd_t;
+
+// Command parameters in BGAPI wire format, little endian.
+typedef struct {
+  uint8_t data[APP_ASYNC_MAX_PARAMS_LEN];
+  size_t len;
+  bool overflow;
+} params_t;
+
+static uint8_t depth = 1;
+// Commands written to the NCP and not yet answered, oldest at pending_head.
+static async_cmd_t pending[APP_ASYNC_MAX_DEPTH];
+static size_t pending_head = 0;
+static size_t pending_count = 0;
+static sl_status_t first_error = SL_STATUS_OK;
+
+// Transport functions installed before app_async_init().
+static tx_func next_output;
+static rx_func next_input;
+static rx_peek_func next_peek;
+
+// Frame being received, the header is kept until the payload is complete.
+// A frame is always finished, even after its command timed out, so that the
+// SDK never reads from the middle of one.
+static uint8_t rx_header[SL_BGAPI_MSG_HEADER_LEN];
+static bool rx_have_header = false;
+static int64_t rx_header_us;
+static uint8_t rx_payload[MAX_PAYLOAD_LEN];
+
+// Events read while collecting responses, handed back to the SDK.
+static uint8_t *replay = NULL;
+static size_t replay_size = 0;
+static size_t replay_len = 0;
+static size_t replay_pos = 0;
+
+static void record_error(sl_status_t sc)
+{
+  if (sc != SL_STATUS_OK && first_error == SL_STATUS_OK) {
+    first_error = sc;
+  }
+}
+
+static sl_status_t take_error(void)
+{
+  sl_status_t sc = first_error;
+
+  first_error = SL_STATUS_OK;
+  return sc;
+}
+
+static void replay_append(const uint8_t *data, size_t len)
+{
+  uint8_t *grown;
+  size_t size;
+
+  if (replay_pos == replay_len) {
+    replay_pos = 0;
+    replay_len = 0;
+  }
+  if (replay_len + len > replay_size) {
+    // events must never be lost, grow instead of dropping
+    size = (replay_size == 0) ? REPLAY_INITIAL_SIZE : replay_size;
+    while (size < replay_len + len) {
+      size *= 2;
+    }
+    grown = realloc(replay, size);
+    if (grown == NULL) {
+      printf("Error! Out of memory for pending BGAPI events\n");
+      exit(EXIT_FAILURE);
+    }
+    replay = grown;
+    replay_size = size;
+  }
+  memcpy(&replay[replay_len], data, len);
+  replay_len += len;
+}
+
+static void complete_oldest(sl_status_t result, const uint8_t *rsp, size_t rsp_len)
+{
+  async_cmd_t cmd = pending[pending_head];
+
+  pending_head = (pending_head + 1) % APP_ASYNC_MAX_DEPTH;
+  pending_count--;
+  record_error(result);
+  if (cmd.callback != NULL) {
+    cmd.callback(result, rsp, rsp_len, cmd.ctx);
+  }
+}
+
+// Read the frames already received. Events are queued for the SDK, responses
+// complete the oldest command.
+static void receive_frames(void)
+{
+  int32_t avail;
+  uint32_t header;
+  uint32_t payload_len;
+  sl_status_t result;
+
+  while (pending_count > 0 || rx_have_header) {
+    avail = next_peek();
+    if (avail < 0) {
+      break;
+    }
+    if (!rx_have_header) {
+      if ((uint32_t)avail < SL_BGAPI_MSG_HEADER_LEN
+          || next_input(SL_BGAPI_MSG_HEADER_LEN, rx_header) != SL_BGAPI_MSG_HEADER_LEN) {
+        break;
+      }
+      rx_have_header = true;
+      rx_header_us = app_time_mono_us();
+      avail -= SL_BGAPI_MSG_HEADER_LEN;
+    }
+    header = rx_header[0] | (rx_header[1] << 8) | (rx_header[2] << 16)
+             | ((uint32_t)rx_header[3] << 24);
+    payload_len = SL_BGAPI_MSG_LEN(header);
+    if (payload_len > 0) {
+      avail = next_peek();
+      if (avail < 0 || (uint32_t)avail < payload_len
+          || next_input(payload_len, rx_payload) != (int32_t)payload_len) {
+        break;
+      }
+    }
+    rx_have_header = false;
+
+    if (rx_header[0] & BGAPI_EVENT_FLAG) {
+      replay_append(rx_header, SL_BGAPI_MSG_HEADER_LEN);
+      replay_append(rx_payload, payload_len);
+      continue;
+    }
+    if (pending_count == 0) {
+      app_log_debug("Late response 0x%08x dropped\n", SL_BGAPI_MSG_ID(header));
+      continue;
+    }
+    if (SL_BGAPI_MSG_ID(header) != pending[pending_head].id || payload_len < 2) {
+      app_log_debug("Unexpected response 0x%08x while waiting for 0x%08x\n",
+                    SL_BGAPI_MSG_ID(header), pending[pending_head].id);
+      continue;
+    }
+    result = (sl_status_t)(rx_payload[0] | (rx_payload[1] << 8));
+    complete_oldest(result, &rx_payload[2], payload_len - 2);
+  }
+}
+
+// Fail the commands in flight if the oldest one has waited too long.
+static void check_timeout(void)
+{
+  int64_t now_us = app_time_mono_us();
+
+  if (rx_have_header && now_us - rx_header_us >= RESPONSE_TIMEOUT_US) {
+    // without the rest of the frame, the next header can't be found
+    printf("Error! Incomplete BGAPI frame from the NCP, header 0x%02x%02x%02x%02x\n",
+           rx_header[3], rx_header[2], rx_header[1], rx_header[0]);
+    exit(EXIT_FAILURE);
+  }
+  if (pending_count == 0
+      || now_us - pending[pending_head].sent_us < RESPONSE_TIMEOUT_US) {
+    return;
+  }
+  app_log_debug("No response to BGAPI command 0x%08x\n", pending[pending_head].id);
+  while (pending_count > 0) {
+    complete_oldest(SL_STATUS_TIMEOUT, NULL, 0);
+  }
+}
+
+// Wait until at most max_pending commands are in flight and no frame is
+// partly received.
+static void wait_pending(size_t max_pending)
+{
+  while (pending_count > max_pending || rx_have_header) {
+    receive_frames();
+    if (pending_count > max_pending || rx_have_header) {
+      check_timeout();
+      usleep(POLL_INTERVAL_US);
+    }
+  }
+}
+
+// A synchronous command from the SDK is sent after the commands in flight.
+static void async_output(uint32_t len, uint8_t *data)
+{
+  wait_pending(0);
+  next_output(len, data);
+}
+
+// The SDK reads the events handed back first, and nothing else while
+// responses are outstanding.
+static int32_t async_input(uint32_t len, uint8_t *data)
+{
+  uint32_t copied = 0;
+  int32_t ret;
+
+  if (replay_pos < replay_len) {
+    copied = (len < replay_len - replay_pos) ? len : (uint32_t)(replay_len - replay_pos);
+    memcpy(data, &replay[replay_pos], copied);
+    replay_pos += copied;
+    if (copied == len) {
+      return (int32_t)copied;
+    }
+  }
+  wait_pending(0);
+  ret = next_input(len - copied, data + copied);
+  return (ret < 0) ? ret : (int32_t)copied + ret;
+}
+
+static int32_t async_peek(void)
+{
+  int32_t avail;
+
+  receive_frames();
+  if (pending_count > 0 || rx_have_header) {
+    return (int32_t)(replay_len - replay_pos);
+  }
+  avail = next_peek();
+  if (avail < 0) {
+    return (replay_pos < replay_len) ? (int32_t)(replay_len - replay_pos) : avail;
+  }
+  return (int32_t)(replay_len - replay_pos) + avail;
+}
+
+// Keep up to depth commands in flight.
+sl_status_t app_async_init(uint8_t new_depth)
+{
+  if (new_depth < 2 || new_depth > APP_ASYNC_MAX_DEPTH) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (depth == 1) {
+    next_output = sl_bt_api_output;
+    next_input = sl_bt_api_input;
+    next_peek = sl_bt_api_input_peek;
+    sl_bt_api_initialize_nonblock(async_output, async_input, async_peek);
+  }
+  depth = new_depth;
+  return SL_STATUS_OK;
+}
+
+// Get the number of commands kept in flight.
+uint8_t app_async_depth(void)
+{
+  return depth;
+}
+
+// Send a command without waiting for its response.
+sl_status_t app_async_submit(uint32_t cmd_id,
+                             const uint8_t *params,
+                             size_t len,
+                             app_async_callback_t callback,
+                             void *ctx)
+{
+  uint8_t frame[SL_BGAPI_MSG_HEADER_LEN + APP_ASYNC_MAX_PARAMS_LEN];
+  uint32_t header = cmd_id | ((len & 0xFF) << 8) | ((len >> 8) & 0x07);
+  async_cmd_t *cmd;
+
+  if (depth == 1) {
+    return SL_STATUS_NOT_INITIALIZED;
+  }
+  if (len > APP_ASYNC_MAX_PARAMS_LEN) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  wait_pending(depth - 1);
+  frame[0] = (uint8_t)header;
+  frame[1] = (uint8_t)(header >> 8);
+  frame[2] = (uint8_t)(header >> 16);
+  frame[3] = (uint8_t)(header >> 24);
+  memcpy(&frame[SL_BGAPI_MSG_HEADER_LEN], params, len);
+
+  cmd = &pending[(pending_head + pending_count) % APP_ASYNC_MAX_DEPTH];
+  cmd->id = cmd_id;
+  cmd->callback = callback;
+  cmd->ctx = ctx;
+  cmd->sent_us = app_time_mono_us();
+  pending_count++;
+  next_output(SL_BGAPI_MSG_HEADER_LEN + (uint32_t)len, frame);
+  return SL_STATUS_OK;
+}
+
+// Complete the commands whose responses have already arrived.
+sl_status_t app_async_poll(void)
+{
+  if (depth > 1) {
+    receive_frames();
+    check_timeout();
+  }
+  return take_error();
+}
+
+// Wait until every command in flight has completed.
+sl_status_t app_async_barrier(void)
+{
+  if (depth > 1) {
+    wait_pending(0);
+  }
+  return take_error();
+}
+
+//---------------------------------
+// Commands
+
+static void put_u8(params_t *p, uint8_t value)
+{
+  if (p->len + 1 > sizeof(p->data)) {
+    p->overflow = true;
+    return;
+  }
+  p->data[p->len++] = value;
+}
+
+static void put_u16(params_t *p, uint16_t value)
+{
+  put_u8(p, (uint8_t)value);
+  put_u8(p, (uint8_t)(value >> 8));
+}
+
+static void put_u32(params_t *p, uint32_t value)
+{
+  put_u16(p, (uint16_t)value);
+  put_u16(p, (uint16_t)(value >> 16));
+}
+
+static void put_bytes(params_t *p, const uint8_t *data, size_t len)
+{
+  if (p->len + len > sizeof(p->data)) {
+    p->overflow = true;
+    return;
+  }
+  memcpy(&p->data[p->len], data, len);
+  p->len += len;
+}
+
+// uint8array: one length byte followed by the data
+static void put_array(params_t *p, const uint8_t *data, size_t len)
+{
+  if (len > MAX_ARRAY_LEN) {
+    p->overflow = true;
+    return;
+  }
+  put_u8(p, (uint8_t)len);
+  put_bytes(p, data, len);
+}
+
+static sl_status_t submit(uint32_t cmd_id,
+                          const params_t *p,
+                          app_async_callback_t callback,
+                          void *ctx)
+{
+  if (p->overflow) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  return app_async_submit(cmd_id, p->data, p->len, callback, ctx);
+}
+
+// Store a uint16 response parameter, e.g. a handle, in *ctx.
+static void store_u16(sl_status_t result, const uint8_t *rsp, size_t rsp_len, void *ctx)
+{
+  if (result == SL_STATUS_OK && rsp_len >= 2 && ctx != NULL) {
+    *(uint16_t *)ctx = (uint16_t)(rsp[0] | (rsp[1] << 8));
+  }
+}
+
+sl_status_t app_async_gattdb_add_service(uint16_t session,
+                                         uint8_t type,
+                                         uint8_t property,
+                                         size_t uuid_len,
+                                         const uint8_t *uuid,
+                                         uint16_t *service)
+{
+  params_t p = { .len = 0 };
+
+  if (depth == 1) {
+    sl_status_t sc = sl_bt_gattdb_add_service(session, type, property, uuid_len, uuid, service);
+    return sc;
+  }
+  put_u16(&p, session);
+  put_u8(&p, type);
+  put_u8(&p, property);
+  put_array(&p, uuid, uuid_len);
+  return submit(sl_bt_cmd_gattdb_add_service_id, &p, store_u16, service);
+}
+
+sl_status_t app_async_gattdb_add_uuid16_characteristic(uint16_t session,
+                                                       uint16_t service,
+                                                       uint16_t property,
+                                                       uint16_t security,
+                                                       uint8_t flag,
+                                                       sl_bt_uuid_16_t uuid,
+                                                       uint8_t value_type,
+                                                       uint16_t maxlen,
+                                                       size_t value_len,
+                                                       const uint8_t *value,
+                                                       uint16_t *characteristic)
+{
+  params_t p = { .len = 0 };
+
+  if (depth == 1) {
+    sl_status_t sc = sl_bt_gattdb_add_uuid16_characteristic(session, service, property,
+                                                            security, flag, uuid,
+                                                            value_type, maxlen,
+                                                            value_len, value,
+                                                            characteristic);
+    return sc;
+  }
+  put_u16(&p, session);
+  put_u16(&p, service);
+  put_u16(&p, property);
+  put_u16(&p, security);
+  put_u8(&p, flag);
+  put_bytes(&p, uuid.data, sizeof(uuid.data));
+  put_u8(&p, value_type);
+  put_u16(&p, maxlen);
+  put_array(&p, value, value_len);
+  return submit(sl_bt_cmd_gattdb_add_uuid16_characteristic_id, &p, store_u16, characteristic);
+}
+
+sl_status_t app_async_gattdb_add_uuid128_characteristic(uint16_t session,
+                                                        uint16_t service,
+                                                        uint16_t property,
+                                                        uint16_t security,
+                                                        uint8_t flag,
+                                                        uuid_128 uuid,
+                                                        uint8_t value_type,
+                                                        uint16_t maxlen,
+                                                        size_t value_len,
+                                                        const uint8_t *value,
+                                                        uint16_t *characteristic)
+{
+  params_t p = { .len = 0 };
+
+  if (depth == 1) {
+    sl_status_t sc = sl_bt_gattdb_add_uuid128_characteristic(session, service, property,
+                                                             security, flag, uuid,
+                                                             value_type, maxlen,
+                                                             value_len, value,
+                                                             characteristic);
+    return sc;
+  }
+  put_u16(&p, session);
+  put_u16(&p, service);
+  put_u16(&p, property);
+  put_u16(&p, security);
+  put_u8(&p, flag);
+  put_bytes(&p, uuid.data, sizeof(uuid.data));
+  put_u8(&p, value_type);
+  put_u16(&p, maxlen);
+  put_array(&p, value, value_len);
+  return submit(sl_bt_cmd_gattdb_add_uuid128_characteristic_id, &p, store_u16, characteristic);
+}
+
+sl_status_t app_async_gattdb_start_service(uint16_t session, uint16_t service)
+{
+  params_t p = { .len = 0 };
+
+  if (depth == 1) {
+    sl_status_t sc = sl_bt_gattdb_start_service(session, service);
+    return sc;
+  }
+  put_u16(&p, session);
+  put_u16(&p, service);
+  return submit(sl_bt_cmd_gattdb_start_service_id, &p, NULL, NULL);
+}
+
+sl_status_t app_async_gattdb_commit(uint16_t session)
+{
+  params_t p = { .len = 0 };
+
+  if (depth == 1) {
+    sl_status_t sc = sl_bt_gattdb_commit(session);
+    return sc;
+  }
+  put_u16(&p, session);
+  return submit(sl_bt_cmd_gattdb_commit_id, &p, NULL, NULL);
+}
+
+sl_status_t app_async_legacy_advertiser_set_data(uint8_t advertising_set,
+                                                 uint8_t type,
+                                                 size_t data_len,
+                                                 const uint8_t *data)
+{
+  params_t p = { .len = 0 };
+
+  if (depth == 1) {
+    sl_status_t sc = sl_bt_legacy_advertiser_set_data(advertising_set, type, data_len, data);
+    return sc;
+  }
+  put_u8(&p, advertising_set);
+  put_u8(&p, type);
+  put_array(&p, data, data_len);
+  return submit(sl_bt_cmd_legacy_advertiser_set_data_id, &p, NULL, NULL);
+}
+
+sl_status_t app_async_advertiser_set_timing(uint8_t advertising_set,
+                                            uint32_t interval_min,
+                                            uint32_t interval_max,
+                                            uint16_t duration,
+                                            uint8_t maxevents)
+{
+  params_t p = { .len = 0 };
+
+  if (depth == 1) {
+    sl_status_t sc = sl_bt_advertiser_set_timing(advertising_set, interval_min,
+                                                 interval_max, duration, maxevents);
+    return sc;
+  }
+  put_u8(&p, advertising_set);
+  put_u32(&p, interval_min);
+  put_u32(&p, interval_max);
+  put_u16(&p, duration);
+  put_u8(&p, maxevents);
+  return submit(sl_bt_cmd_advertiser_set_timing_id, &p, NULL, NULL);
+}
+
+sl_status_t app_async_legacy_advertiser_start(uint8_t advertising_set,
+                                              uint8_t connect)
+{
+  params_t p = { .len = 0 };
+
+  if (depth == 1) {
+    sl_status_t sc = sl_bt_legacy_advertiser_start(advertising_set, connect);
+    return sc;
+  }
+  put_u8(&p, advertising_set);
+  put_u8(&p, connect);
+  return submit(sl_bt_cmd_legacy_advertiser_start_id, &p, NULL, NULL);
+}
+
+sl_status_t app_async_gatt_write_characteristic_value_without_response(uint8_t connection,
+                                                                       uint16_t characteristic,
+                                                                       size_t value_len,
+                                                                       const uint8_t *value,
+                                                                       uint16_t *sent_len)
+{
+  params_t p = { .len = 0 };
+
+  if (depth == 1) {
+    uint16_t sync_sent_len;
+    sl_status_t sc = sl_bt_gatt_write_characteristic_value_without_response(connection,
+                                                                            characteristic,
+                                                                            value_len,
+                                                                            value,
+                                                                            &sync_sent_len);
+    if (sent_len != NULL) {
+      *sent_len = sync_sent_len;
+    }
+    return sc;
+  }
+  put_u8(&p, connection);
+  put_u16(&p, characteristic);
+  put_array(&p, value, value_len);
+  return submit(sl_bt_cmd_gatt_write_characteristic_value_without_response_id, &p,
+                store_u16, sent_len);
+}
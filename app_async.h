@@ -0,0 +1,168 @@
+/***************************************************************************//**
+ * @file
+ * @brief Pipelined BGAPI command submission.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_ASYNC_H
+#define APP_ASYNC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "sl_bt_api.h"
+
+// Largest number of commands in flight.
+#define APP_ASYNC_MAX_DEPTH 16
+// Longest command parameter block accepted.
+#define APP_ASYNC_MAX_PARAMS_LEN 512
+
+/***************************************************************************//**
+ * Completion callback of a command.
+ * @param[in] result Result code of the response, SL_STATUS_TIMEOUT if the
+ *   NCP didn't answer.
+ * @param[in] rsp Response parameters after the result code.
+ * @param[in] rsp_len Length of the response parameters.
+ * @param[in] ctx Context given at submission.
+ ******************************************************************************/
+typedef void (*app_async_callback_t)(sl_status_t result,
+                                     const uint8_t *rsp,
+                                     size_t rsp_len,
+                                     void *ctx);
+
+/***************************************************************************//**
+ * Keep up to depth commands in flight. The NCP transport functions are
+ * wrapped so that events read while collecting responses are handed back to
+ * the SDK in their original order, and a synchronous sl_bt_* command first
+ * waits for the commands in flight. Call after ncp_host_init().
+ * Without this call, the app_async_* commands run synchronously.
+ * @param[in] depth Commands in flight, 2 to APP_ASYNC_MAX_DEPTH.
+ * @return SL_STATUS_OK if successful. SL_STATUS_INVALID_PARAMETER otherwise.
+ ******************************************************************************/
+sl_status_t app_async_init(uint8_t depth);
+
+/***************************************************************************//**
+ * Get the number of commands kept in flight.
+ * @return Depth, 1 if commands run synchronously.
+ ******************************************************************************/
+uint8_t app_async_depth(void);
+
+/***************************************************************************//**
+ * Send a command without waiting for its response. Blocks only while
+ * app_async_depth() commands are already in flight.
+ * @param[in] cmd_id BGAPI command ID, e.g. sl_bt_cmd_system_hello_id.
+ * @param[in] params Command parameters in BGAPI wire format.
+ * @param[in] len Length of the parameters.
+ * @param[in] callback Called when the response arrives, may be NULL. Must not
+ *   call synchronous sl_bt_* commands.
+ * @param[in] ctx Passed to the callback.
+ * @return SL_STATUS_OK if sent. SL_STATUS_NOT_INITIALIZED without
+ *   app_async_init(), SL_STATUS_TIMEOUT if no slot was freed in time.
+ ******************************************************************************/
+sl_status_t app_async_submit(uint32_t cmd_id,
+                             const uint8_t *params,
+                             size_t len,
+                             app_async_callback_t callback,
+                             void *ctx);
+
+/***************************************************************************//**
+ * Complete the commands whose responses have already arrived, without
+ * blocking.
+ * @return First failed result since the last app_async_poll() or
+ *   app_async_barrier(), SL_STATUS_OK if none.
+ ******************************************************************************/
+sl_status_t app_async_poll(void);
+
+/***************************************************************************//**
+ * Ordering barrier: wait until every command in flight has completed.
+ * @return First failed result since the last app_async_poll() or
+ *   app_async_barrier(), SL_STATUS_OK if none.
+ ******************************************************************************/
+sl_status_t app_async_barrier(void);
+
+//---------------------------------
+// Commands. They take the parameters of the sl_bt_* command of the same
+// name. Outputs are written when the response arrives, so they are valid
+// after app_async_barrier(). Failed results are reported by
+// app_async_poll() and app_async_barrier(). Without app_async_init(), the
+// sl_bt_* command runs synchronously and its result is returned.
+
+sl_status_t app_async_gattdb_add_service(uint16_t session,
+                                         uint8_t type,
+                                         uint8_t property,
+                                         size_t uuid_len,
+                                         const uint8_t *uuid,
+                                         uint16_t *service);
+
+sl_status_t app_async_gattdb_add_uuid16_characteristic(uint16_t session,
+                                                       uint16_t service,
+                                                       uint16_t property,
+                                                       uint16_t security,
+                                                       uint8_t flag,
+                                                       sl_bt_uuid_16_t uuid,
+                                                       uint8_t value_type,
+                                                       uint16_t maxlen,
+                                                       size_t value_len,
+                                                       const uint8_t *value,
+                                                       uint16_t *characteristic);
+
+sl_status_t app_async_gattdb_add_uuid128_characteristic(uint16_t session,
+                                                        uint16_t service,
+                                                        uint16_t property,
+                                                        uint16_t security,
+                                                        uint8_t flag,
+                                                        uuid_128 uuid,
+                                                        uint8_t value_type,
+                                                        uint16_t maxlen,
+                                                        size_t value_len,
+                                                        const uint8_t *value,
+                                                        uint16_t *characteristic);
+
+sl_status_t app_async_gattdb_start_service(uint16_t session, uint16_t service);
+
+sl_status_t app_async_gattdb_commit(uint16_t session);
+
+sl_status_t app_async_legacy_advertiser_set_data(uint8_t advertising_set,
+                                                 uint8_t type,
+                                                 size_t data_len,
+                                                 const uint8_t *data);
+
+sl_status_t app_async_advertiser_set_timing(uint8_t advertising_set,
+                                            uint32_t interval_min,
+                                            uint32_t interval_max,
+                                            uint16_t duration,
+                                            uint8_t maxevents);
+
+sl_status_t app_async_legacy_advertiser_start(uint8_t advertising_set,
+                                              uint8_t connect);
+
+sl_status_t app_async_gatt_write_characteristic_value_without_response(uint8_t connection,
+                                                                       uint16_t characteristic,
+                                                                       size_t value_len,
+                                                                       const uint8_t *value,
+                                                                       uint16_t *sent_len);
+
+#endif // APP_ASYNC_H
@@ -0,0 +1,185 @@
+/***************************************************************************//**
+ * @file
+ * @brief History of the connection channel map and per-channel exclusion statistics.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "app_chmap.h"
+
+#define ALL_CHANNELS ((1ull << APP_CHMAP_CHANNELS) - 1)
+
+// Wi-Fi channels 1-13, 20 MHz wide
+#define WIFI_CHANNELS 13
+#define WIFI_HALF_WIDTH_MHZ 10
+
+static uint32_t sample_count = 0;
+static uint32_t change_count = 0;
+static uint64_t last_map;
+static int64_t first_time_us;
+static int64_t last_time_us;
+static uint32_t included_count[APP_CHMAP_CHANNELS];
+static uint32_t exclusion_count[APP_CHMAP_CHANNELS];
+static int64_t excluded_since_us[APP_CHMAP_CHANNELS];
+static int64_t excluded_total_us[APP_CHMAP_CHANNELS];
+static int64_t excluded_max_us[APP_CHMAP_CHANNELS];
+
+// Center frequency of a data channel in MHz. The advertising channel at
+// 2426 MHz splits the data channels.
+static unsigned int channel_mhz(unsigned int channel)
+{
+  return (channel <= 10) ? 2404 + 2 * channel : 2406 + 2 * channel;
+}
+
+// Add an exclusion ending at time_us to the given totals.
+static void end_exclusion(unsigned int channel, int64_t time_us,
+                          int64_t total_us[], int64_t max_us[])
+{
+  int64_t duration_us = time_us - excluded_since_us[channel];
+
+  total_us[channel] += duration_us;
+  if (duration_us > max_us[channel]) {
+    max_us[channel] = duration_us;
+  }
+}
+
+// Add a channel map reading.
+unsigned int app_chmap_add(const uint8_t *map, size_t map_size, int64_t time_us)
+{
+  uint64_t current = 0;
+  uint64_t changed;
+  uint64_t bits;
+  unsigned int channel;
+
+  for (size_t i = 0; i < map_size && i < 5; i++) {
+    current |= (uint64_t)map[i] << (8 * i);
+  }
+  current &= ALL_CHANNELS;
+
+  if (sample_count == 0) {
+    // all channels are used until the first reading tells otherwise
+    first_time_us = time_us;
+    last_map = ALL_CHANNELS;
+  }
+  changed = current ^ last_map;
+  if (changed != 0 && sample_count != 0) {
+    change_count++;
+  }
+
+  // channels dropped from the map start an exclusion
+  for (bits = changed & last_map; bits != 0; bits &= bits - 1) {
+    channel = (unsigned int)__builtin_ctzll(bits);
+    excluded_since_us[channel] = time_us;
+    exclusion_count[channel]++;
+  }
+  // channels back in the map end one
+  for (bits = changed & current; bits != 0; bits &= bits - 1) {
+    end_exclusion((unsigned int)__builtin_ctzll(bits), time_us,
+                  excluded_total_us, excluded_max_us);
+  }
+  for (bits = current; bits != 0; bits &= bits - 1) {
+    included_count[__builtin_ctzll(bits)]++;
+  }
+
+  last_map = current;
+  last_time_us = time_us;
+  sample_count++;
+  return (unsigned int)__builtin_popcountll(changed);
+}
+
+// Print the per-channel usage heatmap and exclusion statistics.
+void app_chmap_print(void)
+{
+  uint64_t bits;
+  unsigned int channel;
+  double usage;
+  double wifi_excluded[WIFI_CHANNELS] = { 0 };
+  unsigned int wifi_overlap[WIFI_CHANNELS] = { 0 };
+  int worst_wifi = -1;
+  char heat[APP_CHMAP_CHANNELS + 1];
+  int64_t total_us[APP_CHMAP_CHANNELS];
+  int64_t max_us[APP_CHMAP_CHANNELS];
+
+  if (sample_count == 0) {
+    return;
+  }
+  // close exclusions still running at the last reading on a copy, so that
+  // printing again doesn't count them twice
+  memcpy(total_us, excluded_total_us, sizeof(total_us));
+  memcpy(max_us, excluded_max_us, sizeof(max_us));
+  for (bits = ~last_map & ALL_CHANNELS; bits != 0; bits &= bits - 1) {
+    end_exclusion((unsigned int)__builtin_ctzll(bits), last_time_us, total_us, max_us);
+  }
+
+  // one character per channel: '#' always used, '+' >= 75%, '-' >= 25%,
+  // '.' less, ' ' never
+  for (channel = 0; channel < APP_CHMAP_CHANNELS; channel++) {
+    usage = (double)included_count[channel] / sample_count;
+    heat[channel] = (usage >= 1.0) ? '#' : (usage >= 0.75) ? '+'
+                    : (usage >= 0.25) ? '-' : (usage > 0) ? '.' : ' ';
+    for (int wifi = 0; wifi < WIFI_CHANNELS; wifi++) {
+      int wifi_mhz = 2412 + 5 * wifi;
+      if ((int)channel_mhz(channel) >= wifi_mhz - WIFI_HALF_WIDTH_MHZ
+          && (int)channel_mhz(channel) <= wifi_mhz + WIFI_HALF_WIDTH_MHZ) {
+        wifi_excluded[wifi] += 1.0 - usage;
+        wifi_overlap[wifi]++;
+      }
+    }
+  }
+  heat[APP_CHMAP_CHANNELS] = '\0';
+
+  printf("\nChannel map over %u reports (%.1f s), %u changes:\n",
+         sample_count, (last_time_us - first_time_us) / 1e6, change_count);
+  printf("  channel  0         1         2         3\n");
+  printf("           0123456789012345678901234567890123456\n");
+  printf("  usage   [%s]\n", heat);
+
+  if (change_count == 0 && last_map == ALL_CHANNELS) {
+    printf("All channels used for the whole connection\n");
+    return;
+  }
+  printf("  ch  MHz  used[%%]  exclusions  excluded[s]  longest[s]\n");
+  for (channel = 0; channel < APP_CHMAP_CHANNELS; channel++) {
+    if (included_count[channel] == sample_count) {
+      continue;
+    }
+    printf("  %2u %4u %8.1f %11u %12.1f %11.1f\n", channel, channel_mhz(channel),
+           100.0 * included_count[channel] / sample_count, exclusion_count[channel],
+           total_us[channel] / 1e6, max_us[channel] / 1e6);
+  }
+
+  for (int wifi = 0; wifi < WIFI_CHANNELS; wifi++) {
+    wifi_excluded[wifi] /= wifi_overlap[wifi];
+    if (worst_wifi < 0 || wifi_excluded[wifi] > wifi_excluded[worst_wifi]) {
+      worst_wifi = wifi;
+    }
+  }
+  if (wifi_excluded[worst_wifi] >= 0.25) {
+    printf("Excluded channels overlap Wi-Fi channel %d (%d MHz), %.0f%% of its BLE channels excluded on average\n",
+           worst_wifi + 1, 2412 + 5 * worst_wifi, 100.0 * wifi_excluded[worst_wifi]);
+  }
+}
@@ -0,0 +1,55 @@
+/***************************************************************************//**
+ * @file
+ * @brief History of the connection channel map and per-channel exclusion statistics.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_CHMAP_H
+#define APP_CHMAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Number of data channels in the channel map.
+#define APP_CHMAP_CHANNELS 37
+
+/***************************************************************************//**
+ * Add a channel map reading.
+ * @param[in] map Channel map as read with sl_bt_connection_read_channel_map,
+ *   bit n of the little-endian bytes set if data channel n is used.
+ * @param[in] map_size Number of bytes in map.
+ * @param[in] time_us Time of the reading, monotonic clock.
+ * @return Number of channels that changed since the previous reading.
+ ******************************************************************************/
+unsigned int app_chmap_add(const uint8_t *map, size_t map_size, int64_t time_us);
+
+/***************************************************************************//**
+ * Print the per-channel usage heatmap and exclusion statistics, with a hint
+ * of the Wi-Fi channel that overlaps the most excluded channels.
+ ******************************************************************************/
+void app_chmap_print(void);
+
+#endif // APP_CHMAP_H
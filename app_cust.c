@@ -0,0 +1,388 @@
+/***************************************************************************//**
+ * @file
+ * @brief Custom BGAPI (user message) helpers and script runner.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include "app_cust.h"
+#include "app_shutdown.h"
+#include "app_time.h"
+#include "app_log.h"
+
+// Give up if the NCP doesn't answer a user message within this time.
+#define RESPONSE_TIMEOUT_US       2000000
+// Sleep between polls of the NCP receive buffer.
+#define POLL_INTERVAL_US          50
+// Event flag in the first BGAPI header byte.
+#define BGAPI_EVENT_FLAG          0x80
+// user_message_to_target response: result (2), payload length (1), payload.
+#define RESPONSE_FIXED_LEN        3u
+#define MAX_FRAME_LEN             (SL_BGAPI_MSG_HEADER_LEN + RESPONSE_FIXED_LEN \
+                                   + APP_CUST_MAX_PAYLOAD_LEN)
+
+typedef struct {
+  unsigned long line;
+  size_t len;
+  uint8_t data[APP_CUST_MAX_PAYLOAD_LEN];
+  bool has_expect;
+  bool expect_prefix; // trailing '*' in the expected payload
+  size_t expect_len;
+  uint8_t expect[APP_CUST_MAX_PAYLOAD_LEN];
+  uint8_t expect_mask[APP_CUST_MAX_PAYLOAD_LEN]; // 0 for "??" wildcards
+  int64_t sent_us;
+} cust_cmd_t;
+
+// Messages written to the NCP and not yet answered, oldest at pending_head.
+static cust_cmd_t pending[APP_CUST_MAX_DEPTH];
+
+// Get the value of an ASCII hex digit.
+int app_cust_hex_nibble(char c)
+{
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  } else if (c >= 'A' && c <= 'F') {
+    return 10 + c - 'A';
+  } else if (c >= 'a' && c <= 'f') {
+    return 10 + c - 'a';
+  }
+  return -1;
+}
+
+// Convert an ASCII hex string to binary data.
+sl_status_t app_cust_parse_hex(const char *str,
+                               uint8_t *data,
+                               size_t max_len,
+                               size_t *data_len)
+{
+  size_t str_len = strlen(str);
+  int upper_nib;
+  int lower_nib;
+
+  if (str_len % 2 != 0) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (str_len / 2 > max_len) {
+    return SL_STATUS_WOULD_OVERFLOW;
+  }
+  for (size_t i = 0; i < str_len / 2; i++) {
+    upper_nib = app_cust_hex_nibble(str[2 * i]);
+    lower_nib = app_cust_hex_nibble(str[2 * i + 1]);
+    if (upper_nib < 0 || lower_nib < 0) {
+      return SL_STATUS_INVALID_PARAMETER;
+    }
+    data[i] = (uint8_t)((upper_nib << 4) | lower_nib);
+  }
+  *data_len = str_len / 2;
+  return SL_STATUS_OK;
+}
+
+// Parse an expected response pattern, e.g. "04??01*".
+static sl_status_t parse_pattern(const char *str, cust_cmd_t *cmd)
+{
+  size_t str_len = strlen(str);
+  int upper_nib;
+  int lower_nib;
+
+  cmd->expect_prefix = false;
+  if (str_len > 0 && str[str_len - 1] == '*') {
+    cmd->expect_prefix = true;
+    str_len--;
+  }
+  if (str_len % 2 != 0 || str_len / 2 > APP_CUST_MAX_PAYLOAD_LEN) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  for (size_t i = 0; i < str_len / 2; i++) {
+    if (str[2 * i] == '?' && str[2 * i + 1] == '?') {
+      cmd->expect[i] = 0;
+      cmd->expect_mask[i] = 0;
+      continue;
+    }
+    upper_nib = app_cust_hex_nibble(str[2 * i]);
+    lower_nib = app_cust_hex_nibble(str[2 * i + 1]);
+    if (upper_nib < 0 || lower_nib < 0) {
+      return SL_STATUS_INVALID_PARAMETER;
+    }
+    cmd->expect[i] = (uint8_t)((upper_nib << 4) | lower_nib);
+    cmd->expect_mask[i] = 0xFF;
+  }
+  cmd->expect_len = str_len / 2;
+  cmd->has_expect = true;
+  return SL_STATUS_OK;
+}
+
+static bool match_pattern(const cust_cmd_t *cmd,
+                          const uint8_t *rsp,
+                          size_t rsp_len)
+{
+  if (rsp_len < cmd->expect_len
+      || (!cmd->expect_prefix && rsp_len != cmd->expect_len)) {
+    return false;
+  }
+  for (size_t i = 0; i < cmd->expect_len; i++) {
+    if ((rsp[i] & cmd->expect_mask[i]) != cmd->expect[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Read the next command from the script. Returns false at end of file.
+static bool read_command(FILE *script,
+                         unsigned long *line_no,
+                         cust_cmd_t *cmd,
+                         char **line,
+                         size_t *line_size)
+{
+  char *payload;
+  char *expect;
+  char *extra;
+  char *comment;
+  sl_status_t sc;
+
+  for (;;) {
+    // a terminal or pipe may not send the next line for a long time
+    if (script == stdin && app_shutdown_wait_readable(STDIN_FILENO)) {
+      return false;
+    }
+    if (getline(line, line_size, script) == -1) {
+      break;
+    }
+    (*line_no)++;
+    comment = strchr(*line, '#');
+    if (comment != NULL) {
+      *comment = '\0';
+    }
+    payload = strtok(*line, " \t\r\n");
+    if (payload == NULL) {
+      continue; // empty or comment line
+    }
+    expect = strtok(NULL, " \t\r\n");
+    extra = strtok(NULL, " \t\r\n");
+
+    cmd->line = *line_no;
+    cmd->has_expect = false;
+    sc = app_cust_parse_hex(payload, cmd->data, sizeof(cmd->data), &cmd->len);
+    if (sc == SL_STATUS_OK && expect != NULL) {
+      sc = parse_pattern(expect, cmd);
+    }
+    if (sc != SL_STATUS_OK || extra != NULL) {
+      printf("Script line %lu ignored: expected \"<hex payload> [<expected hex payload>]\", "
+             "max %u bytes\n", *line_no, APP_CUST_MAX_PAYLOAD_LEN);
+      continue;
+    }
+    return true;
+  }
+  return false;
+}
+
+// Write a user_message_to_target command without waiting for the response.
+static void send_command(cust_cmd_t *cmd)
+{
+  uint8_t frame[MAX_FRAME_LEN];
+  uint32_t payload_len = 1 + cmd->len;
+  uint32_t header = sl_bt_cmd_user_message_to_target_id
+                    | ((payload_len & 0xFF) << 8)
+                    | ((payload_len >> 8) & 0x07);
+
+  frame[0] = (uint8_t)header;
+  frame[1] = (uint8_t)(header >> 8);
+  frame[2] = (uint8_t)(header >> 16);
+  frame[3] = (uint8_t)(header >> 24);
+  frame[SL_BGAPI_MSG_HEADER_LEN] = (uint8_t)cmd->len;
+  memcpy(&frame[SL_BGAPI_MSG_HEADER_LEN + 1], cmd->data, cmd->len);
+  cmd->sent_us = app_time_mono_us();
+  sl_bt_api_output(SL_BGAPI_MSG_HEADER_LEN + payload_len, frame);
+}
+
+static sl_status_t read_exact(uint8_t *buf, uint32_t len, int64_t deadline_us)
+{
+  int32_t avail;
+
+  for (;;) {
+    avail = sl_bt_api_input_peek();
+    if (avail < 0) {
+      return SL_STATUS_FAIL;
+    }
+    if ((uint32_t)avail >= len) {
+      break;
+    }
+    if (app_time_mono_us() > deadline_us) {
+      return SL_STATUS_TIMEOUT;
+    }
+    usleep(POLL_INTERVAL_US);
+  }
+  return (sl_bt_api_input(len, buf) == (int32_t)len) ? SL_STATUS_OK : SL_STATUS_FAIL;
+}
+
+// Read frames until a user_message_to_target response arrives.
+static sl_status_t receive_response(uint16_t *result,
+                                    uint8_t *rsp,
+                                    size_t *rsp_len)
+{
+  uint8_t header_buf[SL_BGAPI_MSG_HEADER_LEN];
+  uint8_t payload[MAX_FRAME_LEN];
+  uint32_t header;
+  uint32_t payload_len;
+  int64_t deadline_us = app_time_mono_us() + RESPONSE_TIMEOUT_US;
+  sl_status_t sc;
+
+  for (;;) {
+    sc = read_exact(header_buf, sizeof(header_buf), deadline_us);
+    if (sc != SL_STATUS_OK) {
+      return sc;
+    }
+    header = header_buf[0] | (header_buf[1] << 8) | (header_buf[2] << 16)
+             | ((uint32_t)header_buf[3] << 24);
+    payload_len = SL_BGAPI_MSG_LEN(header);
+    if (payload_len > sizeof(payload)) {
+      return SL_STATUS_FAIL;
+    }
+    sc = read_exact(payload, payload_len, deadline_us);
+    if (sc != SL_STATUS_OK) {
+      return sc;
+    }
+    if (header_buf[0] & BGAPI_EVENT_FLAG) {
+      app_log_debug("Event 0x%08x ignored while running custom script\n",
+                    SL_BGAPI_MSG_ID(header));
+      continue;
+    }
+    if (SL_BGAPI_MSG_ID(header) != sl_bt_rsp_user_message_to_target_id
+        || payload_len < RESPONSE_FIXED_LEN
+        || payload_len < RESPONSE_FIXED_LEN + payload[2]) {
+      app_log_debug("Unexpected response 0x%08x while running custom script\n",
+                    SL_BGAPI_MSG_ID(header));
+      return SL_STATUS_FAIL;
+    }
+    *result = (uint16_t)(payload[0] | (payload[1] << 8));
+    *rsp_len = payload[2];
+    memcpy(rsp, &payload[RESPONSE_FIXED_LEN], *rsp_len);
+    return SL_STATUS_OK;
+  }
+}
+
+// Run a script of custom user messages over the current NCP session.
+int app_cust_run_script(FILE *script, uint8_t depth)
+{
+  char *line = NULL;
+  size_t line_size = 0;
+  unsigned long line_no = 0;
+  size_t head = 0;
+  size_t count = 0;
+  bool eof = false;
+  uint32_t total = 0;
+  uint32_t failed = 0;
+  int64_t start_us = app_time_mono_us();
+  int64_t latency_us;
+  int64_t latency_sum_us = 0;
+  int64_t latency_min_us = INT64_MAX;
+  int64_t latency_max_us = 0;
+  uint16_t result;
+  uint8_t rsp[APP_CUST_MAX_PAYLOAD_LEN];
+  size_t rsp_len;
+  cust_cmd_t *cmd;
+  bool pass;
+  sl_status_t sc;
+
+  if (depth == 0 || depth > APP_CUST_MAX_DEPTH) {
+    depth = 1;
+  }
+  if (script == stdin) {
+    // no read-ahead, so that a readable stdin means a line is coming
+    setvbuf(stdin, NULL, _IONBF, 0);
+  }
+
+  while (!eof || count != 0) {
+    if (app_shutdown_requested()) {
+      // send nothing more, but collect the outstanding responses
+      eof = true;
+    }
+    // Keep the pipeline full.
+    while (!eof && count < depth) {
+      cmd = &pending[(head + count) % APP_CUST_MAX_DEPTH];
+      if (!read_command(script, &line_no, cmd, &line, &line_size)) {
+        eof = true;
+        break;
+      }
+      send_command(cmd);
+      count++;
+    }
+    if (count == 0) {
+      break;
+    }
+
+    // Collect the oldest response.
+    cmd = &pending[head];
+    sc = receive_response(&result, rsp, &rsp_len);
+    if (sc != SL_STATUS_OK) {
+      printf("No response from NCP for script line %lu, result=0x%04X\n",
+             cmd->line, sc);
+      free(line);
+      return -1;
+    }
+    latency_us = app_time_mono_us() - cmd->sent_us;
+    head = (head + 1) % APP_CUST_MAX_DEPTH;
+    count--;
+
+    pass = (result == SL_STATUS_OK)
+           && (!cmd->has_expect || match_pattern(cmd, rsp, rsp_len));
+    total++;
+    if (!pass) {
+      failed++;
+    }
+    latency_sum_us += latency_us;
+    if (latency_us < latency_min_us) {
+      latency_min_us = latency_us;
+    }
+    if (latency_us > latency_max_us) {
+      latency_max_us = latency_us;
+    }
+
+    printf("[line %lu] result=0x%04X, payload (len=%zu): ", cmd->line, result, rsp_len);
+    for (size_t i = 0; i < rsp_len; i++) {
+      printf("%02X ", rsp[i]);
+    }
+    printf("latency=%.3f ms %s\n", latency_us / 1000.0, pass ? "PASS" : "FAIL");
+  }
+  free(line);
+
+  if (app_shutdown_requested()) {
+    printf("Custom script interrupted after line %lu\n", line_no);
+  }
+  if (total != 0) {
+    printf("Custom script completed: %u commands, %u passed, %u failed, depth=%u\n",
+           total, total - failed, failed, depth);
+    printf("Latency avg=%.3f ms, min=%.3f ms, max=%.3f ms, %.1f commands/s\n",
+           latency_sum_us / 1000.0 / total, latency_min_us / 1000.0,
+           latency_max_us / 1000.0,
+           total * 1e6 / (double)(app_time_mono_us() - start_us));
+  } else {
+    printf("Custom script completed: no commands found\n");
+  }
+  return (int)failed;
+}
@@ -0,0 +1,84 @@
+/***************************************************************************//**
+ * @file
+ * @brief Custom BGAPI (user message) helpers and script runner.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_CUST_H
+#define APP_CUST_H
+
+#include <stdio.h>
+#include "sl_bt_api.h"
+
+// Largest user message payload, limited by the BGAPI uint8array length field.
+#define APP_CUST_MAX_PAYLOAD_LEN  255u
+
+// Largest number of user messages kept in flight by the script runner.
+#define APP_CUST_MAX_DEPTH        16u
+
+/***************************************************************************//**
+ * Get the value of an ASCII hex digit.
+ * @param[in] c The digit, 0-9, A-F or a-f.
+ * @return The value, or -1 if c isn't a hex digit.
+ ******************************************************************************/
+int app_cust_hex_nibble(char c);
+
+/***************************************************************************//**
+ * Convert an ASCII hex string (e.g. "a50102feed") to binary data.
+ * @param[in] str The hex string. Must have an even number of characters.
+ * @param[out] data Buffer for the binary data.
+ * @param[in] max_len Size of the data buffer.
+ * @param[out] data_len Number of bytes written to the data buffer.
+ * @return SL_STATUS_OK if successful, SL_STATUS_WOULD_OVERFLOW if the string
+ *   doesn't fit, SL_STATUS_INVALID_PARAMETER if it isn't valid hex.
+ ******************************************************************************/
+sl_status_t app_cust_parse_hex(const char *str,
+                               uint8_t *data,
+                               size_t max_len,
+                               size_t *data_len);
+
+/***************************************************************************//**
+ * Run a script of custom user messages over the current NCP session.
+ *
+ * Each non-empty script line holds the user message payload as an ASCII hex
+ * string, optionally followed by the expected response payload. In the
+ * expected payload "??" matches any byte and a trailing "*" accepts any
+ * remaining bytes. Text after '#' is ignored.
+ *
+ * Up to depth messages are written to the NCP before the first response is
+ * read. The NCP answers commands in order, so responses are matched to the
+ * oldest outstanding message.
+ *
+ * A shutdown request stops the script: no more messages are sent, the
+ * outstanding responses are collected and the summary is printed.
+ *
+ * @param[in] script Open script stream, read until end of file.
+ * @param[in] depth Number of outstanding messages, 1 to APP_CUST_MAX_DEPTH.
+ * @return Number of failed messages, or -1 if the NCP stopped responding.
+ ******************************************************************************/
+int app_cust_run_script(FILE *script, uint8_t depth);
+
+#endif // APP_CUST_H
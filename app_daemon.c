@@ -0,0 +1,263 @@
+/***************************************************************************//**
+ * @file
+ * @brief Daemon mode control socket.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "app_daemon.h"
+#include "app_log.h"
+
+static int listen_fd = -1;
+static int client_fd = -1;
+static char socket_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static const app_daemon_command_t *command_table;
+static size_t command_count;
+
+// Received bytes not yet dispatched.
+static char rx_buf[APP_DAEMON_MAX_LINE];
+static size_t rx_len;
+
+// Request state.
+static bool request_pending;
+static bool request_replied;
+
+static void set_nonblocking(int fd)
+{
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+static void close_client(void)
+{
+  if (client_fd >= 0) {
+    close(client_fd);
+    client_fd = -1;
+  }
+  rx_len = 0;
+}
+
+static void send_line(const char *line, size_t len)
+{
+  ssize_t ret;
+
+  while (len > 0 && client_fd >= 0) {
+    ret = send(client_fd, line, len, MSG_NOSIGNAL);
+    if (ret < 0) {
+      if (errno == EAGAIN || errno == EINTR) {
+        continue;
+      }
+      close_client();
+      return;
+    }
+    line += ret;
+    len -= (size_t)ret;
+  }
+}
+
+// Create the control socket and start accepting clients.
+sl_status_t app_daemon_init(const char *path,
+                            const app_daemon_command_t *commands,
+                            size_t count)
+{
+  struct sockaddr_un addr;
+
+  if (strlen(path) >= sizeof(addr.sun_path)) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0) {
+    return SL_STATUS_FAIL;
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path);
+  unlink(path);
+  if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0
+      || listen(listen_fd, 4) < 0) {
+    close(listen_fd);
+    listen_fd = -1;
+    return SL_STATUS_FAIL;
+  }
+  set_nonblocking(listen_fd);
+  strcpy(socket_path, path);
+  command_table = commands;
+  command_count = count;
+  return SL_STATUS_OK;
+}
+
+// Answer the current request.
+void app_daemon_reply(sl_status_t sc, const char *fmt, ...)
+{
+  char line[APP_DAEMON_MAX_LINE];
+  int len;
+  va_list args;
+
+  if (!request_pending || request_replied) {
+    return;
+  }
+  request_replied = true;
+  request_pending = false;
+
+  if (sc == SL_STATUS_OK) {
+    len = snprintf(line, sizeof(line), "OK");
+  } else {
+    len = snprintf(line, sizeof(line), "ERR 0x%04X", (unsigned int)sc);
+  }
+  if (fmt != NULL) {
+    line[len++] = ' ';
+    va_start(args, fmt);
+    len += vsnprintf(&line[len], sizeof(line) - len - 1, fmt, args);
+    va_end(args);
+    if (len > (int)sizeof(line) - 2) {
+      len = sizeof(line) - 2;
+    }
+  }
+  line[len++] = '\n';
+  send_line(line, len);
+}
+
+bool app_daemon_busy(void)
+{
+  return request_pending;
+}
+
+static void dispatch(char *line)
+{
+  char *argv[APP_DAEMON_MAX_ARGS];
+  int argc = 0;
+  char *token;
+  sl_status_t sc;
+
+  for (token = strtok(line, " \t\r"); token != NULL && argc < (int)APP_DAEMON_MAX_ARGS;
+       token = strtok(NULL, " \t\r")) {
+    argv[argc++] = token;
+  }
+  if (argc == 0) {
+    return; // empty line
+  }
+
+  request_pending = true;
+  request_replied = false;
+
+  if (strcmp(argv[0], "help") == 0) {
+    for (size_t i = 0; i < command_count; i++) {
+      char usage[APP_DAEMON_MAX_LINE];
+      int len = snprintf(usage, sizeof(usage), "# %s %s\n",
+                         command_table[i].name, command_table[i].usage);
+      send_line(usage, len);
+    }
+    app_daemon_reply(SL_STATUS_OK, NULL);
+    return;
+  }
+
+  for (size_t i = 0; i < command_count; i++) {
+    if (strcmp(argv[0], command_table[i].name) == 0) {
+      app_log_debug("daemon request: %s\n", argv[0]);
+      sc = command_table[i].handler(argc, argv);
+      if (sc != SL_STATUS_IN_PROGRESS) {
+        app_daemon_reply(sc, NULL);
+      }
+      return;
+    }
+  }
+  app_daemon_reply(SL_STATUS_NOT_FOUND, "unknown command %s", argv[0]);
+}
+
+// Accept clients and dispatch pending requests.
+void app_daemon_process(void)
+{
+  char *newline;
+  size_t line_len;
+  ssize_t ret;
+  int fd;
+
+  if (listen_fd < 0) {
+    return;
+  }
+
+  if (client_fd < 0) {
+    fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) {
+      return;
+    }
+    set_nonblocking(fd);
+    client_fd = fd;
+    app_log_debug("daemon client connected\n");
+  }
+
+  if (rx_len < sizeof(rx_buf)) {
+    ret = recv(client_fd, &rx_buf[rx_len], sizeof(rx_buf) - rx_len, 0);
+    if (ret == 0 || (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK
+                     && errno != EINTR)) {
+      // Client gone. A pending request still completes, its reply is dropped.
+      app_log_debug("daemon client disconnected\n");
+      close_client();
+      return;
+    }
+    if (ret > 0) {
+      rx_len += (size_t)ret;
+    }
+  }
+
+  // Serve one request at a time, in order.
+  while (!request_pending && client_fd >= 0) {
+    newline = memchr(rx_buf, '\n', rx_len);
+    if (newline == NULL) {
+      if (rx_len == sizeof(rx_buf)) {
+        rx_len = 0;
+        request_pending = true;
+        request_replied = false;
+        app_daemon_reply(SL_STATUS_WOULD_OVERFLOW, "request too long");
+      }
+      return;
+    }
+    *newline = '\0';
+    line_len = (size_t)(newline - rx_buf) + 1;
+    {
+      char line[APP_DAEMON_MAX_LINE];
+      memcpy(line, rx_buf, line_len);
+      memmove(rx_buf, &rx_buf[line_len], rx_len - line_len);
+      rx_len -= line_len;
+      dispatch(line);
+    }
+  }
+}
+
+// Close the control socket and remove the socket file.
+void app_daemon_deinit(void)
+{
+  close_client();
+  if (listen_fd >= 0) {
+    close(listen_fd);
+    listen_fd = -1;
+    unlink(socket_path);
+  }
+}
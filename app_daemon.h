@@ -0,0 +1,94 @@
+/***************************************************************************//**
+ * @file
+ * @brief Daemon mode control socket.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_DAEMON_H
+#define APP_DAEMON_H
+
+#include <stdbool.h>
+#include "sl_bt_api.h"
+
+// Longest request line accepted on the control socket.
+#define APP_DAEMON_MAX_LINE   600u
+// Most arguments in a request, including the command name.
+#define APP_DAEMON_MAX_ARGS   8u
+
+/***************************************************************************//**
+ * Handles one request. argv[0] is the command name.
+ * @return SL_STATUS_IN_PROGRESS if the reply is sent later with
+ *   app_daemon_reply(). Otherwise the request is answered with the returned
+ *   status, unless the handler has already replied.
+ ******************************************************************************/
+typedef sl_status_t (*app_daemon_handler_t)(int argc, char *argv[]);
+
+typedef struct {
+  const char *name;
+  const char *usage;
+  app_daemon_handler_t handler;
+} app_daemon_command_t;
+
+/***************************************************************************//**
+ * Create the Unix domain control socket and start accepting clients.
+ *
+ * Requests are single text lines, "<command> [arguments...]". Each request
+ * is answered with a single line, "OK [key=value...]" or
+ * "ERR 0x<status> [message]". Requests are served one at a time, in order.
+ *
+ * @param[in] path Socket path. An existing socket file is replaced.
+ * @param[in] commands Command table, must stay valid while the daemon runs.
+ * @param[in] count Number of entries in the command table.
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ ******************************************************************************/
+sl_status_t app_daemon_init(const char *path,
+                            const app_daemon_command_t *commands,
+                            size_t count);
+
+/***************************************************************************//**
+ * Accept clients and dispatch pending requests. Never blocks.
+ ******************************************************************************/
+void app_daemon_process(void);
+
+/***************************************************************************//**
+ * Answer the current request.
+ * @param[in] sc Status of the request.
+ * @param[in] fmt Optional printf style format for the rest of the reply, or
+ *   NULL.
+ ******************************************************************************/
+void app_daemon_reply(sl_status_t sc, const char *fmt, ...);
+
+/***************************************************************************//**
+ * Check if a request is waiting for its reply.
+ ******************************************************************************/
+bool app_daemon_busy(void);
+
+/***************************************************************************//**
+ * Close the control socket and remove the socket file.
+ ******************************************************************************/
+void app_daemon_deinit(void);
+
+#endif // APP_DAEMON_H
@@ -0,0 +1,124 @@
+/***************************************************************************//**
+ * @file
+ * @brief Expected DTM packet counts and packet error rate.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <math.h>
+#include <stddef.h>
+#include "sl_bt_api.h"
+#include "app_dtm_model.h"
+
+// Minimum time from the end of a packet to the next one
+#define DTM_MIN_GAP_US 249u
+// Packet intervals are multiples of this
+#define DTM_INTERVAL_UNIT_US 625u
+
+// Packet time = fixed_us + us_per_byte * payload length
+typedef struct {
+  uint8_t phy;
+  const char *name;
+  uint16_t fixed_us;
+  uint8_t us_per_byte;
+} phy_timing_t;
+
+static const phy_timing_t phy_timing[] = {
+  // 1 byte preamble, 4 access address, 2 header, 3 CRC at 8 us per byte
+  { sl_bt_test_phy_1m,   "1M",       (1 + 4 + 2 + 3) * 8, 8 },
+  // 2 byte preamble at 4 us per byte
+  { sl_bt_test_phy_2m,   "2M",       (2 + 4 + 2 + 3) * 4, 4 },
+  // 80 us preamble, 256 access address, 16 CI, 24 TERM1, then header and CRC
+  // at 64 us per byte and 3 bit TERM2 at 8 us per bit
+  { sl_bt_test_phy_125k, "Coded S8", 80 + 256 + 16 + 24 + (2 + 3) * 64 + 24, 64 },
+  // FEC block 2 at 2 us per bit, 16 us per byte, 3 bit TERM2 at 2 us per bit
+  { sl_bt_test_phy_500k, "Coded S2", 80 + 256 + 16 + 24 + (2 + 3) * 16 + 6, 16 },
+};
+
+static const phy_timing_t *find_phy(uint8_t phy)
+{
+  for (size_t i = 0; i < sizeof(phy_timing) / sizeof(phy_timing[0]); i++) {
+    if (phy_timing[i].phy == phy) {
+      return &phy_timing[i];
+    }
+  }
+  return NULL;
+}
+
+// Get the air time of a test packet.
+uint32_t app_dtm_model_packet_us(uint8_t phy, uint8_t len)
+{
+  const phy_timing_t *timing = find_phy(phy);
+
+  if (timing == NULL) {
+    return 0;
+  }
+  return timing->fixed_us + (uint32_t)timing->us_per_byte * len;
+}
+
+// Get the packet interval.
+uint32_t app_dtm_model_interval_us(uint8_t phy, uint8_t len)
+{
+  uint32_t packet_us = app_dtm_model_packet_us(phy, len);
+
+  if (packet_us == 0) {
+    return 0;
+  }
+  return (packet_us + DTM_MIN_GAP_US + DTM_INTERVAL_UNIT_US - 1)
+         / DTM_INTERVAL_UNIT_US * DTM_INTERVAL_UNIT_US;
+}
+
+// Get the packets sent in a given time.
+uint32_t app_dtm_model_expected(uint8_t phy, uint8_t len, int64_t duration_us)
+{
+  uint32_t interval_us = app_dtm_model_interval_us(phy, len);
+
+  if (interval_us == 0 || duration_us <= 0) {
+    return 0;
+  }
+  return (uint32_t)(duration_us / interval_us);
+}
+
+// Get the name of a test PHY.
+const char *app_dtm_model_phy_name(uint8_t phy)
+{
+  const phy_timing_t *timing = find_phy(phy);
+
+  return timing != NULL ? timing->name : "unknown";
+}
+
+// Get the Wilson score interval of an error rate.
+void app_dtm_model_wilson(uint32_t errors, uint32_t trials, double z,
+                          double *low, double *high)
+{
+  double n = trials;
+  double p = (double)errors / n;
+  double z2 = z * z;
+  double center = (p + z2 / (2 * n)) / (1 + z2 / n);
+  double half = z * sqrt(p * (1 - p) / n + z2 / (4 * n * n)) / (1 + z2 / n);
+
+  *low = center - half > 0 ? center - half : 0;
+  *high = center + half < 1 ? center + half : 1;
+}
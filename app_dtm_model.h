@@ -0,0 +1,84 @@
+/***************************************************************************//**
+ * @file
+ * @brief Expected DTM packet counts and packet error rate.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_DTM_MODEL_H
+#define APP_DTM_MODEL_H
+
+#include <stdint.h>
+
+// Two-sided 95% confidence of the PER interval
+#define APP_DTM_MODEL_Z95 1.96
+
+/***************************************************************************//**
+ * Get the air time of a DTM test packet: preamble, access address, PDU
+ * header, payload and CRC, and for the coded PHYs the coding indicator and
+ * terminators.
+ * @param[in] phy Test PHY, sl_bt_test_phy_1m, _2m, _125k or _500k.
+ * @param[in] len Payload length in bytes.
+ * @return Packet time in microseconds, 0 for an unknown PHY.
+ ******************************************************************************/
+uint32_t app_dtm_model_packet_us(uint8_t phy, uint8_t len);
+
+/***************************************************************************//**
+ * Get the DTM packet interval, the packet time plus at least 249 us rounded
+ * up to a multiple of 625 us (Core specification, Vol 6, Part F, 4.1.6).
+ * @param[in] phy Test PHY.
+ * @param[in] len Payload length in bytes.
+ * @return Interval in microseconds, 0 for an unknown PHY.
+ ******************************************************************************/
+uint32_t app_dtm_model_interval_us(uint8_t phy, uint8_t len);
+
+/***************************************************************************//**
+ * Get the number of packets a DTM transmitter sends in a given time.
+ * @param[in] phy Test PHY.
+ * @param[in] len Payload length in bytes.
+ * @param[in] duration_us Transmit time.
+ * @return Expected packet count, 0 for an unknown PHY.
+ ******************************************************************************/
+uint32_t app_dtm_model_expected(uint8_t phy, uint8_t len, int64_t duration_us);
+
+/***************************************************************************//**
+ * Get the name of a test PHY.
+ * @param[in] phy Test PHY.
+ * @return Name, e.g. "1M" or "Coded S8".
+ ******************************************************************************/
+const char *app_dtm_model_phy_name(uint8_t phy);
+
+/***************************************************************************//**
+ * Get the Wilson score interval of an error rate.
+ * @param[in] errors Lost packets.
+ * @param[in] trials Expected packets, at least 1.
+ * @param[in] z Standard score of the confidence, e.g. APP_DTM_MODEL_Z95.
+ * @param[out] low Lower bound of the error rate, 0-1.
+ * @param[out] high Upper bound of the error rate, 0-1.
+ ******************************************************************************/
+void app_dtm_model_wilson(uint32_t errors, uint32_t trials, double z,
+                          double *low, double *high);
+
+#endif // APP_DTM_MODEL_H
@@ -0,0 +1,145 @@
+/***************************************************************************//**
+ * @file
+ * @brief Batched BGAPI event dispatch.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "sl_bt_api.h"
+#include "sl_bt_ncp_host.h"
+#include "app_events.h"
+#include "app_metrics.h"
+#include "app_time.h"
+
+typedef struct {
+  uint64_t batches;
+  uint64_t events;
+  uint64_t full_batches;     // batches that hit the budget
+  uint16_t max_batch;
+  int32_t max_backlog;       // bytes waiting in the receive buffer
+  int64_t latency_sum_us;
+  int64_t max_latency_us;
+} events_stats_t;
+
+static sl_bt_msg_t *pool = NULL;
+static uint16_t pool_size = 0;
+static events_stats_t stats;
+
+// Enable batched dispatch and allocate the event pool.
+sl_status_t app_events_init(uint16_t budget)
+{
+  if (budget == 0 || budget > APP_EVENTS_MAX_BATCH) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  pool = calloc(budget, sizeof(*pool));
+  if (pool == NULL) {
+    return SL_STATUS_NO_MORE_RESOURCE;
+  }
+  pool_size = budget;
+  return SL_STATUS_OK;
+}
+
+// Check if batched dispatch is enabled.
+bool app_events_enabled(void)
+{
+  return pool != NULL;
+}
+
+// Dispatch the pending events, up to the budget.
+uint16_t app_events_process(void)
+{
+  uint16_t count = 0;
+  int32_t backlog;
+  int64_t read_us;
+  int64_t latency_us;
+
+  if (pool == NULL) {
+    return 0;
+  }
+  backlog = sl_bt_api_input_peek();
+  while (count < pool_size && sl_bt_pop_event(&pool[count]) == SL_STATUS_OK) {
+    count++;
+  }
+  if (count == 0) {
+    return 0;
+  }
+  read_us = app_time_mono_us();
+  for (uint16_t i = 0; i < count; i++) {
+    // time spent waiting for the handlers of the earlier events in the batch
+    latency_us = app_time_mono_us() - read_us;
+    stats.latency_sum_us += latency_us;
+    if (latency_us > stats.max_latency_us) {
+      stats.max_latency_us = latency_us;
+    }
+    sl_bt_on_event(&pool[i]);
+  }
+
+  stats.batches++;
+  stats.events += count;
+  if (count == pool_size) {
+    stats.full_batches++;
+  }
+  if (count > stats.max_batch) {
+    stats.max_batch = count;
+  }
+  if (backlog > stats.max_backlog) {
+    stats.max_backlog = backlog;
+  }
+  return count;
+}
+
+// Set the batch metrics.
+void app_events_publish(void)
+{
+  if (pool == NULL) {
+    return;
+  }
+  app_metrics_set_counter("event_batches", stats.batches);
+  app_metrics_set_counter("event_batch_events", stats.events);
+  app_metrics_set_counter("event_batches_full", stats.full_batches);
+  app_metrics_set_gauge("event_batch_max", stats.max_batch);
+  app_metrics_set_gauge("event_rx_backlog_max_bytes", stats.max_backlog);
+  app_metrics_set_gauge("event_dispatch_latency_mean_us",
+                        stats.events ? (double)stats.latency_sum_us / stats.events : 0);
+  app_metrics_set_gauge("event_dispatch_latency_max_us", stats.max_latency_us);
+}
+
+// Print the batch statistics.
+void app_events_print(void)
+{
+  if (pool == NULL || stats.batches == 0) {
+    return;
+  }
+  printf("Event batches: %llu batches, %llu events, mean %.1f, max %u of budget %u, "
+         "%llu batches at the budget\n",
+         (unsigned long long)stats.batches, (unsigned long long)stats.events,
+         (double)stats.events / stats.batches, stats.max_batch, pool_size,
+         (unsigned long long)stats.full_batches);
+  printf("  max receive backlog %d bytes, dispatch latency mean %.1f us, max %lld us\n",
+         stats.max_backlog, (double)stats.latency_sum_us / stats.events,
+         (long long)stats.max_latency_us);
+}
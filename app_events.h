@@ -0,0 +1,72 @@
+/***************************************************************************//**
+ * @file
+ * @brief Batched BGAPI event dispatch.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_EVENTS_H
+#define APP_EVENTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sl_status.h"
+
+// Largest number of events dispatched in one batch.
+#define APP_EVENTS_MAX_BATCH 1024
+
+/***************************************************************************//**
+ * Enable batched dispatch and allocate the event pool.
+ * @param[in] budget Largest number of events dispatched per batch,
+ *   1 to APP_EVENTS_MAX_BATCH.
+ * @return SL_STATUS_OK if successful. SL_STATUS_INVALID_PARAMETER or
+ *   SL_STATUS_NO_MORE_RESOURCE otherwise.
+ ******************************************************************************/
+sl_status_t app_events_init(uint16_t budget);
+
+/***************************************************************************//**
+ * Check if batched dispatch is enabled.
+ * @return true if app_events_init() succeeded.
+ ******************************************************************************/
+bool app_events_enabled(void);
+
+/***************************************************************************//**
+ * Read the pending events into the pool, up to the budget, then dispatch
+ * them to sl_bt_on_event() in order. Does nothing unless enabled.
+ * @return Number of events dispatched.
+ ******************************************************************************/
+uint16_t app_events_process(void);
+
+/***************************************************************************//**
+ * Set the batch size, receive backlog and dispatch latency metrics.
+ ******************************************************************************/
+void app_events_publish(void);
+
+/***************************************************************************//**
+ * Print the batch and dispatch latency statistics.
+ ******************************************************************************/
+void app_events_print(void);
+
+#endif // APP_EVENTS_H
@@ -0,0 +1,195 @@
+/***************************************************************************//**
+ * @file
+ * @brief GATT request/response round trip time.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "app_gatt_ping.h"
+#include "app_metrics.h"
+#include "app_stats.h"
+
+#define INTERVAL_UNIT_US 1250
+#define BAR_WIDTH 40
+
+typedef struct {
+  double rtt_ms[APP_GATT_PING_MAX];
+  double rtt_intervals[APP_GATT_PING_MAX];
+  uint32_t count;    // round trips kept
+  uint32_t dropped;  // round trips beyond APP_GATT_PING_MAX
+  uint32_t errors;
+  uint16_t last_error;
+  uint32_t buckets[APP_GATT_PING_BUCKETS];
+} op_stats_t;
+
+static const char *op_names[APP_GATT_PING_OPS] = { "read", "write" };
+static op_stats_t stats[APP_GATT_PING_OPS];
+static uint16_t conn_interval = 0;
+static uint16_t conn_latency = 0;
+static uint32_t param_changes = 0; // parameter updates after the first round trip
+
+// Get the percentiles of a series, sorting it in place.
+static void percentiles(double *values, uint32_t count, double *p50, double *p90,
+                        double *p99)
+{
+  app_stats_sort(values, count);
+  *p50 = app_stats_percentile(values, count, 50);
+  *p90 = app_stats_percentile(values, count, 90);
+  *p99 = app_stats_percentile(values, count, 99);
+}
+
+// Set the connection parameters.
+void app_gatt_ping_set_params(uint16_t interval, uint16_t latency)
+{
+  if (interval == conn_interval && latency == conn_latency) {
+    return;
+  }
+  if (app_gatt_ping_count() != 0) {
+    param_changes++;
+  }
+  conn_interval = interval;
+  conn_latency = latency;
+}
+
+// Add a round trip.
+void app_gatt_ping_add(app_gatt_ping_op_t op, int64_t rtt_us)
+{
+  op_stats_t *s = &stats[op];
+  double intervals = 0;
+  uint32_t bucket;
+
+  if (conn_interval != 0) {
+    intervals = (double)rtt_us / (conn_interval * INTERVAL_UNIT_US);
+  }
+  bucket = (uint32_t)intervals;
+  s->buckets[bucket < APP_GATT_PING_BUCKETS ? bucket : APP_GATT_PING_BUCKETS - 1]++;
+  if (s->count == APP_GATT_PING_MAX) {
+    s->dropped++;
+    return;
+  }
+  s->rtt_ms[s->count] = rtt_us / 1000.0;
+  s->rtt_intervals[s->count] = intervals;
+  s->count++;
+}
+
+// Count a failed round trip.
+void app_gatt_ping_add_error(app_gatt_ping_op_t op, uint16_t result)
+{
+  stats[op].errors++;
+  stats[op].last_error = result;
+}
+
+// Get the number of round trips.
+uint32_t app_gatt_ping_count(void)
+{
+  uint32_t count = 0;
+
+  for (int op = 0; op < APP_GATT_PING_OPS; op++) {
+    count += stats[op].count + stats[op].dropped + stats[op].errors;
+  }
+  return count;
+}
+
+// Set the metrics.
+void app_gatt_ping_publish(void)
+{
+  double p50, p90, p99;
+  char name[40];
+
+  for (int op = 0; op < APP_GATT_PING_OPS; op++) {
+    if (stats[op].count == 0) {
+      continue;
+    }
+    percentiles(stats[op].rtt_ms, stats[op].count, &p50, &p90, &p99);
+    snprintf(name, sizeof(name), "gatt_ping_%s_p50_ms", op_names[op]);
+    app_metrics_set_gauge(name, p50);
+    snprintf(name, sizeof(name), "gatt_ping_%s_p99_ms", op_names[op]);
+    app_metrics_set_gauge(name, p99);
+    snprintf(name, sizeof(name), "gatt_ping_%s_errors", op_names[op]);
+    app_metrics_set_counter(name, stats[op].errors);
+  }
+  app_metrics_set_gauge("gatt_ping_conn_interval_ms", conn_interval * INTERVAL_UNIT_US / 1000.0);
+  app_metrics_set_gauge("gatt_ping_conn_latency", conn_latency);
+}
+
+// Print the percentiles and the histogram.
+void app_gatt_ping_print(void)
+{
+  double p50, p90, p99;
+  uint32_t total = 0;
+  uint32_t sum;
+  op_stats_t *s;
+
+  if (app_gatt_ping_count() == 0) {
+    return;
+  }
+  printf("GATT ping over %u round trips, connection interval %.2f ms, peripheral latency %u\n",
+         app_gatt_ping_count(), conn_interval * INTERVAL_UNIT_US / 1000.0, conn_latency);
+  if (param_changes != 0) {
+    printf("  connection parameters changed %u times during the test, last values shown\n",
+           param_changes);
+  }
+  printf("  op        n      min      p50      p90      p99      max  [ms]\n");
+  for (int op = 0; op < APP_GATT_PING_OPS; op++) {
+    s = &stats[op];
+    if (s->errors != 0) {
+      printf("  %-5s  %u errors, last result 0x%04x\n", op_names[op], s->errors, s->last_error);
+    }
+    if (s->count == 0) {
+      continue;
+    }
+    total += s->count + s->dropped;
+    percentiles(s->rtt_ms, s->count, &p50, &p90, &p99);
+    printf("  %-5s %5u %8.2f %8.2f %8.2f %8.2f %8.2f\n", op_names[op], s->count,
+           s->rtt_ms[0], p50, p90, p99, s->rtt_ms[s->count - 1]);
+    percentiles(s->rtt_intervals, s->count, &p50, &p90, &p99);
+    printf("  %-5s %5s %8.2f %8.2f %8.2f %8.2f %8.2f  [intervals]\n", "", "",
+           s->rtt_intervals[0], p50, p90, p99, s->rtt_intervals[s->count - 1]);
+  }
+  if (total == 0 || conn_interval == 0) {
+    return;
+  }
+  // a request waits for the next event the peripheral listens in, and the
+  // response for the event after, plus the NCP link both ways
+  printf("Round trip time in connection intervals (requests and responses need 1-%u intervals over the air):\n",
+         conn_latency + 2);
+  printf("  intervals   read  write\n");
+  for (int i = 0; i < APP_GATT_PING_BUCKETS; i++) {
+    sum = stats[APP_GATT_PING_READ].buckets[i] + stats[APP_GATT_PING_WRITE].buckets[i];
+    if (i < APP_GATT_PING_BUCKETS - 1) {
+      printf("  %4d-%-4d", i, i + 1);
+    } else {
+      printf("  %4d+    ", i);
+    }
+    printf(" %6u %6u%s", stats[APP_GATT_PING_READ].buckets[i],
+           stats[APP_GATT_PING_WRITE].buckets[i], sum != 0 ? "  " : "");
+    for (uint32_t j = 0; j < (sum * BAR_WIDTH + total - 1) / total; j++) {
+      printf("#");
+    }
+    printf("\n");
+  }
+}
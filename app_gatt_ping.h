@@ -0,0 +1,84 @@
+/***************************************************************************//**
+ * @file
+ * @brief GATT request/response round trip time.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_GATT_PING_H
+#define APP_GATT_PING_H
+
+#include <stdint.h>
+
+// Most round trips kept per operation.
+#define APP_GATT_PING_MAX 10000
+// Histogram buckets, one connection interval wide, the last one open ended.
+#define APP_GATT_PING_BUCKETS 12
+
+typedef enum {
+  APP_GATT_PING_READ,
+  APP_GATT_PING_WRITE,
+  APP_GATT_PING_OPS
+} app_gatt_ping_op_t;
+
+/***************************************************************************//**
+ * Set the connection parameters the next round trips are measured with.
+ * @param[in] interval Connection interval, in 1.25 ms units.
+ * @param[in] latency Peripheral latency, in connection events.
+ ******************************************************************************/
+void app_gatt_ping_set_params(uint16_t interval, uint16_t latency);
+
+/***************************************************************************//**
+ * Add a round trip.
+ * @param[in] op Operation.
+ * @param[in] rtt_us Time from the command to the procedure completed event.
+ ******************************************************************************/
+void app_gatt_ping_add(app_gatt_ping_op_t op, int64_t rtt_us);
+
+/***************************************************************************//**
+ * Count a round trip that completed with an error.
+ * @param[in] op Operation.
+ * @param[in] result Procedure result.
+ ******************************************************************************/
+void app_gatt_ping_add_error(app_gatt_ping_op_t op, uint16_t result);
+
+/***************************************************************************//**
+ * Get the number of round trips added, including errors.
+ * @return Number of round trips.
+ ******************************************************************************/
+uint32_t app_gatt_ping_count(void);
+
+/***************************************************************************//**
+ * Set the round trip percentiles as metrics.
+ ******************************************************************************/
+void app_gatt_ping_publish(void);
+
+/***************************************************************************//**
+ * Print the round trip percentiles of each operation and a histogram in
+ * connection intervals.
+ ******************************************************************************/
+void app_gatt_ping_print(void);
+
+#endif // APP_GATT_PING_H
@@ -27,7 +27,12 @@
  * 3. This notice may not be removed or altered from any source distribution.
  *
  ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "app_gattdb.h"
+#include "app_async.h"
+#include "app_cust.h"
 
 #define GATTDB_SECURITY_NONE            0x00
 #define GATTDB_FLAG_NONE                0x00
@@ -182,12 +187,12 @@ characteristic_t characteristics[CHARACTERISTICS_COUNT] = {
 // Handles adding a new service.
 sl_status_t app_gattdb_add_service(uint16_t session, service_t *service)
 {
-  return sl_bt_gattdb_add_service(session,
-                                  service->type,
-                                  service->property,
-                                  service->uuid_len,
-                                  service->uuid,
-                                  &service->handle);
+  return app_async_gattdb_add_service(session,
+                                      service->type,
+                                      service->property,
+                                      service->uuid_len,
+                                      service->uuid,
+                                      &service->handle);
 }
 
 // Handles adding a new characteristic to a service.
@@ -197,32 +202,591 @@ sl_status_t app_gattdb_add_characteristic(uint16_t session,
   if (characteristic->uuid_len == UUID_16_LEN) {
     sl_bt_uuid_16_t uuid;
     memcpy(uuid.data, characteristic->uuid, characteristic->uuid_len);
-    return sl_bt_gattdb_add_uuid16_characteristic(session,
-                                                  characteristic->service->handle,
-                                                  characteristic->property,
-                                                  characteristic->security,
-                                                  characteristic->flag,
-                                                  uuid,
-                                                  characteristic->value_type,
-                                                  characteristic->maxlen,
-                                                  characteristic->value_len,
-                                                  characteristic->value,
-                                                  &characteristic->handle);
+    return app_async_gattdb_add_uuid16_characteristic(session,
+                                                      characteristic->service->handle,
+                                                      characteristic->property,
+                                                      characteristic->security,
+                                                      characteristic->flag,
+                                                      uuid,
+                                                      characteristic->value_type,
+                                                      characteristic->maxlen,
+                                                      characteristic->value_len,
+                                                      characteristic->value,
+                                                      &characteristic->handle);
   } else if (characteristic->uuid_len == UUID_128_LEN) {
     uuid_128 uuid;
     memcpy(uuid.data, characteristic->uuid, characteristic->uuid_len);
-    return sl_bt_gattdb_add_uuid128_characteristic(session,
-                                                   characteristic->service->handle,
-                                                   characteristic->property,
-                                                   characteristic->security,
-                                                   characteristic->flag,
-                                                   uuid,
-                                                   characteristic->value_type,
-                                                   characteristic->maxlen,
-                                                   characteristic->value_len,
-                                                   characteristic->value,
-                                                   &characteristic->handle);
+    return app_async_gattdb_add_uuid128_characteristic(session,
+                                                       characteristic->service->handle,
+                                                       characteristic->property,
+                                                       characteristic->security,
+                                                       characteristic->flag,
+                                                       uuid,
+                                                       characteristic->value_type,
+                                                       characteristic->maxlen,
+                                                       characteristic->value_len,
+                                                       characteristic->value,
+                                                       &characteristic->handle);
   } else {
     return SL_STATUS_INVALID_PARAMETER;
   }
 }
+
+// Requires encryption for the BLEtest throughput characteristics.
+void app_gattdb_require_encryption(void)
+{
+  characteristics[BLETEST_THROUGHPUT_WRITE_RESPONSE_CHAR].security |=
+    SL_BT_GATTDB_ENCRYPTED_READ | SL_BT_GATTDB_ENCRYPTED_WRITE;
+  characteristics[BLETEST_THROUGHPUT_WRITE_CHAR].security |=
+    SL_BT_GATTDB_ENCRYPTED_READ | SL_BT_GATTDB_ENCRYPTED_WRITE;
+}
+
+// FNV-1a over a byte range.
+static uint32_t hash_bytes(uint32_t hash, const void *data, size_t len)
+{
+  const uint8_t *bytes = data;
+
+  for (size_t i = 0; i < len; i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+// Gets a hash of everything in the layout that ends up in the database.
+uint32_t app_gattdb_layout_hash(const gattdb_profile_t *profile)
+{
+  uint32_t hash = 2166136261u;
+  const service_t *service;
+  const characteristic_t *characteristic;
+  uint32_t service_index;
+
+  for (size_t i = 0; i < profile->service_count; i++) {
+    service = &profile->services[i];
+    hash = hash_bytes(hash, &service->type, sizeof(service->type));
+    hash = hash_bytes(hash, &service->property, sizeof(service->property));
+    hash = hash_bytes(hash, service->uuid, service->uuid_len);
+  }
+  for (size_t i = 0; i < profile->characteristic_count; i++) {
+    characteristic = &profile->characteristics[i];
+    service_index = (uint32_t)(characteristic->service - profile->services);
+    hash = hash_bytes(hash, &service_index, sizeof(service_index));
+    hash = hash_bytes(hash, &characteristic->property, sizeof(characteristic->property));
+    hash = hash_bytes(hash, &characteristic->security, sizeof(characteristic->security));
+    hash = hash_bytes(hash, &characteristic->flag, sizeof(characteristic->flag));
+    hash = hash_bytes(hash, characteristic->uuid, characteristic->uuid_len);
+    hash = hash_bytes(hash, &characteristic->value_type, sizeof(characteristic->value_type));
+    hash = hash_bytes(hash, &characteristic->maxlen, sizeof(characteristic->maxlen));
+    hash = hash_bytes(hash, characteristic->value, characteristic->value_len);
+  }
+  return hash;
+}
+
+// Remember the layout of a committed database on the host.
+sl_status_t app_gattdb_save_layout(const char *path, const gattdb_profile_t *profile)
+{
+  FILE *file;
+  int ret;
+
+  if (profile->service_count == 0) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  file = fopen(path, "w");
+  if (file == NULL) {
+    return SL_STATUS_FAIL;
+  }
+  ret = fprintf(file, "%08x %u\n", (unsigned int)app_gattdb_layout_hash(profile),
+                profile->services[0].handle);
+  if (fclose(file) != 0 || ret < 0) {
+    return SL_STATUS_FAIL;
+  }
+  return SL_STATUS_OK;
+}
+
+// Look up a database committed by an earlier run with the same layout.
+sl_status_t app_gattdb_find_layout(const char *path,
+                                   gattdb_profile_t *profile,
+                                   uint32_t *lookups)
+{
+  FILE *file;
+  unsigned int hash;
+  unsigned int first_handle;
+  int fields;
+
+  *lookups = 0;
+  file = fopen(path, "r");
+  if (file == NULL) {
+    return SL_STATUS_NOT_FOUND;
+  }
+  fields = fscanf(file, "%x %u", &hash, &first_handle);
+  fclose(file);
+  if (fields != 2 || first_handle == 0 || first_handle > UINT16_MAX) {
+    return SL_STATUS_NOT_FOUND;
+  }
+  if (hash != app_gattdb_layout_hash(profile)) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  // start after the static database, so its attributes can't match
+  return app_gattdb_find_characteristics(profile->characteristics,
+                                         profile->characteristic_count,
+                                         (uint16_t)first_handle,
+                                         lookups);
+}
+
+// Looks up characteristics in the committed database of the NCP by UUID.
+sl_status_t app_gattdb_find_characteristics(characteristic_t *characteristics,
+                                            size_t count,
+                                            uint16_t start,
+                                            uint32_t *lookups)
+{
+  sl_status_t sc = SL_STATUS_OK;
+  size_t i;
+
+  *lookups = 0;
+  for (i = 0; i < count; i++) {
+    (*lookups)++;
+    sc = sl_bt_gatt_server_find_attribute(start,
+                                          characteristics[i].uuid_len,
+                                          characteristics[i].uuid,
+                                          &characteristics[i].handle);
+    if (sc != SL_STATUS_OK) {
+      break;
+    }
+    start = characteristics[i].handle + 1;
+  }
+  if (sc != SL_STATUS_OK) {
+    // Partial match, don't leave stale handles behind.
+    for (size_t j = 0; j <= i && j < count; j++) {
+      characteristics[j].handle = 0xFFFF;
+    }
+  }
+  return (sc == SL_STATUS_BT_ATT_ATT_NOT_FOUND) ? SL_STATUS_NOT_FOUND : sc;
+}
+
+//---------------------------------
+// Profile loading
+
+gattdb_profile_t app_gattdb_profile = {
+  .services = services,
+  .service_count = SERVICES_COUNT,
+  .characteristics = characteristics,
+  .characteristic_count = CHARACTERISTICS_COUNT
+};
+
+// Loaded profile, 8-byte aligned for the service and characteristic arrays.
+static uint64_t profile_arena[APP_GATTDB_PROFILE_ARENA_SIZE / sizeof(uint64_t)];
+static size_t profile_arena_used;
+
+#define PROFILE_MAX_TOKENS 6
+
+typedef struct {
+  unsigned long line;
+  const char *error;
+} profile_parser_t;
+
+static void *arena_alloc(size_t size, size_t align)
+{
+  size_t offset = (profile_arena_used + align - 1) & ~(align - 1);
+
+  if (offset + size > sizeof(profile_arena)) {
+    return NULL;
+  }
+  profile_arena_used = offset + size;
+  return (uint8_t *)profile_arena + offset;
+}
+
+// Split a line into tokens. Quoted strings keep their spaces, and the quote
+// is kept as the first character so values can tell text from hex. Returns
+// -1 with the reason in error if the line can't be split.
+static int tokenize(char *line, char *tokens[], const char **error)
+{
+  int count = 0;
+  char *p = line;
+
+  while (*p != '\0') {
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+      p++;
+    }
+    if (*p == '\0' || *p == '#') {
+      break;
+    }
+    if (count == PROFILE_MAX_TOKENS) {
+      *error = "too many fields";
+      return -1;
+    }
+    tokens[count++] = p;
+    if (*p == '"') {
+      p = strchr(p + 1, '"');
+      if (p == NULL) {
+        *error = "missing closing quote";
+        return -1;
+      }
+      p++;
+      if (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n'
+          && *p != '#') {
+        *error = "unexpected text after the closing quote";
+        return -1;
+      }
+    } else {
+      while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\r'
+             && *p != '\n' && *p != '#') {
+        p++;
+      }
+    }
+    if (*p == '#') {
+      *p = '\0';
+    } else if (*p != '\0') {
+      *p++ = '\0';
+    }
+  }
+  return count;
+}
+
+// Parse a 16-bit or 128-bit UUID to the little-endian byte order used by
+// the GATT database API.
+static size_t parse_uuid(const char *str, uint8_t uuid[UUID_128_LEN])
+{
+  uint8_t be[UUID_128_LEN];
+  size_t len = 0;
+  int upper_nib;
+  int lower_nib;
+
+  while (*str != '\0') {
+    if (*str == '-') {
+      str++;
+      continue;
+    }
+    upper_nib = app_cust_hex_nibble(str[0]);
+    lower_nib = (upper_nib < 0) ? -1 : app_cust_hex_nibble(str[1]);
+    if (lower_nib < 0 || len == UUID_128_LEN) {
+      return 0;
+    }
+    be[len++] = (uint8_t)((upper_nib << 4) | lower_nib);
+    str += 2;
+  }
+  if (len != UUID_16_LEN && len != UUID_128_LEN) {
+    return 0;
+  }
+  for (size_t i = 0; i < len; i++) {
+    uuid[i] = be[len - 1 - i];
+  }
+  return len;
+}
+
+static sl_status_t parse_properties(char *str,
+                                    uint16_t *property,
+                                    uint16_t *security)
+{
+  static const struct {
+    const char *name;
+    uint16_t property;
+    uint16_t security;
+  } names[] = {
+    { "read", SL_BT_GATTDB_CHARACTERISTIC_READ, 0 },
+    { "write", SL_BT_GATTDB_CHARACTERISTIC_WRITE, 0 },
+    { "write_no_response", SL_BT_GATTDB_CHARACTERISTIC_WRITE_NO_RESPONSE, 0 },
+    { "notify", SL_BT_GATTDB_CHARACTERISTIC_NOTIFY, 0 },
+    { "indicate", SL_BT_GATTDB_CHARACTERISTIC_INDICATE, 0 },
+    { "encrypted_read", 0, SL_BT_GATTDB_ENCRYPTED_READ },
+    { "encrypted_write", 0, SL_BT_GATTDB_ENCRYPTED_WRITE },
+    { "authenticated_read", 0, SL_BT_GATTDB_AUTHENTICATED_READ },
+    { "authenticated_write", 0, SL_BT_GATTDB_AUTHENTICATED_WRITE },
+  };
+  char *name;
+  size_t i;
+
+  *property = 0;
+  *security = GATTDB_SECURITY_NONE;
+  for (name = strtok(str, ","); name != NULL; name = strtok(NULL, ",")) {
+    for (i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+      if (strcmp(name, names[i].name) == 0) {
+        *property |= names[i].property;
+        *security |= names[i].security;
+        break;
+      }
+    }
+    if (i == sizeof(names) / sizeof(names[0])) {
+      return SL_STATUS_INVALID_PARAMETER;
+    }
+  }
+  return (*property != 0) ? SL_STATUS_OK : SL_STATUS_INVALID_PARAMETER;
+}
+
+// Parse a quoted string or 0x prefixed hex bytes. Returns the length, -1 if
+// invalid or -2 if longer than APP_GATTDB_MAX_INITIAL_VALUE_LEN.
+static int parse_value(const char *str, uint8_t *value)
+{
+  size_t len;
+  int upper_nib;
+  int lower_nib;
+
+  if (str[0] == '"') {
+    len = strlen(str) - 2; // without the quotes
+    if (len > APP_GATTDB_MAX_INITIAL_VALUE_LEN) {
+      return -2;
+    }
+    if (value != NULL) {
+      memcpy(value, str + 1, len);
+    }
+    return (int)len;
+  }
+  if (strncmp(str, "0x", 2) != 0) {
+    return -1;
+  }
+  str += 2;
+  len = strlen(str);
+  if (len % 2 != 0) {
+    return -1;
+  }
+  if (len / 2 > APP_GATTDB_MAX_INITIAL_VALUE_LEN) {
+    return -2;
+  }
+  for (size_t i = 0; i < len / 2; i++) {
+    upper_nib = app_cust_hex_nibble(str[2 * i]);
+    lower_nib = app_cust_hex_nibble(str[2 * i + 1]);
+    if (upper_nib < 0 || lower_nib < 0) {
+      return -1;
+    }
+    if (value != NULL) {
+      value[i] = (uint8_t)((upper_nib << 4) | lower_nib);
+    }
+  }
+  return (int)(len / 2);
+}
+
+static sl_status_t parse_service(profile_parser_t *parser,
+                                 char *tokens[],
+                                 int count,
+                                 service_t *service)
+{
+  uint8_t uuid[UUID_128_LEN];
+  size_t uuid_len;
+
+  if (count < 2 || count > 3
+      || (count == 3 && strcmp(tokens[2], "secondary") != 0)) {
+    parser->error = "expected: service <uuid> [secondary]";
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  uuid_len = parse_uuid(tokens[1], uuid);
+  if (uuid_len == 0) {
+    parser->error = "invalid UUID";
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (service == NULL) {
+    return SL_STATUS_OK; // counting pass
+  }
+  service->uuid = arena_alloc(uuid_len, 1);
+  if (service->uuid == NULL) {
+    parser->error = "profile too large";
+    return SL_STATUS_NO_MORE_RESOURCE;
+  }
+  memcpy(service->uuid, uuid, uuid_len);
+  service->uuid_len = uuid_len;
+  service->type = (count == 3) ? sl_bt_gattdb_secondary_service
+                  : sl_bt_gattdb_primary_service;
+  service->property = GATTDB_ADVERTISED_SERVICE_NONE;
+  service->handle = 0xFFFF;
+  return SL_STATUS_OK;
+}
+
+static sl_status_t parse_characteristic(profile_parser_t *parser,
+                                        char *tokens[],
+                                        int count,
+                                        bool have_service,
+                                        service_t *service,
+                                        characteristic_t *characteristic)
+{
+  uint8_t uuid[UUID_128_LEN];
+  size_t uuid_len;
+  uint16_t property;
+  uint16_t security;
+  uint8_t value_type = sl_bt_gattdb_variable_length_value;
+  long maxlen = -1;
+  int value_len = 0;
+  const char *value = NULL;
+  char *end;
+  int i = 3;
+
+  if (count < 3) {
+    parser->error = "expected: char <uuid> <properties> [fixed|variable] [maxlen] [value]";
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (!have_service) {
+    parser->error = "characteristic before the first service";
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  uuid_len = parse_uuid(tokens[1], uuid);
+  if (uuid_len == 0) {
+    parser->error = "invalid UUID";
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (parse_properties(tokens[2], &property, &security) != SL_STATUS_OK) {
+    parser->error = "invalid properties";
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (i < count) {
+    if (strcmp(tokens[i], "fixed") == 0) {
+      value_type = sl_bt_gattdb_fixed_length_value;
+      i++;
+    } else if (strcmp(tokens[i], "variable") == 0) {
+      i++;
+    } else if (strcmp(tokens[i], "user") == 0) {
+      // nothing would answer the read and write requests
+      parser->error = "user managed values are not supported";
+      return SL_STATUS_NOT_SUPPORTED;
+    }
+  }
+  if (i < count && tokens[i][0] != '"' && strncmp(tokens[i], "0x", 2) != 0) {
+    maxlen = strtol(tokens[i], &end, 10);
+    if (*end != '\0' || maxlen < 0) {
+      parser->error = "invalid maximum length";
+      return SL_STATUS_INVALID_PARAMETER;
+    }
+    i++;
+  }
+  if (i < count) {
+    value = tokens[i++];
+    value_len = parse_value(value, NULL);
+    if (value_len == -2) {
+      parser->error = "initial value longer than 255 bytes";
+      return SL_STATUS_INVALID_PARAMETER;
+    } else if (value_len < 0) {
+      parser->error = "invalid value";
+      return SL_STATUS_INVALID_PARAMETER;
+    }
+  }
+  if (i != count) {
+    parser->error = "unexpected text after the value";
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (maxlen < 0) {
+    maxlen = (value_type == sl_bt_gattdb_fixed_length_value) ? value_len : 0xFF;
+  }
+  if (maxlen == 0 || maxlen > APP_GATTDB_MAX_VALUE_LEN || value_len > maxlen
+      || (value_type == sl_bt_gattdb_fixed_length_value && value_len != 0
+          && value_len != maxlen)) {
+    parser->error = "invalid maximum length";
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (characteristic == NULL) {
+    return SL_STATUS_OK; // counting pass
+  }
+
+  characteristic->uuid = arena_alloc(uuid_len, 1);
+  characteristic->value = (value_len != 0) ? arena_alloc(value_len, 1) : NULL;
+  if (characteristic->uuid == NULL
+      || (value_len != 0 && characteristic->value == NULL)) {
+    parser->error = "profile too large";
+    return SL_STATUS_NO_MORE_RESOURCE;
+  }
+  memcpy(characteristic->uuid, uuid, uuid_len);
+  if (value_len != 0) {
+    parse_value(value, characteristic->value);
+  }
+  characteristic->service = service;
+  characteristic->property = property;
+  characteristic->security = security;
+  characteristic->flag = GATTDB_FLAG_NONE;
+  characteristic->uuid_len = uuid_len;
+  characteristic->value_type = value_type;
+  characteristic->maxlen = (uint16_t)maxlen;
+  characteristic->value_len = (size_t)value_len;
+  characteristic->handle = 0xFFFF;
+  return SL_STATUS_OK;
+}
+
+// Parse the profile. With NULL arrays only counts and validates.
+static sl_status_t parse_profile(FILE *file,
+                                 profile_parser_t *parser,
+                                 service_t *service_array,
+                                 size_t *service_count,
+                                 characteristic_t *characteristic_array,
+                                 size_t *characteristic_count)
+{
+  char *line = NULL;
+  size_t line_size = 0;
+  char *tokens[PROFILE_MAX_TOKENS];
+  int count;
+  service_t *service = NULL;
+  bool have_service = false;
+  sl_status_t sc = SL_STATUS_OK;
+
+  *service_count = 0;
+  *characteristic_count = 0;
+  parser->line = 0;
+  while (sc == SL_STATUS_OK && getline(&line, &line_size, file) != -1) {
+    parser->line++;
+    count = tokenize(line, tokens, &parser->error);
+    if (count == 0) {
+      continue;
+    } else if (count < 0) {
+      sc = SL_STATUS_INVALID_PARAMETER;
+    } else if (strcmp(tokens[0], "service") == 0) {
+      service = (service_array != NULL) ? &service_array[*service_count] : NULL;
+      sc = parse_service(parser, tokens, count, service);
+      have_service = true;
+      (*service_count)++;
+    } else if (strcmp(tokens[0], "char") == 0) {
+      sc = parse_characteristic(parser, tokens, count, have_service, service,
+                                (characteristic_array != NULL)
+                                ? &characteristic_array[*characteristic_count] : NULL);
+      (*characteristic_count)++;
+    } else {
+      parser->error = "expected service or char";
+      sc = SL_STATUS_INVALID_PARAMETER;
+    }
+  }
+  free(line);
+  if (sc == SL_STATUS_OK && *service_count == 0) {
+    parser->error = "no services";
+    sc = SL_STATUS_INVALID_PARAMETER;
+  }
+  return sc;
+}
+
+// Loads a database layout from a profile file and makes it the active one.
+sl_status_t app_gattdb_load_profile(const char *path)
+{
+  FILE *file;
+  profile_parser_t parser = { 0 };
+  size_t service_count;
+  size_t characteristic_count;
+  service_t *service_array;
+  characteristic_t *characteristic_array;
+  sl_status_t sc;
+
+  file = fopen(path, "r");
+  if (file == NULL) {
+    printf("Error! Cannot open GATT profile \"%s\"\n", path);
+    return SL_STATUS_NOT_FOUND;
+  }
+
+  // First pass validates and counts, so the arrays can go in front of the
+  // UUIDs and values in the arena.
+  sc = parse_profile(file, &parser, NULL, &service_count, NULL, &characteristic_count);
+  if (sc == SL_STATUS_OK) {
+    profile_arena_used = 0;
+    service_array = arena_alloc(service_count * sizeof(service_t), sizeof(uint64_t));
+    characteristic_array = arena_alloc(characteristic_count * sizeof(characteristic_t),
+                                       sizeof(uint64_t));
+    if (service_array == NULL || characteristic_array == NULL) {
+      parser.error = "profile too large";
+      sc = SL_STATUS_NO_MORE_RESOURCE;
+    } else {
+      rewind(file);
+      sc = parse_profile(file, &parser, service_array, &service_count,
+                         characteristic_array, &characteristic_count);
+    }
+  }
+  fclose(file);
+
+  if (sc != SL_STATUS_OK) {
+    printf("Error in GATT profile \"%s\" line %lu: %s\n", path, parser.line,
+           parser.error);
+    return sc;
+  }
+  app_gattdb_profile.services = service_array;
+  app_gattdb_profile.service_count = service_count;
+  app_gattdb_profile.characteristics = characteristic_array;
+  app_gattdb_profile.characteristic_count = characteristic_count;
+  return SL_STATUS_OK;
+}
@@ -35,6 +35,14 @@
 #define UUID_16_LEN (2)
 #define UUID_128_LEN (16)
 
+// Storage for a database loaded from a profile file, in bytes.
+#define APP_GATTDB_PROFILE_ARENA_SIZE (16384)
+// Largest maximum length of a characteristic value in a profile file.
+#define APP_GATTDB_MAX_VALUE_LEN (512)
+// Longest initial value in a profile file, as a BGAPI byte array carries at
+// most 255 bytes.
+#define APP_GATTDB_MAX_INITIAL_VALUE_LEN (255)
+
 //---------------------------------
 // Structures
 typedef struct service_s{
@@ -82,13 +90,27 @@ typedef enum {
 } characteristic_index_t;
 extern characteristic_t characteristics[CHARACTERISTICS_COUNT];
 
+//---------------------------------
+// Database layout used by the application
+typedef struct gattdb_profile_s{
+  service_t *services;
+  size_t service_count;
+  characteristic_t *characteristics;
+  size_t characteristic_count;
+} gattdb_profile_t;
+
+// Active layout. Points to services[] and characteristics[] unless a profile
+// file is loaded.
+extern gattdb_profile_t app_gattdb_profile;
+
 //---------------------------------
 // Function headers
 /***************************************************************************//**
  * Handles adding a new service.
  * @param[in] session The database update session ID.
  * @param[in] service The service attribute handle. Ensured to be valid in
- *   current session
+ *   current session. With pipelined commands, the handle is written when the
+ *   response arrives, see app_async_barrier().
  * @return SL_STATUS_OK if successful. Error code otherwise.
  ******************************************************************************/
 sl_status_t app_gattdb_add_service(uint16_t session, service_t *service);
@@ -97,10 +119,97 @@ sl_status_t app_gattdb_add_service(uint16_t session, service_t *service);
  * Handles adding a new characteristic to a service.
  * @param[in] session The database update session ID.
  * @param[in] characteristic The characteristic attribute handle. Ensured to be
- *   valid in current session.
+ *   valid in current session. With pipelined commands, the handle is written
+ *   when the response arrives, see app_async_barrier().
  * @return SL_STATUS_OK if successful. Error code otherwise.
  ******************************************************************************/
 sl_status_t app_gattdb_add_characteristic(uint16_t session,
                                           characteristic_t *characteristic);
 
+/***************************************************************************//**
+ * Requires an encrypted link to read or write the BLEtest throughput
+ * characteristics of the built-in database. A database loaded from a profile
+ * file keeps the security given in the file.
+ ******************************************************************************/
+void app_gattdb_require_encryption(void);
+
+/***************************************************************************//**
+ * Looks up characteristics in the committed database of the NCP by UUID.
+ * The characteristics must be found in the given order, which is the order
+ * they are added in. If any of them is missing, the handles are set back to
+ * the invalid handle 0xFFFF.
+ * @param[in,out] characteristics The characteristics to look up.
+ * @param[in] count Number of characteristics.
+ * @param[in] start Handle to start the search from.
+ * @param[out] lookups Number of BGAPI lookups issued.
+ * @return SL_STATUS_OK if all characteristics were found.
+ *   SL_STATUS_NOT_FOUND or error code otherwise.
+ ******************************************************************************/
+sl_status_t app_gattdb_find_characteristics(characteristic_t *characteristics,
+                                            size_t count,
+                                            uint16_t start,
+                                            uint32_t *lookups);
+
+/***************************************************************************//**
+ * Gets a hash of a layout: the services and characteristics with their UUIDs,
+ * properties, security, flags, value types, maximum lengths and values.
+ * @param[in] profile The layout.
+ * @return The hash.
+ ******************************************************************************/
+uint32_t app_gattdb_layout_hash(const gattdb_profile_t *profile);
+
+/***************************************************************************//**
+ * Remembers the layout of a committed database in a file on the host: the
+ * layout hash and the handle of its first service. Nothing is added to the
+ * database itself.
+ * @param[in] path State file.
+ * @param[in] profile The committed layout, with the service handles set.
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ ******************************************************************************/
+sl_status_t app_gattdb_save_layout(const char *path, const gattdb_profile_t *profile);
+
+/***************************************************************************//**
+ * Looks up a database committed by an earlier run with the same layout, as
+ * remembered by app_gattdb_save_layout(). The characteristics are searched
+ * from the first service handle of that database on, so attributes of the
+ * static database are never taken for them.
+ * @param[in] path State file.
+ * @param[in,out] profile The layout. The characteristic handles are set if
+ *   found.
+ * @param[out] lookups Number of BGAPI lookups issued.
+ * @return SL_STATUS_OK if found. SL_STATUS_INVALID_STATE if the earlier run
+ *   committed another layout. SL_STATUS_NOT_FOUND if there is no state file
+ *   or the characteristics are missing, e.g. after a power cycle. Error code
+ *   otherwise.
+ ******************************************************************************/
+sl_status_t app_gattdb_find_layout(const char *path,
+                                   gattdb_profile_t *profile,
+                                   uint32_t *lookups);
+
+/***************************************************************************//**
+ * Loads a database layout from a profile file and makes it the active one.
+ *
+ * The profile is a text file with one attribute per line, in database order:
+ *   service <uuid> [secondary]
+ *   char <uuid> <properties> [fixed|variable] [maxlen] [value]
+ * UUIDs are 4 hex digits or the 128-bit form
+ * xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx. Properties are a comma separated
+ * list of read, write, write_no_response, notify, indicate, encrypted_read,
+ * encrypted_write, authenticated_read and authenticated_write. The maximum
+ * length is decimal, at most APP_GATTDB_MAX_VALUE_LEN, and defaults to the
+ * value length for fixed values and 255 otherwise. The value is a quoted
+ * string or hex bytes with a 0x prefix, at most
+ * APP_GATTDB_MAX_INITIAL_VALUE_LEN bytes, so a longer fixed value has no
+ * initial value. Text after '#' is ignored. Extra fields and text right after
+ * a closing quote are errors.
+ *
+ * The whole layout, including UUIDs and values, is placed in one static
+ * arena of APP_GATTDB_PROFILE_ARENA_SIZE bytes.
+ *
+ * @param[in] path Profile file path.
+ * @return SL_STATUS_OK if successful. Error code otherwise, with the reason
+ *   printed.
+ ******************************************************************************/
+sl_status_t app_gattdb_load_profile(const char *path);
+
 #endif // APP_GATTDB_H
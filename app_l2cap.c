@@ -0,0 +1,331 @@
+/***************************************************************************//**
+ * @file
+ * @brief L2CAP connection-oriented channel throughput.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "sl_bt_api.h"
+#include "app_l2cap.h"
+#include "app_metrics.h"
+#include "app_time.h"
+
+// Length of the SDU length field in the first K-frame of an SDU.
+#define SDU_LENGTH_FIELD 2
+
+typedef struct {
+  bool open;
+  bool sender;
+  uint8_t connection;
+  uint16_t cid;
+  uint16_t peer_mtu;
+  uint16_t peer_mps;
+  uint16_t sdu_len;        // sender: SDU length, receiver: largest SDU
+  uint16_t frames_per_sdu; // K-frames, and credits, needed per SDU
+  uint32_t credits;        // sender: credits left, receiver: credits granted
+  uint32_t consumed;       // receiver: K-frames since credits were returned
+} channel_t;
+
+typedef struct {
+  uint64_t sdus;
+  uint64_t bytes;
+  uint64_t credits_received;
+  uint64_t credits_returned;
+  uint32_t credit_stalls;  // sends deferred for lack of credits
+  uint32_t buffer_stalls;  // sends deferred for lack of NCP buffers
+  int64_t stall_start_us;
+  int64_t stall_us;
+} channel_stats_t;
+
+static uint16_t local_mtu = APP_L2CAP_MTU_DEFAULT;
+static uint16_t local_mps = APP_L2CAP_MPS_DEFAULT;
+static uint16_t local_credits = APP_L2CAP_CREDITS_DEFAULT;
+static channel_t channel = { 0 };
+static channel_stats_t stats = { 0 };
+static uint8_t sdu[APP_L2CAP_MAX_SEND_LEN];
+
+// Number of K-frames needed to carry an SDU of len bytes.
+static uint16_t frames_per_sdu(uint16_t len, uint16_t mps)
+{
+  return (uint16_t)((len + SDU_LENGTH_FIELD + mps - 1) / mps);
+}
+
+// Start the channel and clear the counters.
+static void channel_start(uint8_t connection, uint16_t cid, bool sender,
+                          uint16_t peer_mtu, uint16_t peer_mps, uint16_t credit)
+{
+  channel.open = true;
+  channel.sender = sender;
+  channel.connection = connection;
+  channel.cid = cid;
+  channel.peer_mtu = peer_mtu;
+  channel.peer_mps = peer_mps;
+  channel.consumed = 0;
+  if (sender) {
+    // the largest SDU that still fits in one K-frame with its length field
+    channel.sdu_len = peer_mtu < APP_L2CAP_MAX_SEND_LEN ? peer_mtu : APP_L2CAP_MAX_SEND_LEN;
+    if (channel.sdu_len > peer_mps - SDU_LENGTH_FIELD) {
+      channel.sdu_len = (uint16_t)(peer_mps - SDU_LENGTH_FIELD);
+    }
+    channel.frames_per_sdu = frames_per_sdu(channel.sdu_len, peer_mps);
+    channel.credits = credit;
+  } else {
+    channel.sdu_len = local_mtu;
+    channel.frames_per_sdu = frames_per_sdu(local_mtu, local_mps);
+    channel.credits = local_credits;
+  }
+  memset(&stats, 0, sizeof(stats));
+  for (size_t i = 0; i < sizeof(sdu); i++) {
+    sdu[i] = (uint8_t)i;
+  }
+}
+
+// End a credit stall, if any.
+static void stall_end(void)
+{
+  if (stats.stall_start_us != 0) {
+    stats.stall_us += app_time_mono_us() - stats.stall_start_us;
+    stats.stall_start_us = 0;
+  }
+}
+
+// Set the channel parameters.
+void app_l2cap_configure(uint16_t mtu, uint16_t mps, uint16_t credits)
+{
+  local_mtu = mtu;
+  local_mps = mps;
+  local_credits = credits;
+}
+
+// Get the credits needed for one SDU.
+uint16_t app_l2cap_min_credits(uint16_t mtu, uint16_t mps)
+{
+  return frames_per_sdu(mtu, mps);
+}
+
+// Open the throughput channel.
+sl_status_t app_l2cap_open(uint8_t connection)
+{
+  uint16_t cid;
+  sl_status_t sc;
+
+  sc = sl_bt_l2cap_open_le_channel(connection, APP_L2CAP_SPSM, local_mtu,
+                                   local_mps, local_credits, &cid);
+  if (sc == SL_STATUS_OK) {
+    channel.open = false;
+    channel.connection = connection;
+    channel.cid = cid;
+  }
+  return sc;
+}
+
+// Accept or reject a channel open request.
+sl_status_t app_l2cap_on_open_request(uint8_t connection,
+                                      uint16_t spsm,
+                                      uint16_t cid,
+                                      uint16_t max_sdu,
+                                      uint16_t max_pdu,
+                                      uint16_t credit,
+                                      bool accept)
+{
+  sl_status_t sc;
+
+  if (!accept || spsm != APP_L2CAP_SPSM || channel.open) {
+    sc = sl_bt_l2cap_send_le_channel_open_response(connection, cid, local_mtu,
+                                                   local_mps, 0,
+                                                   sl_bt_l2cap_connection_result_spsm_not_supported);
+    return (sc == SL_STATUS_OK) ? SL_STATUS_NOT_SUPPORTED : sc;
+  }
+  sc = sl_bt_l2cap_send_le_channel_open_response(connection, cid, local_mtu,
+                                                 local_mps, local_credits,
+                                                 sl_bt_l2cap_connection_result_successful);
+  if (sc == SL_STATUS_OK) {
+    channel_start(connection, cid, false, max_sdu, max_pdu, credit);
+  }
+  return sc;
+}
+
+// Handle the response to the open request.
+sl_status_t app_l2cap_on_open_response(uint16_t cid,
+                                       uint16_t max_sdu,
+                                       uint16_t max_pdu,
+                                       uint16_t credit,
+                                       uint16_t errorcode)
+{
+  if (cid != channel.cid || channel.open) {
+    return SL_STATUS_NOT_FOUND;
+  }
+  if (errorcode != sl_bt_l2cap_connection_result_successful) {
+    printf("L2CAP channel refused by peer, result 0x%04x\n", errorcode);
+    return SL_STATUS_FAIL;
+  }
+  channel_start(channel.connection, cid, true, max_sdu, max_pdu, credit);
+  return SL_STATUS_OK;
+}
+
+// Add credits from the peer.
+void app_l2cap_on_credit(uint16_t cid, uint16_t credit)
+{
+  if (!channel.open || cid != channel.cid) {
+    return;
+  }
+  channel.credits += credit;
+  stats.credits_received += credit;
+}
+
+// Count a received SDU and return credits when half of them are used.
+uint32_t app_l2cap_on_data(uint16_t cid, uint16_t len)
+{
+  uint16_t frames;
+  uint32_t threshold;
+  uint32_t headroom;
+  sl_status_t sc;
+
+  if (!channel.open || cid != channel.cid || channel.sender) {
+    return 0;
+  }
+  frames = frames_per_sdu(len, local_mps);
+  stats.sdus++;
+  stats.bytes += len;
+  channel.consumed += frames;
+  // return credits in batches of half the window, but before the sender can
+  // be left with too few credits for a whole SDU of the largest size
+  threshold = ((uint32_t)local_credits + 1) / 2;
+  if (channel.frames_per_sdu <= local_credits) {
+    headroom = (uint32_t)local_credits + 1 - channel.frames_per_sdu;
+    if (headroom < threshold) {
+      threshold = headroom;
+    }
+  }
+  if (channel.consumed >= threshold) {
+    sc = sl_bt_l2cap_channel_send_credit(channel.connection, channel.cid,
+                                         (uint16_t)channel.consumed);
+    if (sc == SL_STATUS_OK) {
+      stats.credits_returned += channel.consumed;
+      channel.consumed = 0;
+    }
+  }
+  return len;
+}
+
+// Send one SDU if credits allow.
+sl_status_t app_l2cap_send(uint32_t *sent)
+{
+  sl_status_t sc;
+
+  *sent = 0;
+  if (!channel.open || !channel.sender) {
+    return SL_STATUS_OK;
+  }
+  if (channel.credits < channel.frames_per_sdu) {
+    if (stats.stall_start_us == 0) {
+      stats.credit_stalls++;
+      stats.stall_start_us = app_time_mono_us();
+    }
+    return SL_STATUS_OK;
+  }
+  stall_end();
+  sdu[0] = (uint8_t)stats.sdus;
+  sc = sl_bt_l2cap_channel_send_data(channel.connection, channel.cid,
+                                     channel.sdu_len, sdu);
+  if (sc == SL_STATUS_NO_MORE_RESOURCE) {
+    // NCP buffers full, try again on the next round
+    stats.buffer_stalls++;
+    return SL_STATUS_OK;
+  }
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  channel.credits -= channel.frames_per_sdu;
+  stats.sdus++;
+  stats.bytes += channel.sdu_len;
+  *sent = channel.sdu_len;
+  return SL_STATUS_OK;
+}
+
+// Forget the channel.
+bool app_l2cap_on_closed(uint16_t cid)
+{
+  if (!channel.open || (cid != 0 && cid != channel.cid)) {
+    return false;
+  }
+  stall_end();
+  channel.open = false;
+  return true;
+}
+
+// Check if the channel is open.
+bool app_l2cap_is_open(void)
+{
+  return channel.open;
+}
+
+// Print the negotiated parameters.
+void app_l2cap_print_channel(void)
+{
+  printf("L2CAP channel 0x%04x open on SPSM 0x%04x as %s\n", channel.cid,
+         APP_L2CAP_SPSM, channel.sender ? "sender" : "receiver");
+  printf("  local  MTU %u, MPS %u, credits %u\n", local_mtu, local_mps, local_credits);
+  printf("  peer   MTU %u, MPS %u", channel.peer_mtu, channel.peer_mps);
+  if (channel.sender) {
+    printf(", credits %u\n", channel.credits);
+    printf("  SDU %u bytes in %u K-frames\n", channel.sdu_len, channel.frames_per_sdu);
+  } else {
+    printf("\n");
+  }
+}
+
+// Set the metrics.
+void app_l2cap_publish(void)
+{
+  app_metrics_set_counter("l2cap_sdus", (double)stats.sdus);
+  app_metrics_set_counter("l2cap_bytes", (double)stats.bytes);
+  app_metrics_set_counter("l2cap_credit_stalls", stats.credit_stalls);
+  app_metrics_set_gauge("l2cap_credit_stall_seconds", stats.stall_us / 1e6);
+}
+
+// Print the totals.
+void app_l2cap_print(void)
+{
+  stall_end();
+  if (stats.sdus == 0 && stats.credit_stalls == 0) {
+    return;
+  }
+  printf("L2CAP %s: %llu SDUs, %llu bytes\n", channel.sender ? "sent" : "received",
+         (unsigned long long)stats.sdus, (unsigned long long)stats.bytes);
+  if (channel.sender) {
+    printf("  credits received %llu, waited for credits %u times, %.3f s total\n",
+           (unsigned long long)stats.credits_received, stats.credit_stalls,
+           stats.stall_us / 1e6);
+    if (stats.buffer_stalls != 0) {
+      printf("  NCP buffers full %u times\n", stats.buffer_stalls);
+    }
+  } else {
+    printf("  credits returned %llu\n", (unsigned long long)stats.credits_returned);
+  }
+}
@@ -0,0 +1,166 @@
+/***************************************************************************//**
+ * @file
+ * @brief L2CAP connection-oriented channel throughput.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_L2CAP_H
+#define APP_L2CAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sl_status.h"
+
+// Fixed SPSM of the BLEtest throughput channel, from the dynamic range.
+#define APP_L2CAP_SPSM 0x0080
+// Channel parameters unless given.
+#define APP_L2CAP_MTU_DEFAULT 1024
+#define APP_L2CAP_MPS_DEFAULT 247 // one K-frame per 251 byte LL packet
+#define APP_L2CAP_CREDITS_DEFAULT 16
+// Smallest MTU and MPS allowed by the Core specification.
+#define APP_L2CAP_MIN_MTU 23
+#define APP_L2CAP_MIN_MPS 23
+#define APP_L2CAP_MAX_MPS 65533
+// Largest SDU sent in one BGAPI command.
+#define APP_L2CAP_MAX_SEND_LEN 250
+
+/***************************************************************************//**
+ * Set the channel parameters used when opening or accepting a channel. The
+ * credits must cover at least one SDU of mtu bytes split into mps sized
+ * K-frames, see app_l2cap_min_credits().
+ * @param[in] mtu Largest SDU this side receives.
+ * @param[in] mps Largest K-frame payload this side receives.
+ * @param[in] credits K-frames the peer may send before this side returns
+ *   credits.
+ ******************************************************************************/
+void app_l2cap_configure(uint16_t mtu, uint16_t mps, uint16_t credits);
+
+/***************************************************************************//**
+ * Get the credits needed for one SDU.
+ * @param[in] mtu SDU length.
+ * @param[in] mps K-frame payload length.
+ * @return Number of K-frames.
+ ******************************************************************************/
+uint16_t app_l2cap_min_credits(uint16_t mtu, uint16_t mps);
+
+/***************************************************************************//**
+ * Open the throughput channel as the sender.
+ * @param[in] connection Connection handle.
+ * @return SL_STATUS_OK if the request was sent. Error code otherwise.
+ ******************************************************************************/
+sl_status_t app_l2cap_open(uint8_t connection);
+
+/***************************************************************************//**
+ * Handle a channel open request as the receiver. Requests for other SPSMs,
+ * or all requests if accept is false, are rejected.
+ * @param[in] connection Connection handle.
+ * @param[in] spsm Requested SPSM.
+ * @param[in] cid Local channel.
+ * @param[in] max_sdu Largest SDU the peer receives.
+ * @param[in] max_pdu Largest K-frame payload the peer receives.
+ * @param[in] credit K-frames this side may send.
+ * @param[in] accept Accept requests for APP_L2CAP_SPSM.
+ * @return SL_STATUS_OK if the channel is open. SL_STATUS_NOT_SUPPORTED if
+ *   rejected. Error code of the response otherwise.
+ ******************************************************************************/
+sl_status_t app_l2cap_on_open_request(uint8_t connection,
+                                      uint16_t spsm,
+                                      uint16_t cid,
+                                      uint16_t max_sdu,
+                                      uint16_t max_pdu,
+                                      uint16_t credit,
+                                      bool accept);
+
+/***************************************************************************//**
+ * Handle the response to app_l2cap_open().
+ * @param[in] cid Local channel.
+ * @param[in] max_sdu Largest SDU the peer receives.
+ * @param[in] max_pdu Largest K-frame payload the peer receives.
+ * @param[in] credit K-frames this side may send.
+ * @param[in] errorcode Result from the peer.
+ * @return SL_STATUS_OK if the channel is open. SL_STATUS_FAIL if the peer
+ *   refused it. SL_STATUS_NOT_FOUND if the response is not for the channel
+ *   being opened.
+ ******************************************************************************/
+sl_status_t app_l2cap_on_open_response(uint16_t cid,
+                                       uint16_t max_sdu,
+                                       uint16_t max_pdu,
+                                       uint16_t credit,
+                                       uint16_t errorcode);
+
+/***************************************************************************//**
+ * Add credits returned by the peer.
+ * @param[in] cid Channel.
+ * @param[in] credit Number of K-frames.
+ ******************************************************************************/
+void app_l2cap_on_credit(uint16_t cid, uint16_t credit);
+
+/***************************************************************************//**
+ * Count a received SDU and return credits to the peer once half of the
+ * initial credits are used, or earlier if the rest would not carry an SDU of
+ * the local MTU.
+ * @param[in] cid Channel.
+ * @param[in] len SDU length.
+ * @return Bytes received on the throughput channel, 0 for other channels.
+ ******************************************************************************/
+uint32_t app_l2cap_on_data(uint16_t cid, uint16_t len);
+
+/***************************************************************************//**
+ * Send one SDU if the credits for all of its K-frames are available.
+ * @param[out] sent Bytes sent, 0 while waiting for credits or NCP buffers.
+ * @return SL_STATUS_OK, also while waiting. Error code otherwise.
+ ******************************************************************************/
+sl_status_t app_l2cap_send(uint32_t *sent);
+
+/***************************************************************************//**
+ * Forget the channel after it or its connection was closed.
+ * @param[in] cid Channel, 0 for any.
+ * @return true if the throughput channel was open and is now closed.
+ ******************************************************************************/
+bool app_l2cap_on_closed(uint16_t cid);
+
+/***************************************************************************//**
+ * Check if the throughput channel is open.
+ * @return true if open.
+ ******************************************************************************/
+bool app_l2cap_is_open(void);
+
+/***************************************************************************//**
+ * Print the negotiated parameters.
+ ******************************************************************************/
+void app_l2cap_print_channel(void);
+
+/***************************************************************************//**
+ * Set the SDU and credit counters as metrics.
+ ******************************************************************************/
+void app_l2cap_publish(void);
+
+/***************************************************************************//**
+ * Print the SDU totals and how long the sender waited for credits.
+ ******************************************************************************/
+void app_l2cap_print(void);
+
+#endif // APP_L2CAP_H
@@ -0,0 +1,214 @@
+/***************************************************************************//**
+ * @file
+ * @brief Time series of link layer packet counters sampled at each report.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdio.h>
+#include "app_link_stats.h"
+#include "app_stats.h"
+
+static app_link_stats_sample_t samples[APP_LINK_STATS_MAX_SAMPLES];
+static size_t sample_head = 0;   // next slot to write
+static size_t sample_count = 0;
+static uint32_t total_samples = 0;
+static uint64_t total_tx_packets = 0;
+static uint64_t total_rx_packets = 0;
+static uint64_t total_crc_errors = 0;
+static uint64_t total_failures = 0;
+static int64_t first_time_us = 0;
+static uint8_t coex_sampled = false;
+
+// Add the counters of an interval.
+void app_link_stats_add(const app_link_stats_sample_t *sample)
+{
+  if (total_samples == 0) {
+    first_time_us = sample->time_us - sample->interval_us;
+  }
+  samples[sample_head] = *sample;
+  sample_head = (sample_head + 1) % APP_LINK_STATS_MAX_SAMPLES;
+  if (sample_count < APP_LINK_STATS_MAX_SAMPLES) {
+    sample_count++;
+  }
+  total_samples++;
+  total_tx_packets += sample->tx_packets;
+  total_rx_packets += sample->rx_packets;
+  total_crc_errors += sample->crc_errors;
+  total_failures += sample->failures;
+  if (sample->coex_valid) {
+    coex_sampled = true;
+  }
+}
+
+// Get the number of samples in the ring.
+size_t app_link_stats_count(void)
+{
+  return sample_count;
+}
+
+// Get a sample from the ring, 0 is the oldest.
+const app_link_stats_sample_t *app_link_stats_get(size_t index)
+{
+  size_t oldest = (sample_head + APP_LINK_STATS_MAX_SAMPLES - sample_count)
+                  % APP_LINK_STATS_MAX_SAMPLES;
+
+  return &samples[(oldest + index) % APP_LINK_STATS_MAX_SAMPLES];
+}
+
+// Get the CRC error rate of a sample.
+double app_link_stats_crc_error_rate(const app_link_stats_sample_t *sample)
+{
+  uint32_t received = (uint32_t)sample->rx_packets + sample->crc_errors;
+
+  return (received == 0) ? 0.0 : 100.0 * sample->crc_errors / received;
+}
+
+// Get the difference of two coex counter readings.
+void app_link_stats_coex_delta(const app_link_stats_coex_t *now,
+                               const app_link_stats_coex_t *before,
+                               app_link_stats_coex_t *delta)
+{
+  // unsigned subtraction also covers a counter wrap
+  delta->low_pri_requested = now->low_pri_requested - before->low_pri_requested;
+  delta->high_pri_requested = now->high_pri_requested - before->high_pri_requested;
+  delta->low_pri_denied = now->low_pri_denied - before->low_pri_denied;
+  delta->high_pri_denied = now->high_pri_denied - before->high_pri_denied;
+  delta->low_pri_tx_abort = now->low_pri_tx_abort - before->low_pri_tx_abort;
+  delta->high_pri_tx_abort = now->high_pri_tx_abort - before->high_pri_tx_abort;
+}
+
+static double per_second(uint32_t count, const app_link_stats_sample_t *sample)
+{
+  return (sample->interval_us == 0) ? 0.0 : count * 1e6 / sample->interval_us;
+}
+
+// Compare throughput in intervals with and without high priority denials.
+static void print_coex_correlation(void)
+{
+  static double deny_rates[APP_LINK_STATS_MAX_SAMPLES];
+  static double throughputs[APP_LINK_STATS_MAX_SAMPLES];
+  const app_link_stats_sample_t *sample;
+  size_t count = 0;
+  size_t denied_count = 0;
+  double denied_sum = 0;
+  double clear_sum = 0;
+  double r;
+
+  for (size_t i = 0; i < sample_count; i++) {
+    sample = app_link_stats_get(i);
+    if (!sample->coex_valid || sample->throughput_bps < 0) {
+      continue;
+    }
+    deny_rates[count] = per_second(sample->coex.high_pri_denied, sample);
+    throughputs[count] = sample->throughput_bps;
+    if (sample->coex.high_pri_denied != 0) {
+      denied_sum += sample->throughput_bps;
+      denied_count++;
+    } else {
+      clear_sum += sample->throughput_bps;
+    }
+    count++;
+  }
+  if (count == 0) {
+    return;
+  }
+
+  printf("Coex: %zu of %zu intervals with high priority denials", denied_count, count);
+  if (denied_count != 0 && denied_count != count) {
+    double denied_mean = denied_sum / denied_count;
+    double clear_mean = clear_sum / (count - denied_count);
+    printf(", mean throughput %.0f bps vs %.0f bps in clear intervals", denied_mean, clear_mean);
+    if (clear_mean > 0) {
+      printf(" (%+.1f%%)", 100.0 * (denied_mean - clear_mean) / clear_mean);
+    }
+  }
+  printf("\n");
+  if (app_stats_pearson(deny_rates, throughputs, count, &r) == 0) {
+    printf("Coex: correlation of high priority deny rate and throughput r=%.2f\n", r);
+  }
+}
+
+// Print the counter totals.
+void app_link_stats_print_totals(void)
+{
+  printf("Link layer packets TX:%llu, RX:%llu, CRC ERR:%llu, failures:%llu\n",
+         (unsigned long long)total_tx_packets,
+         (unsigned long long)total_rx_packets,
+         (unsigned long long)total_crc_errors,
+         (unsigned long long)total_failures);
+}
+
+// Print the per-interval series and the CRC error rate percentiles.
+void app_link_stats_print(void)
+{
+  static double rates[APP_LINK_STATS_MAX_SAMPLES];
+  const app_link_stats_sample_t *sample;
+
+  if (sample_count == 0) {
+    return;
+  }
+  printf("\nLink layer counters per report interval");
+  if (total_samples > sample_count) {
+    printf(" (last %zu of %u)", sample_count, total_samples);
+  }
+  printf(":\n   time[s]     TX     RX CRC_ERR  FAIL  CRC_ERR[%%]  throughput[bps]");
+  if (coex_sampled) {
+    printf("  HP_DENY/s  LP_DENY/s  ABORT/s");
+  }
+  printf("\n");
+  for (size_t i = 0; i < sample_count; i++) {
+    sample = app_link_stats_get(i);
+    rates[i] = app_link_stats_crc_error_rate(sample);
+    printf("%10.1f %6u %6u %7u %5u %11.2f",
+           (sample->time_us - first_time_us) / 1e6,
+           sample->tx_packets, sample->rx_packets,
+           sample->crc_errors, sample->failures, rates[i]);
+    if (sample->throughput_bps >= 0) {
+      printf(" %16.0f", sample->throughput_bps);
+    } else {
+      printf(" %16s", "-");
+    }
+    if (sample->coex_valid) {
+      printf(" %10.1f %10.1f %8.1f",
+             per_second(sample->coex.high_pri_denied, sample),
+             per_second(sample->coex.low_pri_denied, sample),
+             per_second(sample->coex.low_pri_tx_abort + sample->coex.high_pri_tx_abort, sample));
+    }
+    printf("\n");
+  }
+  app_stats_sort(rates, sample_count);
+  printf("CRC error rate [%%] over %zu intervals: p50=%.2f p90=%.2f p99=%.2f max=%.2f\n",
+         sample_count,
+         app_stats_percentile(rates, sample_count, 50),
+         app_stats_percentile(rates, sample_count, 90),
+         app_stats_percentile(rates, sample_count, 99),
+         rates[sample_count - 1]);
+  app_link_stats_print_totals();
+  if (coex_sampled) {
+    print_coex_correlation();
+  }
+}
@@ -0,0 +1,111 @@
+/***************************************************************************//**
+ * @file
+ * @brief Time series of link layer packet counters sampled at each report.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_LINK_STATS_H
+#define APP_LINK_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Number of report intervals kept. Older samples are overwritten.
+#define APP_LINK_STATS_MAX_SAMPLES 4096
+
+// Coexistence (PTA) counters, in the layout of sl_bt_coex_get_counters
+typedef struct {
+  uint32_t low_pri_requested;
+  uint32_t high_pri_requested;
+  uint32_t low_pri_denied;
+  uint32_t high_pri_denied;
+  uint32_t low_pri_tx_abort;
+  uint32_t high_pri_tx_abort;
+} app_link_stats_coex_t;
+
+// Link layer counters of one report interval
+typedef struct {
+  int64_t time_us;       // end of the interval, monotonic clock
+  uint32_t interval_us;  // length of the interval
+  uint16_t tx_packets;
+  uint16_t rx_packets;
+  uint16_t crc_errors;
+  uint16_t failures;
+  float throughput_bps;  // application throughput, negative if not running
+  uint8_t coex_valid;    // true if coex holds the coex counter changes
+  app_link_stats_coex_t coex;
+} app_link_stats_sample_t;
+
+/***************************************************************************//**
+ * Add the counters of an interval. The totals include every sample, also
+ * the ones overwritten in the ring.
+ * @param[in] sample Interval counters.
+ ******************************************************************************/
+void app_link_stats_add(const app_link_stats_sample_t *sample);
+
+/***************************************************************************//**
+ * Get the number of samples in the ring.
+ * @return Number of samples, at most APP_LINK_STATS_MAX_SAMPLES.
+ ******************************************************************************/
+size_t app_link_stats_count(void);
+
+/***************************************************************************//**
+ * Get a sample from the ring.
+ * @param[in] index Index, 0 is the oldest sample kept.
+ * @return Sample.
+ ******************************************************************************/
+const app_link_stats_sample_t *app_link_stats_get(size_t index);
+
+/***************************************************************************//**
+ * Get the CRC error rate of a sample.
+ * @param[in] sample Sample.
+ * @return Percentage of received packets that failed the CRC check.
+ ******************************************************************************/
+double app_link_stats_crc_error_rate(const app_link_stats_sample_t *sample);
+
+/***************************************************************************//**
+ * Get the difference of two coex counter readings.
+ * @param[in] now Latest reading.
+ * @param[in] before Earlier reading.
+ * @param[out] delta Counter changes, wrapping counters are handled.
+ ******************************************************************************/
+void app_link_stats_coex_delta(const app_link_stats_coex_t *now,
+                               const app_link_stats_coex_t *before,
+                               app_link_stats_coex_t *delta);
+
+/***************************************************************************//**
+ * Print the counter totals.
+ ******************************************************************************/
+void app_link_stats_print_totals(void);
+
+/***************************************************************************//**
+ * Print the per-interval series and the CRC error rate percentiles. If coex
+ * counters were sampled, also print the deny and abort rates and how
+ * throughput relates to high priority denials.
+ ******************************************************************************/
+void app_link_stats_print(void);
+
+#endif // APP_LINK_STATS_H
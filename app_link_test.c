@@ -0,0 +1,312 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host to NCP link self-test and baud rate detection.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sl_bt_api.h"
+#include "sl_bt_ncp_host.h"
+#include "ncp_host.h"
+#include "app_async.h"
+#include "app_cust.h"
+#include "app_link_test.h"
+#include "app_shutdown.h"
+#include "app_stats.h"
+#include "app_time.h"
+
+// Messages of the round trip phase carry one byte.
+#define RTT_PAYLOAD_LEN 1u
+// BGAPI header plus the length byte of the user message.
+#define COMMAND_OVERHEAD (SL_BGAPI_MSG_HEADER_LEN + 1u)
+// BGAPI header plus result and length of the response.
+#define RESPONSE_OVERHEAD (SL_BGAPI_MSG_HEADER_LEN + 3u)
+// Start, 8 data and stop bits per byte on the UART.
+#define UART_BITS_PER_BYTE 10u
+// Approximate GATT write without response payload rates with data length
+// extension, bits per second.
+#define RADIO_1M_BPS 800000.0
+#define RADIO_2M_BPS 1400000.0
+
+// Wait for a hello response at each rate this long.
+#define PROBE_TIMEOUT_US 200000
+// Let the NCP drop a partial command received at a wrong rate.
+#define PROBE_GAP_US 100000
+#define PROBE_ATTEMPTS 2
+
+// Standard rates probed, highest first.
+static const uint32_t probe_rates[] = {
+  3000000, 2000000, 1000000, 921600, 460800, 230400, 115200, 57600
+};
+
+typedef struct {
+  uint32_t messages;
+  uint64_t tx_bytes;
+  uint64_t rx_bytes;
+  uint64_t payload_bytes;
+  int64_t elapsed_us;
+} phase_result_t;
+
+static uint64_t async_rx_bytes;
+
+static void on_async_response(sl_status_t result, const uint8_t *rsp,
+                              size_t rsp_len, void *ctx)
+{
+  (void)result;
+  (void)rsp;
+  (void)ctx;
+  // rsp_len covers the length byte and the payload
+  async_rx_bytes += RESPONSE_OVERHEAD - 1 + rsp_len;
+}
+
+static void print_phase(const char *name, const phase_result_t *r, uint32_t baud)
+{
+  double seconds = r->elapsed_us / 1e6;
+  double tx_rate = r->tx_bytes / seconds;
+  double rx_rate = r->rx_bytes / seconds;
+
+  printf("%-12s %6u messages in %8.1f ms: host->NCP %8.0f B/s, NCP->host %8.0f B/s, "
+         "payload %7.1f kbit/s",
+         name, r->messages, r->elapsed_us / 1000.0, tx_rate, rx_rate,
+         r->payload_bytes * 8 / seconds / 1000.0);
+  if (baud != 0) {
+    printf(", UART load %.0f%%",
+           100.0 * tx_rate * UART_BITS_PER_BYTE / baud);
+  }
+  printf("\n");
+}
+
+// Run the user message phases and print the verdict.
+sl_status_t app_link_test_run(uint16_t count, uint32_t baud)
+{
+  uint8_t payload[APP_CUST_MAX_PAYLOAD_LEN];
+  uint8_t params[1 + APP_CUST_MAX_PAYLOAD_LEN];
+  uint8_t rsp[APP_CUST_MAX_PAYLOAD_LEN];
+  size_t rsp_len;
+  double *rtt_ms;
+  phase_result_t sync_result = { 0 };
+  phase_result_t async_result = { 0 };
+  phase_result_t *best;
+  double payload_bps;
+  int64_t t0;
+  sl_status_t sc;
+  uint16_t rejected = 0;
+
+  if (count == 0) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  for (size_t i = 0; i < sizeof(payload); i++) {
+    payload[i] = (uint8_t)i;
+  }
+  rtt_ms = malloc(count * sizeof(*rtt_ms));
+  if (rtt_ms == NULL) {
+    return SL_STATUS_NO_MORE_RESOURCE;
+  }
+
+  // Round trip time of short messages
+  for (uint16_t i = 0; i < count; i++) {
+    if (app_shutdown_requested()) {
+      free(rtt_ms);
+      return SL_STATUS_ABORT;
+    }
+    t0 = app_time_mono_us();
+    sc = sl_bt_user_message_to_target(RTT_PAYLOAD_LEN, payload, sizeof(rsp), &rsp_len, rsp);
+    rtt_ms[i] = (app_time_mono_us() - t0) / 1000.0;
+    if (sc != SL_STATUS_OK) {
+      rejected++;
+    }
+  }
+  app_stats_sort(rtt_ms, count);
+  printf("Link self-test over %s", baud != 0 ? "UART" : "TCP");
+  if (baud != 0) {
+    printf(" at %u baud", baud);
+  }
+  printf(", %u messages per phase\n", count);
+  if (rejected == count) {
+    printf("  NCP has no user message handler, messages are answered with an error\n");
+  }
+  printf("Round trip   min %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+         rtt_ms[0], app_stats_percentile(rtt_ms, count, 50),
+         app_stats_percentile(rtt_ms, count, 99), rtt_ms[count - 1]);
+  free(rtt_ms);
+
+  // Bytes per second of full size messages, one at a time
+  t0 = app_time_mono_us();
+  for (uint16_t i = 0; i < count; i++) {
+    if (app_shutdown_requested()) {
+      return SL_STATUS_ABORT;
+    }
+    rsp_len = 0;
+    (void)sl_bt_user_message_to_target(sizeof(payload), payload, sizeof(rsp), &rsp_len, rsp);
+    sync_result.tx_bytes += COMMAND_OVERHEAD + sizeof(payload);
+    sync_result.rx_bytes += RESPONSE_OVERHEAD + rsp_len;
+  }
+  sync_result.elapsed_us = app_time_mono_us() - t0;
+  sync_result.messages = count;
+  sync_result.payload_bytes = (uint64_t)count * sizeof(payload);
+  print_phase("Synchronous", &sync_result, baud);
+  best = &sync_result;
+
+  // Same with --pipeline
+  if (app_async_depth() > 1) {
+    params[0] = (uint8_t)sizeof(payload);
+    memcpy(&params[1], payload, sizeof(payload));
+    async_rx_bytes = 0;
+    t0 = app_time_mono_us();
+    for (uint16_t i = 0; i < count; i++) {
+      if (app_shutdown_requested()) {
+        // let the submitted messages complete first
+        (void)app_async_barrier();
+        return SL_STATUS_ABORT;
+      }
+      sc = app_async_submit(sl_bt_cmd_user_message_to_target_id, params, sizeof(params),
+                            on_async_response, NULL);
+      if (sc != SL_STATUS_OK) {
+        return sc;
+      }
+    }
+    (void)app_async_barrier();
+    async_result.elapsed_us = app_time_mono_us() - t0;
+    async_result.messages = count;
+    async_result.tx_bytes = (uint64_t)count * (COMMAND_OVERHEAD + sizeof(payload));
+    async_result.rx_bytes = async_rx_bytes;
+    async_result.payload_bytes = (uint64_t)count * sizeof(payload);
+    print_phase("Pipelined", &async_result, baud);
+    if (async_result.elapsed_us < sync_result.elapsed_us) {
+      best = &async_result;
+    }
+  }
+
+  // Verdict
+  payload_bps = best->payload_bytes * 8 / (best->elapsed_us / 1e6);
+  if (baud != 0) {
+    printf("UART capacity %.1f kbit/s of frames per direction\n",
+           (double)baud * 8 / UART_BITS_PER_BYTE / 1000.0);
+  }
+  printf("Radio throughput reference: ~%.0f kbit/s on 1M PHY, ~%.0f kbit/s on 2M PHY\n",
+         RADIO_1M_BPS / 1000, RADIO_2M_BPS / 1000);
+  if (payload_bps < RADIO_1M_BPS) {
+    printf("Bottleneck: the NCP link (%.1f kbit/s) limits throughput tests on both PHYs\n",
+           payload_bps / 1000);
+  } else if (payload_bps < RADIO_2M_BPS) {
+    printf("Bottleneck: the NCP link (%.1f kbit/s) limits 2M PHY throughput tests, "
+           "1M PHY tests are radio bound\n", payload_bps / 1000);
+  } else {
+    printf("Bottleneck: the radio, the NCP link carries %.1f kbit/s\n", payload_bps / 1000);
+  }
+  if (baud != 0 && payload_bps < RADIO_2M_BPS) {
+    printf("Use a higher -b baud rate in the NCP firmware and the host to lift the limit\n");
+  }
+  return SL_STATUS_OK;
+}
+
+// Send a hello command and look for its response in the received bytes.
+static bool probe_hello(void)
+{
+  uint32_t cmd_header = sl_bt_cmd_system_hello_id;
+  uint32_t rsp_header = sl_bt_rsp_system_hello_id | (2u << 8);
+  uint8_t cmd[SL_BGAPI_MSG_HEADER_LEN];
+  uint8_t expect[SL_BGAPI_MSG_HEADER_LEN + 2];
+  uint8_t byte;
+  size_t matched = 0;
+  int64_t deadline_us;
+
+  for (size_t i = 0; i < SL_BGAPI_MSG_HEADER_LEN; i++) {
+    cmd[i] = (uint8_t)(cmd_header >> (8 * i));
+    expect[i] = (uint8_t)(rsp_header >> (8 * i));
+  }
+  expect[SL_BGAPI_MSG_HEADER_LEN] = 0; // result SL_STATUS_OK
+  expect[SL_BGAPI_MSG_HEADER_LEN + 1] = 0;
+
+  // discard anything left from an earlier rate
+  while (sl_bt_api_input_peek() > 0) {
+    (void)sl_bt_api_input(1, &byte);
+  }
+  sl_bt_api_output(sizeof(cmd), cmd);
+  deadline_us = app_time_mono_us() + PROBE_TIMEOUT_US;
+  while (app_time_mono_us() < deadline_us) {
+    if (sl_bt_api_input_peek() <= 0) {
+      usleep(1000);
+      continue;
+    }
+    if (sl_bt_api_input(1, &byte) != 1) {
+      return false;
+    }
+    if (byte == expect[matched]) {
+      matched++;
+      if (matched == sizeof(expect)) {
+        return true;
+      }
+    } else {
+      matched = (byte == expect[0]) ? 1 : 0;
+    }
+  }
+  return false;
+}
+
+static bool try_rate(uint32_t baud)
+{
+  char value[16];
+
+  ncp_host_deinit();
+  snprintf(value, sizeof(value), "%u", baud);
+  if (ncp_host_set_option('b', value) != SL_STATUS_OK
+      || ncp_host_init() != SL_STATUS_OK) {
+    return false; // rate not supported by the host
+  }
+  for (int attempt = 0; attempt < PROBE_ATTEMPTS; attempt++) {
+    if (app_shutdown_wait(PROBE_GAP_US)) {
+      return false;
+    }
+    if (probe_hello()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Find the baud rate the NCP answers at.
+sl_status_t app_link_test_detect_baud(uint32_t baud, uint32_t *found)
+{
+  if (try_rate(baud)) {
+    *found = baud;
+    return SL_STATUS_OK;
+  }
+  for (size_t i = 0; i < sizeof(probe_rates) / sizeof(probe_rates[0]); i++) {
+    if (app_shutdown_requested()) {
+      return SL_STATUS_ABORT;
+    }
+    if (probe_rates[i] != baud && try_rate(probe_rates[i])) {
+      *found = probe_rates[i];
+      return SL_STATUS_OK;
+    }
+  }
+  return app_shutdown_requested() ? SL_STATUS_ABORT : SL_STATUS_NOT_FOUND;
+}
@@ -0,0 +1,69 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host to NCP link self-test and baud rate detection.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_LINK_TEST_H
+#define APP_LINK_TEST_H
+
+#include <stdint.h>
+#include "sl_status.h"
+
+// Messages per phase of the self-test unless given.
+#define APP_LINK_TEST_COUNT_DEFAULT 200
+// Largest number of messages per phase.
+#define APP_LINK_TEST_MAX_COUNT 10000
+
+/***************************************************************************//**
+ * Measure the host to NCP link with user messages: the round trip time of
+ * short messages, and the bytes per second of full size messages, also
+ * pipelined if app_async_init() was called. The link rate is compared with
+ * the UART capacity and the radio throughput to tell which one limits
+ * throughput tests. An NCP without a user message handler answers with an
+ * error, which still measures the round trip; one that echoes the message
+ * also loads the NCP to host direction.
+ * @param[in] count Messages per phase.
+ * @param[in] baud UART baud rate, 0 for a TCP link.
+ * @return SL_STATUS_OK if the test ran. SL_STATUS_ABORT if a shutdown was
+ *   requested. Error code of the failed command otherwise.
+ ******************************************************************************/
+sl_status_t app_link_test_run(uint16_t count, uint32_t baud);
+
+/***************************************************************************//**
+ * Find the baud rate the NCP answers at. The serial port is reopened at the
+ * given rate first, then at the standard rates from the highest down, until
+ * the NCP responds to a hello command. Call after ncp_host_init(), before
+ * any transport wrappers are installed. The port is left open at the rate
+ * found.
+ * @param[in] baud Rate tried first.
+ * @param[out] found Rate the NCP answered at.
+ * @return SL_STATUS_OK if found. SL_STATUS_ABORT if a shutdown was
+ *   requested. SL_STATUS_NOT_FOUND otherwise.
+ ******************************************************************************/
+sl_status_t app_link_test_detect_baud(uint32_t baud, uint32_t *found);
+
+#endif // APP_LINK_TEST_H
@@ -0,0 +1,238 @@
+/***************************************************************************//**
+ * @file
+ * @brief Registry of named test metrics, exported as JSON Lines or Prometheus text.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "app_metrics.h"
+
+// Prefix of the Prometheus metric names.
+#define PROM_PREFIX "bletest_"
+
+typedef enum {
+  metric_counter,
+  metric_gauge
+} metric_type_t;
+
+typedef struct {
+  char name[APP_METRICS_MAX_NAME_LEN];
+  metric_type_t type;
+  double value;
+} metric_t;
+
+static metric_t metrics[APP_METRICS_MAX_COUNT];
+static size_t metric_count = 0;
+static bool metrics_enabled = false;
+static FILE *json_file = NULL;
+static const char *prom_path = NULL;
+static char prom_tmp_path[256];
+
+// Find a metric, adding it on first use.
+static metric_t *get_metric(const char *name, metric_type_t type)
+{
+  size_t i;
+
+  for (i = 0; i < metric_count; i++) {
+    if (strncmp(metrics[i].name, name, APP_METRICS_MAX_NAME_LEN - 1) == 0) {
+      return &metrics[i];
+    }
+  }
+  if (metric_count == APP_METRICS_MAX_COUNT) {
+    return NULL;
+  }
+  snprintf(metrics[metric_count].name, APP_METRICS_MAX_NAME_LEN, "%s", name);
+  metrics[metric_count].type = type;
+  metrics[metric_count].value = 0;
+  return &metrics[metric_count++];
+}
+
+// Enable metrics export.
+sl_status_t app_metrics_init(const char *json_path, const char *prom_file)
+{
+  if (json_path != NULL) {
+    if (strcmp(json_path, "-") == 0) {
+      // JSON Lines keep stdout, the human readable output moves to stderr
+      int json_fd;
+
+      fflush(stdout);
+      json_fd = dup(STDOUT_FILENO);
+      if (json_fd < 0) {
+        return SL_STATUS_FAIL;
+      }
+      json_file = fdopen(json_fd, "w");
+      if (json_file == NULL) {
+        close(json_fd);
+        return SL_STATUS_FAIL;
+      }
+      if (dup2(STDERR_FILENO, STDOUT_FILENO) < 0) {
+        fclose(json_file);
+        json_file = NULL;
+        return SL_STATUS_FAIL;
+      }
+    } else {
+      json_file = fopen(json_path, "w");
+      if (json_file == NULL) {
+        return SL_STATUS_FAIL;
+      }
+    }
+  }
+  if (prom_file != NULL) {
+    if (snprintf(prom_tmp_path, sizeof(prom_tmp_path), "%s.tmp", prom_file)
+        >= (int)sizeof(prom_tmp_path)) {
+      return SL_STATUS_INVALID_PARAMETER;
+    }
+    prom_path = prom_file;
+  }
+  metrics_enabled = (json_file != NULL || prom_path != NULL);
+  return SL_STATUS_OK;
+}
+
+// Check if metrics export is enabled.
+bool app_metrics_enabled(void)
+{
+  return metrics_enabled;
+}
+
+// Set the value of a counter.
+void app_metrics_set_counter(const char *name, double value)
+{
+  metric_t *metric;
+
+  if (metrics_enabled == false) {
+    return;
+  }
+  metric = get_metric(name, metric_counter);
+  if (metric != NULL) {
+    metric->value = value;
+  }
+}
+
+// Add to a counter.
+void app_metrics_add_counter(const char *name, double delta)
+{
+  metric_t *metric;
+
+  if (metrics_enabled == false) {
+    return;
+  }
+  metric = get_metric(name, metric_counter);
+  if (metric != NULL) {
+    metric->value += delta;
+  }
+}
+
+// Set the value of a gauge.
+void app_metrics_set_gauge(const char *name, double value)
+{
+  metric_t *metric;
+
+  if (metrics_enabled == false) {
+    return;
+  }
+  metric = get_metric(name, metric_gauge);
+  if (metric != NULL) {
+    metric->value = value;
+  }
+}
+
+static void export_json(const char *event)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_REALTIME, &now);
+  fprintf(json_file, "{\"time\":%lld.%03ld,\"event\":\"%s\"",
+          (long long)now.tv_sec, now.tv_nsec / 1000000, event);
+  for (size_t i = 0; i < metric_count; i++) {
+    // JSON has no NaN or infinity
+    if (isfinite(metrics[i].value)) {
+      fprintf(json_file, ",\"%s\":%.15g", metrics[i].name, metrics[i].value);
+    } else {
+      fprintf(json_file, ",\"%s\":null", metrics[i].name);
+    }
+  }
+  fprintf(json_file, "}\n");
+  fflush(json_file);
+}
+
+// Write to a temporary file and rename it, so the collector never reads a
+// partial file.
+static void export_prom(void)
+{
+  FILE *file = fopen(prom_tmp_path, "w");
+
+  if (file == NULL) {
+    return;
+  }
+  for (size_t i = 0; i < metric_count; i++) {
+    double value = metrics[i].value;
+
+    fprintf(file, "# TYPE " PROM_PREFIX "%s %s\n" PROM_PREFIX "%s ",
+            metrics[i].name,
+            (metrics[i].type == metric_counter) ? "counter" : "gauge",
+            metrics[i].name);
+    // Prometheus spells these NaN, +Inf and -Inf
+    if (isnan(value)) {
+      fprintf(file, "NaN\n");
+    } else if (isinf(value)) {
+      fprintf(file, "%cInf\n", (value > 0) ? '+' : '-');
+    } else {
+      fprintf(file, "%.15g\n", value);
+    }
+  }
+  if (fclose(file) == 0) {
+    rename(prom_tmp_path, prom_path);
+  }
+}
+
+// Export all metrics set so far.
+void app_metrics_export(const char *event)
+{
+  if (metrics_enabled == false) {
+    return;
+  }
+  if (json_file != NULL) {
+    export_json(event);
+  }
+  if (prom_path != NULL) {
+    export_prom();
+  }
+}
+
+// Close the outputs.
+void app_metrics_deinit(void)
+{
+  if (json_file != NULL) {
+    fclose(json_file);
+  }
+  json_file = NULL;
+  prom_path = NULL;
+  metrics_enabled = false;
+}
@@ -0,0 +1,96 @@
+/***************************************************************************//**
+ * @file
+ * @brief Registry of named test metrics, exported as JSON Lines or Prometheus text.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_METRICS_H
+#define APP_METRICS_H
+
+#include <stdbool.h>
+#include "sl_status.h"
+
+// Maximum number of distinct metrics.
+#define APP_METRICS_MAX_COUNT 64
+
+// Maximum length of a metric name without the prefix, including the
+// terminating zero. Longer names are truncated.
+#define APP_METRICS_MAX_NAME_LEN 48
+
+/***************************************************************************//**
+ * Enable metrics export. Without this call, the setters return immediately
+ * and nothing is formatted.
+ *
+ * @param[in] json_path File for JSON Lines output, "-" for stdout or NULL.
+ *   With "-", stdout is redirected to stderr, so that stdout only carries
+ *   JSON Lines.
+ * @param[in] prom_file Prometheus textfile collector file or NULL. The file
+ *   is replaced atomically on each export.
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ ******************************************************************************/
+sl_status_t app_metrics_init(const char *json_path, const char *prom_file);
+
+/***************************************************************************//**
+ * Check if metrics export is enabled.
+ * @return true if app_metrics_init() enabled at least one output.
+ ******************************************************************************/
+bool app_metrics_enabled(void);
+
+/***************************************************************************//**
+ * Set the value of a counter, for values read as totals from the NCP.
+ * @param[in] name Metric name without the bletest_ prefix. The name is
+ *   copied.
+ * @param[in] value Total value.
+ ******************************************************************************/
+void app_metrics_set_counter(const char *name, double value);
+
+/***************************************************************************//**
+ * Add to a counter.
+ * @param[in] name Metric name, as for app_metrics_set_counter().
+ * @param[in] delta Increment.
+ ******************************************************************************/
+void app_metrics_add_counter(const char *name, double delta);
+
+/***************************************************************************//**
+ * Set the value of a gauge.
+ * @param[in] name Metric name, as for app_metrics_set_counter().
+ * @param[in] value Current value.
+ ******************************************************************************/
+void app_metrics_set_gauge(const char *name, double value);
+
+/***************************************************************************//**
+ * Export all metrics set so far: one JSON line tagged with the event name,
+ * and a new Prometheus file.
+ * @param[in] event Reason of the export, e.g. "report" or "exit".
+ ******************************************************************************/
+void app_metrics_export(const char *event);
+
+/***************************************************************************//**
+ * Close the outputs.
+ ******************************************************************************/
+void app_metrics_deinit(void);
+
+#endif // APP_METRICS_H
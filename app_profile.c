@@ -0,0 +1,472 @@
+/***************************************************************************//**
+ * @file
+ * @brief BGAPI command latency and event rate profiler.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sl_bt_api.h"
+#include "sl_bt_ncp_host.h"
+#include "app_time.h"
+#include "app_profile.h"
+
+// Largest number of distinct command and event IDs tracked
+#define MAX_MSG_IDS 128
+// Largest number of commands waiting for a response
+#define MAX_PENDING 32
+// Latency histogram buckets, bucket b holds [2^b, 2^(b+1)) us
+#define HIST_BUCKETS 24
+// Message type bit of events in the header
+#define MSG_TYPE_EVENT 0x80
+#define NAME_LEN 64
+
+typedef struct {
+  uint32_t id;
+  bool is_event;
+  uint32_t count;
+  uint64_t bytes;
+  int64_t total_us;
+  int64_t min_us;
+  int64_t max_us;
+  uint32_t hist[HIST_BUCKETS];
+} msg_stats_t;
+
+typedef struct {
+  uint32_t id;
+  int64_t sent_us;
+  uint32_t bytes;
+} pending_t;
+
+// Tracks frame boundaries in a byte stream
+typedef struct {
+  uint8_t header[SL_BGAPI_MSG_HEADER_LEN];
+  uint32_t header_len;
+  uint32_t payload_left;
+} frame_parser_t;
+
+typedef struct {
+  uint32_t id;
+  const char *name;
+} msg_name_t;
+
+#define CMD_NAME(name) { sl_bt_cmd_##name##_id, #name }
+#define EVT_NAME(name) { sl_bt_evt_##name##_id, #name }
+
+// Commands: the response has the same ID as the command
+static const msg_name_t cmd_names[] = {
+  CMD_NAME(advertiser_create_set),
+  CMD_NAME(advertiser_delete_set),
+  CMD_NAME(advertiser_set_timing),
+  CMD_NAME(advertiser_set_tx_power),
+  CMD_NAME(advertiser_stop),
+  CMD_NAME(coex_get_counters),
+  CMD_NAME(coex_set_options),
+  CMD_NAME(connection_close),
+  CMD_NAME(connection_get_median_rssi),
+  CMD_NAME(connection_open),
+  CMD_NAME(connection_read_channel_map),
+  CMD_NAME(connection_set_default_parameters),
+  CMD_NAME(connection_set_preferred_phy),
+  CMD_NAME(extended_advertiser_set_data),
+  CMD_NAME(extended_advertiser_set_phy),
+  CMD_NAME(extended_advertiser_start),
+  CMD_NAME(gatt_discover_characteristics),
+  CMD_NAME(gatt_discover_primary_services_by_uuid),
+  CMD_NAME(gatt_server_find_attribute),
+  CMD_NAME(gatt_server_read_attribute_value),
+  CMD_NAME(gatt_write_characteristic_value),
+  CMD_NAME(gatt_write_characteristic_value_without_response),
+  CMD_NAME(gattdb_add_service),
+  CMD_NAME(gattdb_add_uuid128_characteristic),
+  CMD_NAME(gattdb_add_uuid16_characteristic),
+  CMD_NAME(gattdb_commit),
+  CMD_NAME(gattdb_new_session),
+  CMD_NAME(gattdb_start_service),
+  CMD_NAME(legacy_advertiser_set_data),
+  CMD_NAME(legacy_advertiser_start),
+  CMD_NAME(nvm_erase),
+  CMD_NAME(nvm_load),
+  CMD_NAME(nvm_save),
+  CMD_NAME(scanner_set_parameters),
+  CMD_NAME(scanner_start),
+  CMD_NAME(scanner_stop),
+  CMD_NAME(system_get_counters),
+  CMD_NAME(system_get_identity_address),
+  CMD_NAME(system_get_version),
+  CMD_NAME(system_hello),
+  CMD_NAME(system_set_identity_address),
+  CMD_NAME(system_set_lazy_soft_timer),
+  CMD_NAME(system_set_tx_power),
+  CMD_NAME(test_dtm_end),
+  CMD_NAME(test_dtm_rx),
+  CMD_NAME(test_dtm_tx_cw),
+  CMD_NAME(test_dtm_tx_v4),
+  CMD_NAME(user_message_to_target),
+};
+
+static const msg_name_t evt_names[] = {
+  EVT_NAME(connection_closed),
+  EVT_NAME(connection_opened),
+  EVT_NAME(connection_parameters),
+  EVT_NAME(connection_phy_status),
+  EVT_NAME(connection_remote_used_features),
+  EVT_NAME(connection_tx_power),
+  EVT_NAME(dfu_boot),
+  EVT_NAME(dfu_boot_failure),
+  EVT_NAME(gatt_characteristic),
+  EVT_NAME(gatt_characteristic_value),
+  EVT_NAME(gatt_mtu_exchanged),
+  EVT_NAME(gatt_procedure_completed),
+  EVT_NAME(gatt_server_attribute_value),
+  EVT_NAME(gatt_service),
+  EVT_NAME(scanner_extended_advertisement_report),
+  EVT_NAME(scanner_legacy_advertisement_report),
+  EVT_NAME(system_boot),
+  EVT_NAME(system_soft_timer),
+  EVT_NAME(test_dtm_completed),
+};
+
+static bool enabled = false;
+static unsigned top_count = APP_PROFILE_TOP_DEFAULT;
+static int64_t start_us;
+static int64_t frame_time_us;
+static frame_parser_t tx_parser;
+static frame_parser_t rx_parser;
+static pending_t pending[MAX_PENDING];
+static size_t pending_head = 0;
+static size_t pending_count = 0;
+static uint32_t unmatched_count = 0;
+static msg_stats_t stats[MAX_MSG_IDS];
+static size_t stats_count = 0;
+
+// Transport functions installed before app_profile_init().
+static tx_func next_output;
+static rx_func next_input;
+static rx_peek_func next_peek;
+
+static msg_stats_t *find_stats(uint32_t id, bool is_event)
+{
+  for (size_t i = 0; i < stats_count; i++) {
+    if (stats[i].id == id && stats[i].is_event == is_event) {
+      return &stats[i];
+    }
+  }
+  if (stats_count == MAX_MSG_IDS) {
+    return NULL;
+  }
+  memset(&stats[stats_count], 0, sizeof(stats[stats_count]));
+  stats[stats_count].id = id;
+  stats[stats_count].is_event = is_event;
+  return &stats[stats_count++];
+}
+
+static void record_latency(msg_stats_t *s, int64_t latency_us, uint32_t bytes)
+{
+  unsigned bucket = 0;
+
+  if (latency_us < 0) {
+    latency_us = 0;
+  }
+  for (int64_t v = latency_us; v > 1 && bucket < HIST_BUCKETS - 1; v >>= 1) {
+    bucket++;
+  }
+  if (s->count == 0 || latency_us < s->min_us) {
+    s->min_us = latency_us;
+  }
+  if (latency_us > s->max_us) {
+    s->max_us = latency_us;
+  }
+  s->count++;
+  s->bytes += bytes;
+  s->total_us += latency_us;
+  s->hist[bucket]++;
+}
+
+// A command left the host, queue it for its response.
+static void on_tx_header(uint32_t header)
+{
+  pending_t *p;
+  uint32_t id = SL_BGAPI_MSG_ID(header);
+
+  if (id == sl_bt_cmd_system_reset_id) {
+    return; // no response, the boot event follows
+  }
+  if (pending_count == MAX_PENDING) {
+    pending_head = (pending_head + 1) % MAX_PENDING;
+    pending_count--;
+    unmatched_count++;
+  }
+  p = &pending[(pending_head + pending_count) % MAX_PENDING];
+  p->id = id;
+  p->sent_us = frame_time_us;
+  p->bytes = SL_BGAPI_MSG_HEADER_LEN + SL_BGAPI_MSG_LEN(header);
+  pending_count++;
+}
+
+// A response or event arrived, match responses with the oldest command of
+// the same ID. Commands skipped over never got their response.
+static void on_rx_header(uint32_t header)
+{
+  msg_stats_t *s;
+  uint32_t id = SL_BGAPI_MSG_ID(header);
+  uint32_t bytes = SL_BGAPI_MSG_HEADER_LEN + SL_BGAPI_MSG_LEN(header);
+
+  if (header & MSG_TYPE_EVENT) {
+    if (id == sl_bt_evt_system_boot_id) {
+      unmatched_count += pending_count;
+      pending_count = 0;
+    }
+    s = find_stats(id, true);
+    if (s != NULL) {
+      s->count++;
+      s->bytes += bytes;
+    }
+    return;
+  }
+  for (size_t i = 0; i < pending_count; i++) {
+    pending_t *p = &pending[(pending_head + i) % MAX_PENDING];
+    if (p->id != id) {
+      continue;
+    }
+    s = find_stats(id, false);
+    if (s != NULL) {
+      record_latency(s, frame_time_us - p->sent_us, p->bytes + bytes);
+    }
+    unmatched_count += i;
+    pending_head = (pending_head + i + 1) % MAX_PENDING;
+    pending_count -= i + 1;
+    return;
+  }
+  unmatched_count++;
+}
+
+// Feed transport bytes to a parser, calling on_header for each frame.
+static void parse_stream(frame_parser_t *parser,
+                         const uint8_t *data,
+                         uint32_t len,
+                         void (*on_header)(uint32_t header))
+{
+  uint32_t header;
+  uint32_t skip;
+
+  while (len > 0) {
+    if (parser->payload_left > 0) {
+      skip = (len < parser->payload_left) ? len : parser->payload_left;
+      parser->payload_left -= skip;
+      data += skip;
+      len -= skip;
+      continue;
+    }
+    parser->header[parser->header_len++] = *data++;
+    len--;
+    if (parser->header_len == SL_BGAPI_MSG_HEADER_LEN) {
+      header = (uint32_t)parser->header[0]
+               | ((uint32_t)parser->header[1] << 8)
+               | ((uint32_t)parser->header[2] << 16)
+               | ((uint32_t)parser->header[3] << 24);
+      parser->header_len = 0;
+      parser->payload_left = SL_BGAPI_MSG_LEN(header);
+      on_header(header);
+    }
+  }
+}
+
+static void profile_tx(uint32_t len, uint8_t *data)
+{
+  frame_time_us = app_time_mono_us();
+  parse_stream(&tx_parser, data, len, on_tx_header);
+  next_output(len, data);
+}
+
+static int32_t profile_rx(uint32_t len, uint8_t *data)
+{
+  int32_t ret = next_input(len, data);
+
+  if (ret > 0) {
+    frame_time_us = app_time_mono_us();
+    parse_stream(&rx_parser, data, (uint32_t)ret, on_rx_header);
+  }
+  return ret;
+}
+
+static int32_t profile_peek(void)
+{
+  return next_peek();
+}
+
+static void print_at_exit(void)
+{
+  app_profile_print();
+}
+
+// Start profiling the BGAPI traffic.
+void app_profile_init(unsigned top_n)
+{
+  top_count = top_n;
+  start_us = app_time_mono_us();
+  if (enabled == false) {
+    next_output = sl_bt_api_output;
+    next_input = sl_bt_api_input;
+    next_peek = sl_bt_api_input_peek;
+    sl_bt_api_initialize_nonblock(profile_tx, profile_rx, profile_peek);
+    atexit(print_at_exit);
+  }
+  enabled = true;
+}
+
+// Check if profiling is active.
+bool app_profile_enabled(void)
+{
+  return enabled;
+}
+
+static const char *msg_name(const msg_stats_t *s, char *buf, size_t size)
+{
+  const msg_name_t *names = s->is_event ? evt_names : cmd_names;
+  size_t count = s->is_event ? sizeof(evt_names) / sizeof(evt_names[0])
+                 : sizeof(cmd_names) / sizeof(cmd_names[0]);
+
+  for (size_t i = 0; i < count; i++) {
+    if (names[i].id == s->id) {
+      return names[i].name;
+    }
+  }
+  snprintf(buf, size, "0x%08x", (unsigned)s->id);
+  return buf;
+}
+
+// Upper bound of the histogram bucket holding the percentile, capped to max.
+static int64_t hist_percentile(const msg_stats_t *s, double percentile)
+{
+  uint32_t rank = (uint32_t)(percentile / 100.0 * s->count + 0.5);
+  uint32_t seen = 0;
+  int64_t upper;
+
+  if (rank == 0) {
+    rank = 1;
+  }
+  for (unsigned b = 0; b < HIST_BUCKETS; b++) {
+    seen += s->hist[b];
+    if (seen >= rank) {
+      upper = (int64_t)1 << (b + 1);
+      return (upper < s->max_us) ? upper : s->max_us;
+    }
+  }
+  return s->max_us;
+}
+
+static int compare_total(const void *a, const void *b)
+{
+  const msg_stats_t *sa = *(const msg_stats_t * const *)a;
+  const msg_stats_t *sb = *(const msg_stats_t * const *)b;
+
+  return (sb->total_us > sa->total_us) - (sb->total_us < sa->total_us);
+}
+
+static int compare_count(const void *a, const void *b)
+{
+  const msg_stats_t *sa = *(const msg_stats_t * const *)a;
+  const msg_stats_t *sb = *(const msg_stats_t * const *)b;
+
+  return (sb->count > sa->count) - (sb->count < sa->count);
+}
+
+// Print the profile tables.
+void app_profile_print(void)
+{
+  msg_stats_t *cmds[MAX_MSG_IDS];
+  msg_stats_t *evts[MAX_MSG_IDS];
+  size_t cmd_count = 0, evt_count = 0;
+  uint64_t calls = 0, events = 0;
+  int64_t busy_us = 0;
+  double elapsed_s;
+  char buf[NAME_LEN];
+
+  if (enabled == false) {
+    return;
+  }
+  elapsed_s = (app_time_mono_us() - start_us) / 1e6;
+  if (elapsed_s <= 0) {
+    elapsed_s = 1e-6;
+  }
+  for (size_t i = 0; i < stats_count; i++) {
+    if (stats[i].is_event) {
+      evts[evt_count++] = &stats[i];
+      events += stats[i].count;
+    } else {
+      cmds[cmd_count++] = &stats[i];
+      calls += stats[i].count;
+      busy_us += stats[i].total_us;
+    }
+  }
+  qsort(cmds, cmd_count, sizeof(cmds[0]), compare_total);
+  qsort(evts, evt_count, sizeof(evts[0]), compare_count);
+
+  printf("\nBGAPI profile over %.1f s: %llu commands, %.1f ms waiting for responses (%.1f%%), "
+         "%llu events (%.1f/s)\n",
+         elapsed_s, (unsigned long long)calls, busy_us / 1e3,
+         100.0 * busy_us / 1e6 / elapsed_s, (unsigned long long)events,
+         events / elapsed_s);
+  if (unmatched_count != 0) {
+    printf("  %u commands or responses could not be matched\n", unmatched_count);
+  }
+  if (cmd_count > 0) {
+    printf("Top %u commands by total latency:\n", top_count);
+    printf("  %-48s %8s %10s %9s %9s %9s %9s %9s %6s\n", "command", "calls",
+           "total[ms]", "mean[us]", "min[us]", "p50[us]", "p99[us]", "max[us]",
+           "bytes");
+    for (size_t i = 0; i < cmd_count && i < top_count; i++) {
+      msg_stats_t *s = cmds[i];
+      printf("  %-48s %8u %10.1f %9.0f %9lld %9lld %9lld %9lld %6.0f\n",
+             msg_name(s, buf, sizeof(buf)), s->count, s->total_us / 1e3,
+             (double)s->total_us / s->count, (long long)s->min_us,
+             (long long)hist_percentile(s, 50), (long long)hist_percentile(s, 99),
+             (long long)s->max_us, (double)s->bytes / s->count);
+    }
+    printf("Latency histograms (calls per bucket, <upper bound in us):\n");
+    for (size_t i = 0; i < cmd_count && i < top_count; i++) {
+      printf("  %s\n   ", msg_name(cmds[i], buf, sizeof(buf)));
+      for (unsigned b = 0; b < HIST_BUCKETS; b++) {
+        if (cmds[i]->hist[b] != 0) {
+          printf(" <%lld:%u", (long long)1 << (b + 1), cmds[i]->hist[b]);
+        }
+      }
+      printf("\n");
+    }
+  }
+  if (evt_count > 0) {
+    printf("Top %u events by rate:\n", top_count);
+    printf("  %-48s %8s %10s %6s\n", "event", "count", "rate[1/s]", "bytes");
+    for (size_t i = 0; i < evt_count && i < top_count; i++) {
+      msg_stats_t *s = evts[i];
+      printf("  %-48s %8u %10.1f %6.0f\n", msg_name(s, buf, sizeof(buf)),
+             s->count, s->count / elapsed_s, (double)s->bytes / s->count);
+    }
+  }
+  fflush(stdout);
+}
@@ -0,0 +1,59 @@
+/***************************************************************************//**
+ * @file
+ * @brief BGAPI command latency and event rate profiler.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_PROFILE_H
+#define APP_PROFILE_H
+
+#include <stdbool.h>
+
+// Number of rows printed by default in each table.
+#define APP_PROFILE_TOP_DEFAULT 10
+
+/***************************************************************************//**
+ * Start profiling the BGAPI traffic. The NCP transport functions are wrapped
+ * to time each command from its transmission to its response, and to count
+ * the events by ID. The profile is printed when the process exits.
+ * Call after ncp_host_init().
+ * @param[in] top_n Number of commands and events printed.
+ ******************************************************************************/
+void app_profile_init(unsigned top_n);
+
+/***************************************************************************//**
+ * Check if profiling is active.
+ * @return true if app_profile_init() was called.
+ ******************************************************************************/
+bool app_profile_enabled(void);
+
+/***************************************************************************//**
+ * Print the commands with the highest total latency, with their latency
+ * histograms, and the events with the highest rate.
+ ******************************************************************************/
+void app_profile_print(void);
+
+#endif // APP_PROFILE_H
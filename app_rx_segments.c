@@ -0,0 +1,152 @@
+/***************************************************************************//**
+ * @file
+ * @brief Packet count series of segmented DTM receive tests.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include "app_metrics.h"
+#include "app_rx_segments.h"
+#include "app_stats.h"
+
+static app_rx_segment_t segments[APP_RX_SEGMENTS_MAX];
+static size_t segment_head = 0;   // next slot to write
+static size_t segment_count = 0;
+static uint32_t total_segments = 0;
+static uint64_t total_packets = 0;
+static uint64_t total_rx_us = 0;
+static uint64_t total_gap_us = 0;
+static uint32_t max_gap_us = 0;
+static int64_t first_time_us = 0;
+
+// Add a segment.
+void app_rx_segments_add(const app_rx_segment_t *segment)
+{
+  if (total_segments == 0) {
+    first_time_us = segment->time_us;
+  }
+  segments[segment_head] = *segment;
+  segment_head = (segment_head + 1) % APP_RX_SEGMENTS_MAX;
+  if (segment_count < APP_RX_SEGMENTS_MAX) {
+    segment_count++;
+  }
+  total_segments++;
+  total_packets += segment->packets;
+  total_rx_us += segment->rx_us;
+  total_gap_us += segment->gap_us;
+  if (segment->gap_us > max_gap_us) {
+    max_gap_us = segment->gap_us;
+  }
+}
+
+// Get the number of segments in the ring.
+size_t app_rx_segments_count(void)
+{
+  return segment_count;
+}
+
+// Get a segment from the ring, 0 is the oldest.
+const app_rx_segment_t *app_rx_segments_get(size_t index)
+{
+  size_t oldest = (segment_head + APP_RX_SEGMENTS_MAX - segment_count)
+                  % APP_RX_SEGMENTS_MAX;
+
+  return &segments[(oldest + index) % APP_RX_SEGMENTS_MAX];
+}
+
+// Get the packet rate of a segment over its receive time.
+double app_rx_segments_rate(const app_rx_segment_t *segment)
+{
+  if (segment->rx_us == 0) {
+    return 0;
+  }
+  return segment->packets * 1e6 / segment->rx_us;
+}
+
+// Mean rate over the receive time of all segments.
+static double mean_rate(void)
+{
+  return total_rx_us ? total_packets * 1e6 / total_rx_us : 0;
+}
+
+// Set the segment metrics.
+void app_rx_segments_publish(void)
+{
+  if (total_segments == 0) {
+    return;
+  }
+  app_metrics_set_counter("dtm_rx_segments", total_segments);
+  app_metrics_set_counter("dtm_rx_packets", total_packets);
+  app_metrics_set_gauge("dtm_rx_rate_pps", mean_rate());
+  app_metrics_set_gauge("dtm_rx_gap_mean_ms", total_gap_us / 1000.0 / total_segments);
+  app_metrics_set_gauge("dtm_rx_gap_max_ms", max_gap_us / 1000.0);
+}
+
+// Print the series and statistics.
+void app_rx_segments_print(void)
+{
+  static double rates[APP_RX_SEGMENTS_MAX];
+  static double times[APP_RX_SEGMENTS_MAX];
+  const app_rx_segment_t *segment;
+  double mean = mean_rate();
+  double r;
+
+  if (segment_count == 0) {
+    return;
+  }
+  printf("\nDTM receive segments");
+  if (total_segments > segment_count) {
+    printf(" (last %zu of %u)", segment_count, total_segments);
+  }
+  printf(":\n   time[s]   RX[ms]  gap[ms]  packets  packets/s  vs mean[%%]\n");
+  for (size_t i = 0; i < segment_count; i++) {
+    segment = app_rx_segments_get(i);
+    times[i] = (segment->time_us - first_time_us) / 1e6;
+    rates[i] = app_rx_segments_rate(segment);
+    printf("%10.3f %8.1f %8.2f %8u %10.1f %11.1f\n",
+           times[i], segment->rx_us / 1000.0, segment->gap_us / 1000.0,
+           segment->packets, rates[i],
+           mean > 0 ? 100.0 * (rates[i] - mean) / mean : 0);
+  }
+  // trend before the rates are sorted
+  if (app_stats_pearson(times, rates, segment_count, &r) == 0) {
+    printf("Rate trend over time: r=%.2f%s\n", r,
+           fabs(r) >= 0.5 ? (r > 0 ? " (rising)" : " (falling)") : "");
+  }
+  app_stats_sort(rates, segment_count);
+  printf("Packets/s over %zu segments: min=%.1f p5=%.1f p50=%.1f p95=%.1f max=%.1f\n",
+         segment_count, rates[0],
+         app_stats_percentile(rates, segment_count, 5),
+         app_stats_percentile(rates, segment_count, 50),
+         app_stats_percentile(rates, segment_count, 95),
+         rates[segment_count - 1]);
+  printf("Total: %llu packets in %u segments, receiver on %.3f s, restart gaps %.3f s "
+         "(mean %.2f ms, max %.2f ms), %.1f packets/s with the gaps subtracted\n",
+         (unsigned long long)total_packets, total_segments,
+         total_rx_us / 1e6, total_gap_us / 1e6,
+         total_gap_us / 1000.0 / total_segments, max_gap_us / 1000.0, mean);
+}
@@ -0,0 +1,86 @@
+/***************************************************************************//**
+ * @file
+ * @brief Packet count series of segmented DTM receive tests.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_RX_SEGMENTS_H
+#define APP_RX_SEGMENTS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Number of segments kept. Older segments are overwritten.
+#define APP_RX_SEGMENTS_MAX 4096
+
+// One DTM receive segment
+typedef struct {
+  int64_t time_us;   // receiver started, monotonic clock
+  uint32_t rx_us;    // receiver on, from the start to the end command
+  uint32_t gap_us;   // receiver off before this segment while DTM restarted
+  uint16_t packets;  // packets received in the segment
+} app_rx_segment_t;
+
+/***************************************************************************//**
+ * Add a segment. The totals include every segment, also the ones
+ * overwritten in the ring.
+ * @param[in] segment Segment counters.
+ ******************************************************************************/
+void app_rx_segments_add(const app_rx_segment_t *segment);
+
+/***************************************************************************//**
+ * Get the number of segments in the ring.
+ * @return Number of segments, at most APP_RX_SEGMENTS_MAX.
+ ******************************************************************************/
+size_t app_rx_segments_count(void);
+
+/***************************************************************************//**
+ * Get a segment from the ring.
+ * @param[in] index Index, 0 is the oldest segment kept.
+ * @return Segment.
+ ******************************************************************************/
+const app_rx_segment_t *app_rx_segments_get(size_t index);
+
+/***************************************************************************//**
+ * Get the packet rate of a segment over the time the receiver was on, so the
+ * restart gaps don't lower it.
+ * @param[in] segment Segment.
+ * @return Packets per second.
+ ******************************************************************************/
+double app_rx_segments_rate(const app_rx_segment_t *segment);
+
+/***************************************************************************//**
+ * Set the segment totals and rate statistics as metrics.
+ ******************************************************************************/
+void app_rx_segments_publish(void);
+
+/***************************************************************************//**
+ * Print the per-segment series, the rate percentiles and trend, and the
+ * totals with the time lost to restarts.
+ ******************************************************************************/
+void app_rx_segments_print(void);
+
+#endif // APP_RX_SEGMENTS_H
@@ -0,0 +1,206 @@
+/***************************************************************************//**
+ * @file
+ * @brief Link encryption latency and throughput by security level.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "app_metrics.h"
+#include "app_security.h"
+
+typedef struct {
+  uint32_t count;
+  double sum_ms;
+  double min_ms;
+  double max_ms;
+} latency_t;
+
+typedef struct {
+  uint64_t bytes;
+  int64_t elapsed_us;
+} throughput_t;
+
+static const char *mode_names[APP_SECURITY_MODES] = {
+  "no encryption",
+  "unauthenticated encryption",
+  "authenticated encryption",
+  "authenticated LE Secure Connections"
+};
+
+static int64_t opened_us = 0;
+static bool bonded_peer = false; // the peer was bonded when the connection opened
+static uint8_t current_mode = 0;
+static latency_t pairing;        // connection opened to encrypted, new pairing
+static latency_t bonding;        // connection opened to keys stored
+static latency_t reconnect;      // connection opened to encrypted, bonded peer
+static uint32_t failures = 0;
+static uint16_t last_failure = 0;
+static throughput_t throughput[APP_SECURITY_MODES];
+
+// Add a latency sample.
+static void latency_add(latency_t *latency, int64_t us)
+{
+  double ms = us / 1000.0;
+
+  if (latency->count == 0 || ms < latency->min_ms) {
+    latency->min_ms = ms;
+  }
+  if (latency->count == 0 || ms > latency->max_ms) {
+    latency->max_ms = ms;
+  }
+  latency->sum_ms += ms;
+  latency->count++;
+}
+
+// Print a latency line, if any samples.
+static void latency_print(const char *name, const latency_t *latency)
+{
+  if (latency->count == 0) {
+    return;
+  }
+  printf("  %-30s %3u  %8.1f  %8.1f  %8.1f\n", name, latency->count,
+         latency->min_ms, latency->sum_ms / latency->count, latency->max_ms);
+}
+
+// Start timing a connection.
+void app_security_on_opened(uint8_t bonding_handle, int64_t time_us)
+{
+  opened_us = time_us;
+  bonded_peer = (bonding_handle != APP_SECURITY_NO_BOND);
+  current_mode = 0;
+}
+
+// Note the security mode.
+bool app_security_on_mode(uint8_t security_mode, int64_t time_us)
+{
+  bool encrypted = (current_mode == 0 && security_mode != 0);
+
+  if (security_mode >= APP_SECURITY_MODES) {
+    security_mode = APP_SECURITY_MODES - 1;
+  }
+  current_mode = security_mode;
+  if (encrypted) {
+    latency_add(bonded_peer ? &reconnect : &pairing, time_us - opened_us);
+    printf("Link encrypted with %s after %.1f ms%s\n", mode_names[security_mode],
+           (time_us - opened_us) / 1000.0, bonded_peer ? " (bonded peer)" : "");
+  }
+  return encrypted;
+}
+
+// Note the end of pairing.
+void app_security_on_bonded(uint8_t bonding_handle, int64_t time_us)
+{
+  if (bonding_handle == APP_SECURITY_NO_BOND) {
+    printf("Paired without bonding after %.1f ms\n", (time_us - opened_us) / 1000.0);
+    return;
+  }
+  latency_add(&bonding, time_us - opened_us);
+  printf("Bonded, handle %u, after %.1f ms\n", bonding_handle,
+         (time_us - opened_us) / 1000.0);
+}
+
+// Count a failed pairing.
+void app_security_on_failed(uint16_t reason)
+{
+  failures++;
+  last_failure = reason;
+}
+
+// Get the current security mode.
+uint8_t app_security_mode(void)
+{
+  return current_mode;
+}
+
+// Get the name of a security mode.
+const char *app_security_mode_name(uint8_t security_mode)
+{
+  return (security_mode < APP_SECURITY_MODES) ? mode_names[security_mode] : "unknown";
+}
+
+// Add throughput data.
+void app_security_add_throughput(uint64_t bytes, int64_t elapsed_us)
+{
+  if (elapsed_us <= 0) {
+    return;
+  }
+  throughput[current_mode].bytes += bytes;
+  throughput[current_mode].elapsed_us += elapsed_us;
+}
+
+// Get the mean throughput at a security mode, in bits per second.
+static double throughput_bps(uint8_t security_mode)
+{
+  const throughput_t *t = &throughput[security_mode];
+
+  return (t->elapsed_us > 0) ? t->bytes * 8e6 / t->elapsed_us : 0;
+}
+
+// Set the metrics.
+void app_security_publish(void)
+{
+  if (pairing.count != 0) {
+    app_metrics_set_gauge("pairing_latency_ms", pairing.sum_ms / pairing.count);
+  }
+  if (bonding.count != 0) {
+    app_metrics_set_gauge("bonding_latency_ms", bonding.sum_ms / bonding.count);
+  }
+  if (reconnect.count != 0) {
+    app_metrics_set_gauge("bonded_reconnect_latency_ms", reconnect.sum_ms / reconnect.count);
+  }
+  app_metrics_set_counter("pairing_failures", failures);
+  app_metrics_set_gauge("link_security_mode", current_mode + 1);
+  for (uint8_t i = 0; i < APP_SECURITY_MODES; i++) {
+    if (throughput[i].elapsed_us > 0) {
+      char name[32];
+      snprintf(name, sizeof(name), "throughput_level%u_bps", i + 1);
+      app_metrics_set_gauge(name, throughput_bps(i));
+    }
+  }
+}
+
+// Print the latencies and the throughput by security mode.
+void app_security_print(void)
+{
+  if (pairing.count != 0 || bonding.count != 0 || reconnect.count != 0) {
+    printf("Link encryption latency from connection opened [ms]:\n");
+    printf("  %-30s %3s  %8s  %8s  %8s\n", "", "n", "min", "mean", "max");
+    latency_print("pairing to encrypted", &pairing);
+    latency_print("pairing to bonded", &bonding);
+    latency_print("bonded reconnect to encrypted", &reconnect);
+  }
+  if (failures != 0) {
+    printf("Pairing failed %u times, last reason 0x%04x\n", failures, last_failure);
+  }
+  for (uint8_t i = 0; i < APP_SECURITY_MODES; i++) {
+    if (throughput[i].elapsed_us <= 0) {
+      continue;
+    }
+    printf("Throughput with %s (level %u): %.2f bps over %.1f s\n", mode_names[i], i + 1,
+           throughput_bps(i), throughput[i].elapsed_us / 1e6);
+  }
+}
@@ -0,0 +1,103 @@
+/***************************************************************************//**
+ * @file
+ * @brief Link encryption latency and throughput by security level.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_SECURITY_H
+#define APP_SECURITY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Security modes reported by the connection parameters event, mode 1 level
+// 1 to 4.
+#define APP_SECURITY_MODES 4
+// Bonding handle of a connection without a bond.
+#define APP_SECURITY_NO_BOND 0xFF
+
+/***************************************************************************//**
+ * Start timing a new connection.
+ * @param[in] bonding Bonding handle of the peer from the connection opened
+ *   event, APP_SECURITY_NO_BOND if not bonded.
+ * @param[in] time_us Monotonic time of the connection opened event.
+ ******************************************************************************/
+void app_security_on_opened(uint8_t bonding, int64_t time_us);
+
+/***************************************************************************//**
+ * Note the security mode of the connection.
+ * @param[in] security_mode Security mode from the connection parameters event.
+ * @param[in] time_us Monotonic time of the event.
+ * @return true if the connection was just encrypted.
+ ******************************************************************************/
+bool app_security_on_mode(uint8_t security_mode, int64_t time_us);
+
+/***************************************************************************//**
+ * Note the end of pairing.
+ * @param[in] bonding Bonding handle, APP_SECURITY_NO_BOND if the keys were
+ *   not stored.
+ * @param[in] time_us Monotonic time of the bonded event.
+ ******************************************************************************/
+void app_security_on_bonded(uint8_t bonding, int64_t time_us);
+
+/***************************************************************************//**
+ * Count a failed pairing.
+ * @param[in] reason Failure reason.
+ ******************************************************************************/
+void app_security_on_failed(uint16_t reason);
+
+/***************************************************************************//**
+ * Get the security mode of the current connection.
+ * @return Security mode, 0 (no encryption) to APP_SECURITY_MODES - 1.
+ ******************************************************************************/
+uint8_t app_security_mode(void);
+
+/***************************************************************************//**
+ * Get the name of a security mode.
+ * @param[in] security_mode Security mode.
+ * @return Name.
+ ******************************************************************************/
+const char *app_security_mode_name(uint8_t security_mode);
+
+/***************************************************************************//**
+ * Add throughput data at the security mode of the current connection.
+ * @param[in] bytes Bytes transferred.
+ * @param[in] elapsed_us Time taken.
+ ******************************************************************************/
+void app_security_add_throughput(uint64_t bytes, int64_t elapsed_us);
+
+/***************************************************************************//**
+ * Set the latency and throughput metrics.
+ ******************************************************************************/
+void app_security_publish(void);
+
+/***************************************************************************//**
+ * Print the pairing and reconnect latencies and the throughput at each
+ * security mode.
+ ******************************************************************************/
+void app_security_print(void);
+
+#endif // APP_SECURITY_H
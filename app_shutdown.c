@@ -0,0 +1,151 @@
+/***************************************************************************//**
+ * @file
+ * @brief Signal safe shutdown requests and shutdown latency.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "app_shutdown.h"
+#include "app_time.h"
+
+static const char forced_exit_msg[] = "\nForced exit\n";
+
+// Readable once a shutdown is requested, never drained.
+static int pipe_fds[2] = { -1, -1 };
+static volatile sig_atomic_t requests;
+// Written by the signal handler before requests is raised.
+static struct timespec request_time;
+static int64_t request_us;
+static int64_t teardown_start_us;
+
+// Open the wakeup pipe.
+sl_status_t app_shutdown_init(void)
+{
+  if (pipe(pipe_fds) != 0) {
+    return SL_STATUS_FAIL;
+  }
+  for (int i = 0; i < 2; i++) {
+    (void)fcntl(pipe_fds[i], F_SETFL, fcntl(pipe_fds[i], F_GETFL) | O_NONBLOCK);
+    (void)fcntl(pipe_fds[i], F_SETFD, FD_CLOEXEC);
+  }
+  return SL_STATUS_OK;
+}
+
+// Record a shutdown request, called from signal handlers.
+void app_shutdown_request(void)
+{
+  static const uint8_t wakeup = 1;
+
+  if (requests != 0) {
+    // the teardown is stuck or too slow for the user
+    (void)write(STDOUT_FILENO, forced_exit_msg, sizeof(forced_exit_msg) - 1);
+    _exit(EXIT_FAILURE);
+  }
+  (void)clock_gettime(CLOCK_MONOTONIC, &request_time);
+  requests = 1;
+  (void)write(pipe_fds[1], &wakeup, sizeof(wakeup));
+}
+
+// Check for a shutdown request.
+bool app_shutdown_requested(void)
+{
+  return requests != 0;
+}
+
+// Sleep until the timeout or a shutdown request.
+bool app_shutdown_wait(int64_t timeout_us)
+{
+  struct pollfd pfd = { .fd = pipe_fds[0], .events = POLLIN };
+  int64_t end_us = app_time_mono_us() + timeout_us;
+  int64_t left_us;
+  int timeout_ms = -1;
+
+  while (requests == 0) {
+    if (timeout_us >= 0) {
+      left_us = end_us - app_time_mono_us();
+      if (left_us <= 0) {
+        return false;
+      }
+      timeout_ms = (int)((left_us + 999) / 1000);
+    }
+    // woken up by the pipe even if the signal came before the call
+    (void)poll(&pfd, 1, timeout_ms);
+  }
+  return true;
+}
+
+// Sleep until a file descriptor is readable or a shutdown request.
+bool app_shutdown_wait_readable(int fd)
+{
+  struct pollfd pfds[2] = {
+    { .fd = pipe_fds[0], .events = POLLIN },
+    { .fd = fd, .events = POLLIN }
+  };
+
+  while (requests == 0) {
+    // end of file and errors are left to the read
+    if (poll(pfds, 2, -1) > 0 && pfds[1].revents != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Mark the start of the teardown.
+void app_shutdown_begin(void)
+{
+  teardown_start_us = app_time_mono_us();
+  if (requests != 0) {
+    request_us = (int64_t)request_time.tv_sec * 1000000 + request_time.tv_nsec / 1000;
+  } else {
+    // test ended on its own
+    request_us = teardown_start_us;
+  }
+}
+
+// Print the shutdown latency.
+void app_shutdown_print(void)
+{
+  int64_t end_us = app_time_mono_us();
+
+  if (teardown_start_us == 0) {
+    return;
+  }
+  if (requests != 0) {
+    printf("Shutdown took %.1f ms: %.1f ms until the main loop, %.1f ms teardown\n",
+           (end_us - request_us) / 1000.0,
+           (teardown_start_us - request_us) / 1000.0,
+           (end_us - teardown_start_us) / 1000.0);
+  } else {
+    printf("Teardown took %.1f ms\n", (end_us - teardown_start_us) / 1000.0);
+  }
+}
@@ -0,0 +1,82 @@
+/***************************************************************************//**
+ * @file
+ * @brief Signal safe shutdown requests and shutdown latency.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_SHUTDOWN_H
+#define APP_SHUTDOWN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sl_status.h"
+
+/***************************************************************************//**
+ * Open the pipe that wakes up waits when a shutdown is requested. Call before
+ * the signal handlers are installed.
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ ******************************************************************************/
+sl_status_t app_shutdown_init(void);
+
+/***************************************************************************//**
+ * Request a shutdown. Async-signal-safe: only records the time and writes to
+ * the pipe, the main loop does the teardown. A second request while the
+ * first one is pending exits the process at once.
+ ******************************************************************************/
+void app_shutdown_request(void);
+
+/***************************************************************************//**
+ * Check for a shutdown request.
+ * @return true if a shutdown was requested.
+ ******************************************************************************/
+bool app_shutdown_requested(void);
+
+/***************************************************************************//**
+ * Sleep until the timeout or a shutdown request, whichever comes first.
+ * @param[in] timeout_us Time to sleep, negative to sleep until a request.
+ * @return true if a shutdown was requested.
+ ******************************************************************************/
+bool app_shutdown_wait(int64_t timeout_us);
+
+/***************************************************************************//**
+ * Sleep until a file descriptor is readable or a shutdown request, for reads
+ * that would block the shutdown, e.g. from a terminal.
+ * @param[in] fd File descriptor to wait for.
+ * @return true if a shutdown was requested.
+ ******************************************************************************/
+bool app_shutdown_wait_readable(int fd);
+
+/***************************************************************************//**
+ * Mark the start of the teardown for the shutdown latency.
+ ******************************************************************************/
+void app_shutdown_begin(void);
+
+/***************************************************************************//**
+ * Print the time from the shutdown request to the end of the teardown.
+ ******************************************************************************/
+void app_shutdown_print(void);
+
+#endif // APP_SHUTDOWN_H
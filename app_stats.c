@@ -0,0 +1,93 @@
+/***************************************************************************//**
+ * @file
+ * @brief Summary statistics helpers.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <math.h>
+#include <stdlib.h>
+#include "app_stats.h"
+
+static int compare_doubles(const void *a, const void *b)
+{
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+
+  return (x > y) - (x < y);
+}
+
+// Sort values in ascending order.
+void app_stats_sort(double *values, size_t count)
+{
+  qsort(values, count, sizeof(*values), compare_doubles);
+}
+
+// Get a percentile of sorted values, using the nearest rank method.
+double app_stats_percentile(const double *sorted, size_t count, double percent)
+{
+  double position = percent / 100.0 * count;
+  size_t rank = (size_t)position;
+
+  if (rank < position) {
+    rank++; // round up
+  }
+  if (rank == 0) {
+    rank = 1;
+  } else if (rank > count) {
+    rank = count;
+  }
+  return sorted[rank - 1];
+}
+
+// Get the Pearson correlation coefficient of two series.
+int app_stats_pearson(const double *x, const double *y, size_t count, double *r)
+{
+  double mean_x = 0;
+  double mean_y = 0;
+  double sxx = 0;
+  double syy = 0;
+  double sxy = 0;
+
+  if (count < 2) {
+    return -1;
+  }
+  for (size_t i = 0; i < count; i++) {
+    mean_x += x[i];
+    mean_y += y[i];
+  }
+  mean_x /= count;
+  mean_y /= count;
+  for (size_t i = 0; i < count; i++) {
+    sxx += (x[i] - mean_x) * (x[i] - mean_x);
+    syy += (y[i] - mean_y) * (y[i] - mean_y);
+    sxy += (x[i] - mean_x) * (y[i] - mean_y);
+  }
+  if (sxx == 0 || syy == 0) {
+    return -1;
+  }
+  *r = sxy / sqrt(sxx * syy);
+  return 0;
+}
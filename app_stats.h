@@ -0,0 +1,61 @@
+/***************************************************************************//**
+ * @file
+ * @brief Summary statistics helpers.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_STATS_H
+#define APP_STATS_H
+
+#include <stddef.h>
+
+/***************************************************************************//**
+ * Sort values in ascending order, as needed by app_stats_percentile().
+ * @param[in,out] values Values to sort.
+ * @param[in] count Number of values.
+ ******************************************************************************/
+void app_stats_sort(double *values, size_t count);
+
+/***************************************************************************//**
+ * Get a percentile of sorted values, using the nearest rank method.
+ * @param[in] sorted Values sorted in ascending order.
+ * @param[in] count Number of values, at least 1.
+ * @param[in] percent Percentile, 0-100.
+ * @return Value at the percentile.
+ ******************************************************************************/
+double app_stats_percentile(const double *sorted, size_t count, double percent);
+
+/***************************************************************************//**
+ * Get the Pearson correlation coefficient of two series.
+ * @param[in] x First series.
+ * @param[in] y Second series.
+ * @param[in] count Number of value pairs.
+ * @param[out] r Correlation coefficient, -1 to 1.
+ * @return 0 on success, -1 if fewer than 2 pairs or a series is constant.
+ ******************************************************************************/
+int app_stats_pearson(const double *x, const double *y, size_t count, double *r);
+
+#endif // APP_STATS_H
@@ -0,0 +1,256 @@
+/***************************************************************************//**
+ * @file
+ * @brief Channel occupancy survey statistics.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include "app_metrics.h"
+#include "app_survey.h"
+
+#define ADV_CHANNELS 3
+
+// RF channels of the advertising channels 37, 38 and 39
+static const uint8_t adv_rf_channels[ADV_CHANNELS] = { 0, 12, 39 };
+
+typedef struct {
+  uint64_t dtm_packets;
+  uint64_t dwell_us;
+  uint32_t sweep_packets;   // DTM packets of the current sweep
+  uint32_t sweep_dwell_us;
+  uint32_t adv_reports;
+  uint32_t sweep_adv_reports;
+  uint32_t busy_adv_reports; // at or above APP_SURVEY_BUSY_RSSI
+  int64_t rssi_sum;
+  int8_t rssi_max;
+} channel_stats_t;
+
+static channel_stats_t stats[APP_SURVEY_CHANNELS];
+static uint64_t scan_us = 0;
+static uint32_t sweep_scan_us = 0;
+static uint32_t sweep_count = 0;
+
+static bool is_adv_channel(uint8_t rf_channel)
+{
+  return rf_channel == adv_rf_channels[0] || rf_channel == adv_rf_channels[1]
+         || rf_channel == adv_rf_channels[2];
+}
+
+// Packets per second of a channel: DTM packets over the receive time, plus
+// advertising reports over the channel's share of the scan time.
+static double channel_rate(uint64_t dtm_packets, uint64_t dwell_us,
+                           uint32_t adv_reports, uint64_t adv_us)
+{
+  double rate = dwell_us ? dtm_packets * 1e6 / dwell_us : 0;
+
+  if (adv_us != 0) {
+    rate += adv_reports * 1e6 * ADV_CHANNELS / adv_us;
+  }
+  return rate;
+}
+
+// Get the RF channel of a BLE channel index.
+uint8_t app_survey_rf_channel(uint8_t ble_channel)
+{
+  if (ble_channel >= 37 && ble_channel <= 39) {
+    return adv_rf_channels[ble_channel - 37];
+  }
+  if (ble_channel <= 10) {
+    return ble_channel + 1;
+  }
+  if (ble_channel <= 36) {
+    return ble_channel + 2;
+  }
+  return 0xFF;
+}
+
+// Add the result of a DTM receive dwell.
+void app_survey_add_dtm(uint8_t rf_channel, uint16_t packets, uint32_t dwell_us)
+{
+  if (rf_channel >= APP_SURVEY_CHANNELS) {
+    return;
+  }
+  stats[rf_channel].dtm_packets += packets;
+  stats[rf_channel].dwell_us += dwell_us;
+  stats[rf_channel].sweep_packets += packets;
+  stats[rf_channel].sweep_dwell_us += dwell_us;
+}
+
+// Add an advertising report.
+void app_survey_add_adv(uint8_t ble_channel, int8_t rssi)
+{
+  uint8_t rf_channel = app_survey_rf_channel(ble_channel);
+  channel_stats_t *ch;
+
+  if (rf_channel >= APP_SURVEY_CHANNELS || !is_adv_channel(rf_channel)) {
+    return;
+  }
+  ch = &stats[rf_channel];
+  if (ch->adv_reports == 0 || rssi > ch->rssi_max) {
+    ch->rssi_max = rssi;
+  }
+  ch->adv_reports++;
+  ch->sweep_adv_reports++;
+  ch->rssi_sum += rssi;
+  if (rssi >= APP_SURVEY_BUSY_RSSI) {
+    ch->busy_adv_reports++;
+  }
+}
+
+// Add the length of a scanner window.
+void app_survey_add_scan_time(uint32_t window_us)
+{
+  scan_us += window_us;
+  sweep_scan_us += window_us;
+}
+
+// End a sweep and print its line.
+void app_survey_end_sweep(void)
+{
+  char heat[APP_SURVEY_CHANNELS + 1];
+  channel_stats_t *ch;
+  double rate;
+  double busiest_rate = 0;
+  int busiest = -1;
+
+  // one character per channel: ' ' nothing received, '.' < 10/s, '-' < 100/s,
+  // '+' < 500/s, '#' more
+  for (uint8_t i = 0; i < APP_SURVEY_CHANNELS; i++) {
+    ch = &stats[i];
+    rate = channel_rate(ch->sweep_packets, ch->sweep_dwell_us,
+                        ch->sweep_adv_reports, is_adv_channel(i) ? sweep_scan_us : 0);
+    heat[i] = (rate == 0) ? ' ' : (rate < 10) ? '.' : (rate < 100) ? '-'
+              : (rate < 500) ? '+' : '#';
+    if (rate > busiest_rate) {
+      busiest_rate = rate;
+      busiest = i;
+    }
+    ch->sweep_packets = 0;
+    ch->sweep_dwell_us = 0;
+    ch->sweep_adv_reports = 0;
+  }
+  heat[APP_SURVEY_CHANNELS] = '\0';
+  sweep_scan_us = 0;
+
+  if (sweep_count == 0) {
+    printf("  channel  0         1         2         3\n");
+    printf("           0123456789012345678901234567890123456789\n");
+  }
+  sweep_count++;
+  printf("  %5u   [%s]", sweep_count, heat);
+  if (busiest >= 0) {
+    printf(" busiest %u (%.0f/s)", busiest, busiest_rate);
+  }
+  printf("\n");
+  fflush(stdout);
+}
+
+// Check if no DTM packets or strong advertisements were seen in any sweep.
+bool app_survey_no_traffic_seen(uint8_t rf_channel)
+{
+  if (rf_channel >= APP_SURVEY_CHANNELS) {
+    return false;
+  }
+  return stats[rf_channel].dtm_packets == 0 && stats[rf_channel].busy_adv_reports == 0;
+}
+
+// Find the data channel with the lowest DTM packet rate.
+static int least_dtm_channel(void)
+{
+  double rate;
+  double best_rate = 0;
+  int best = -1;
+
+  for (uint8_t i = 0; i < APP_SURVEY_CHANNELS; i++) {
+    if (is_adv_channel(i)) {
+      continue;
+    }
+    rate = channel_rate(stats[i].dtm_packets, stats[i].dwell_us, 0, 0);
+    if (best < 0 || rate < best_rate) {
+      best_rate = rate;
+      best = i;
+    }
+  }
+  return best;
+}
+
+// Set the survey metrics.
+void app_survey_publish(void)
+{
+  unsigned quiet = 0;
+
+  if (sweep_count == 0) {
+    return;
+  }
+  for (uint8_t i = 0; i < APP_SURVEY_CHANNELS; i++) {
+    if (app_survey_no_traffic_seen(i)) {
+      quiet++;
+    }
+  }
+  app_metrics_set_counter("survey_sweeps", sweep_count);
+  app_metrics_set_gauge("survey_no_traffic_channels", quiet);
+  app_metrics_set_gauge("survey_least_dtm_channel", least_dtm_channel());
+}
+
+// Print the per-channel totals and the channels without traffic seen.
+void app_survey_print(void)
+{
+  channel_stats_t *ch;
+  unsigned quiet = 0;
+
+  if (sweep_count == 0) {
+    return;
+  }
+  printf("\nChannel survey over %u sweeps:\n", sweep_count);
+  printf("  ch  MHz  dwell[s]  DTM pkt/s  adv rep/s  RSSI mean  RSSI max  no DTM/adv seen\n");
+  for (uint8_t i = 0; i < APP_SURVEY_CHANNELS; i++) {
+    ch = &stats[i];
+    printf("  %2u %4u %9.2f %10.1f", i, 2402 + 2 * i, ch->dwell_us / 1e6,
+           ch->dwell_us ? ch->dtm_packets * 1e6 / ch->dwell_us : 0);
+    if (is_adv_channel(i) && ch->adv_reports != 0) {
+      printf(" %10.1f %10.1f %9d", channel_rate(0, 0, ch->adv_reports, scan_us),
+             (double)ch->rssi_sum / ch->adv_reports, ch->rssi_max);
+    } else if (is_adv_channel(i)) {
+      printf(" %10.1f %10s %9s", 0.0, "-", "-");
+    } else {
+      printf(" %10s %10s %9s", "", "", "");
+    }
+    printf("  %s\n", app_survey_no_traffic_seen(i) ? "yes" : "no");
+  }
+  printf("No DTM/adv traffic seen on channels:");
+  for (uint8_t i = 0; i < APP_SURVEY_CHANNELS; i++) {
+    if (app_survey_no_traffic_seen(i)) {
+      printf(" %u", i);
+      quiet++;
+    }
+  }
+  printf(quiet == 0 ? " none\n" : "\n");
+  printf("Only DTM packets and BLE advertisements are detected, so these channels are not\n"
+         "necessarily clean: Wi-Fi, BLE connections and other interference are not seen\n");
+  if (least_dtm_channel() >= 0) {
+    printf("Data channel with the fewest DTM packets: %d\n", least_dtm_channel());
+  }
+}
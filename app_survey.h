@@ -0,0 +1,100 @@
+/***************************************************************************//**
+ * @file
+ * @brief Channel occupancy survey statistics.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_SURVEY_H
+#define APP_SURVEY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// RF channels, 2402 MHz + 2 MHz * channel as for DTM.
+#define APP_SURVEY_CHANNELS 40
+// Advertising reports at or above this RSSI make an advertising channel busy.
+#define APP_SURVEY_BUSY_RSSI -60
+
+/***************************************************************************//**
+ * Get the RF channel of a BLE channel index.
+ * @param[in] ble_channel Channel index, 0-36 data channels, 37-39
+ *   advertising channels.
+ * @return RF channel, 0-39. 0xFF for an invalid index.
+ ******************************************************************************/
+uint8_t app_survey_rf_channel(uint8_t ble_channel);
+
+/***************************************************************************//**
+ * Add the result of a DTM receive dwell.
+ * @param[in] rf_channel RF channel.
+ * @param[in] packets DTM packets received.
+ * @param[in] dwell_us Time the receiver was on.
+ ******************************************************************************/
+void app_survey_add_dtm(uint8_t rf_channel, uint16_t packets, uint32_t dwell_us);
+
+/***************************************************************************//**
+ * Add an advertising report received during a scanner window.
+ * @param[in] ble_channel Channel index of the report, 37-39.
+ * @param[in] rssi Signal strength in dBm.
+ ******************************************************************************/
+void app_survey_add_adv(uint8_t ble_channel, int8_t rssi);
+
+/***************************************************************************//**
+ * Add the length of a scanner window. The scanner hops over the three
+ * advertising channels, so each one gets a third of it.
+ * @param[in] window_us Time the scanner was on.
+ ******************************************************************************/
+void app_survey_add_scan_time(uint32_t window_us);
+
+/***************************************************************************//**
+ * End a sweep over all channels and print it as one line of the live table,
+ * with the column header before the first sweep.
+ ******************************************************************************/
+void app_survey_end_sweep(void);
+
+/***************************************************************************//**
+ * Check if no traffic was seen on a channel in any sweep: no DTM packets and,
+ * on the advertising channels, no reports at or above APP_SURVEY_BUSY_RSSI.
+ * Other traffic, e.g. Wi-Fi or BLE connections, is not detected, so this
+ * doesn't mean the channel is clean.
+ * @param[in] rf_channel RF channel.
+ * @return true if no DTM or advertising traffic was seen.
+ ******************************************************************************/
+bool app_survey_no_traffic_seen(uint8_t rf_channel);
+
+/***************************************************************************//**
+ * Set the survey results as metrics: sweeps, the number of channels without
+ * DTM or advertising traffic seen and the data channel with the fewest DTM
+ * packets.
+ ******************************************************************************/
+void app_survey_publish(void);
+
+/***************************************************************************//**
+ * Print the per-channel totals and the list of channels without DTM or
+ * advertising traffic seen, with the limits of the survey.
+ ******************************************************************************/
+void app_survey_print(void);
+
+#endif // APP_SURVEY_H
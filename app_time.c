@@ -0,0 +1,49 @@
+/***************************************************************************//**
+ * @file
+ * @brief Monotonic time helpers shared by the test modes.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <time.h>
+#include "app_time.h"
+
+// Get the current time from the monotonic clock.
+int64_t app_time_mono_us(void)
+{
+  struct timespec tms;
+
+  clock_gettime(CLOCK_MONOTONIC, &tms);
+  return (int64_t)tms.tv_sec * 1000000 + tms.tv_nsec / 1000;
+}
+
+// Get the current wall clock time.
+int64_t app_time_wall_us(void)
+{
+  struct timespec tms;
+
+  clock_gettime(CLOCK_REALTIME, &tms);
+  return (int64_t)tms.tv_sec * 1000000 + tms.tv_nsec / 1000;
+}
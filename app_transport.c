@@ -0,0 +1,216 @@
+/***************************************************************************//**
+ * @file
+ * @brief Buffered NCP link I/O with coalesced writes.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "sl_bt_api.h"
+#include "sl_bt_ncp_host.h"
+#include "app_transport.h"
+
+typedef struct {
+  uint64_t tx_frames;
+  uint64_t tx_bytes;
+  uint64_t tx_writes;
+  uint64_t rx_frames;
+  uint64_t rx_bytes;
+  uint64_t rx_reads;
+} link_stats_t;
+
+static bool enabled = false;
+static link_stats_t stats;
+
+// Transport functions installed before app_transport_init(), normally the
+// SDK's own, which owns the link and any bytes it has buffered.
+static tx_func next_output;
+static rx_func next_input;
+static rx_peek_func next_peek;
+
+static uint8_t rx_buf[APP_TRANSPORT_RX_BUFFER_SIZE];
+static size_t rx_start = 0;
+static size_t rx_len = 0;
+// Bytes left of the frame being counted in the received stream.
+static uint8_t rx_header[SL_BGAPI_MSG_HEADER_LEN];
+static uint32_t rx_header_len = 0;
+static uint32_t rx_payload_left = 0;
+
+static uint8_t tx_buf[APP_TRANSPORT_TX_BUFFER_SIZE];
+static size_t tx_len = 0;
+
+// Count the frames in newly received data.
+static void count_frames(const uint8_t *data, size_t len)
+{
+  uint32_t header;
+  size_t skip;
+
+  while (len > 0) {
+    if (rx_payload_left > 0) {
+      skip = (len < rx_payload_left) ? len : rx_payload_left;
+      rx_payload_left -= (uint32_t)skip;
+      data += skip;
+      len -= skip;
+      continue;
+    }
+    rx_header[rx_header_len++] = *data++;
+    len--;
+    if (rx_header_len == SL_BGAPI_MSG_HEADER_LEN) {
+      header = rx_header[0] | (rx_header[1] << 8) | (rx_header[2] << 16)
+               | ((uint32_t)rx_header[3] << 24);
+      rx_header_len = 0;
+      rx_payload_left = SL_BGAPI_MSG_LEN(header);
+      stats.rx_frames++;
+    }
+  }
+}
+
+// Read everything the link has into the receive buffer in one call. If need
+// is not zero and nothing is available, wait for that many bytes.
+static int fill(size_t need)
+{
+  int32_t avail;
+  int32_t ret;
+  size_t len;
+
+  if (rx_start > 0) {
+    memmove(rx_buf, &rx_buf[rx_start], rx_len);
+    rx_start = 0;
+  }
+  if (rx_len == sizeof(rx_buf)) {
+    return 0;
+  }
+  avail = next_peek();
+  if (avail < 0) {
+    return -1;
+  }
+  len = (avail > 0) ? (size_t)avail : need;
+  if (len > sizeof(rx_buf) - rx_len) {
+    len = sizeof(rx_buf) - rx_len;
+  }
+  if (len == 0) {
+    return 0;
+  }
+  ret = next_input((uint32_t)len, &rx_buf[rx_len]);
+  stats.rx_reads++;
+  if (ret <= 0) {
+    return -1;
+  }
+  count_frames(&rx_buf[rx_len], (size_t)ret);
+  rx_len += (size_t)ret;
+  stats.rx_bytes += (uint64_t)ret;
+  return (int)ret;
+}
+
+static void write_all(uint8_t *data, size_t len)
+{
+  next_output((uint32_t)len, data);
+  stats.tx_writes++;
+}
+
+// Write the queued outgoing frames.
+void app_transport_flush(void)
+{
+  if (tx_len > 0) {
+    write_all(tx_buf, tx_len);
+    tx_len = 0;
+  }
+}
+
+static void transport_tx(uint32_t len, uint8_t *data)
+{
+  stats.tx_frames++;
+  stats.tx_bytes += len;
+  if (tx_len + len > sizeof(tx_buf)) {
+    app_transport_flush();
+  }
+  if (len > sizeof(tx_buf)) {
+    write_all(data, len);
+    return;
+  }
+  // queued until the host waits for the NCP, so pipelined commands share
+  // one write
+  memcpy(&tx_buf[tx_len], data, len);
+  tx_len += len;
+}
+
+static int32_t transport_rx(uint32_t len, uint8_t *data)
+{
+  app_transport_flush();
+  while (rx_len < len) {
+    if (fill(len - rx_len) < 0) {
+      return -1;
+    }
+  }
+  memcpy(data, &rx_buf[rx_start], len);
+  rx_start += len;
+  rx_len -= len;
+  return (int32_t)len;
+}
+
+static int32_t transport_peek(void)
+{
+  app_transport_flush();
+  if (fill(0) < 0 && rx_len == 0) {
+    return -1;
+  }
+  return (int32_t)rx_len;
+}
+
+// Buffer the I/O of the NCP link.
+void app_transport_init(void)
+{
+  if (enabled == false) {
+    next_output = sl_bt_api_output;
+    next_input = sl_bt_api_input;
+    next_peek = sl_bt_api_input_peek;
+    sl_bt_api_initialize_nonblock(transport_tx, transport_rx, transport_peek);
+  }
+  enabled = true;
+}
+
+// Check if the NCP link I/O is buffered here.
+bool app_transport_enabled(void)
+{
+  return enabled;
+}
+
+// Print the link counters.
+void app_transport_print(void)
+{
+  if (enabled == false) {
+    return;
+  }
+  printf("NCP link: tx %llu frames, %llu bytes in %llu writes (%.2f writes/frame), "
+         "rx %llu frames, %llu bytes in %llu reads (%.2f reads/frame)\n",
+         (unsigned long long)stats.tx_frames, (unsigned long long)stats.tx_bytes,
+         (unsigned long long)stats.tx_writes,
+         stats.tx_frames ? (double)stats.tx_writes / stats.tx_frames : 0.0,
+         (unsigned long long)stats.rx_frames, (unsigned long long)stats.rx_bytes,
+         (unsigned long long)stats.rx_reads,
+         stats.rx_frames ? (double)stats.rx_reads / stats.rx_frames : 0.0);
+}
@@ -0,0 +1,65 @@
+/***************************************************************************//**
+ * @file
+ * @brief Buffered NCP link I/O with coalesced writes.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef APP_TRANSPORT_H
+#define APP_TRANSPORT_H
+
+#include <stdbool.h>
+
+// Receive buffer size, in bytes.
+#define APP_TRANSPORT_RX_BUFFER_SIZE 65536
+// Outgoing frames are queued up to this many bytes before a write.
+#define APP_TRANSPORT_TX_BUFFER_SIZE 8192
+
+/***************************************************************************//**
+ * Buffer the I/O of the NCP link on top of the SDK transport. Each read takes
+ * everything the link has into a large buffer, so one read can return several
+ * frames, and outgoing frames are queued and written together when the host
+ * next reads from the link. Call right after ncp_host_init(), before other
+ * transport wrappers.
+ ******************************************************************************/
+void app_transport_init(void);
+
+/***************************************************************************//**
+ * Check if the NCP link I/O is buffered here.
+ * @return true after app_transport_init().
+ ******************************************************************************/
+bool app_transport_enabled(void);
+
+/***************************************************************************//**
+ * Write the queued outgoing frames.
+ ******************************************************************************/
+void app_transport_flush(void);
+
+/***************************************************************************//**
+ * Print the frame, read and write counters of the link.
+ ******************************************************************************/
+void app_transport_print(void);
+
+#endif // APP_TRANSPORT_H
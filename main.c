@@ -33,21 +33,21 @@
 #include "system.h"
 #include "app_signal.h"
 #include "app.h"
-
-// Main loop execution status.
-static volatile bool run = true;
+#include "app_shutdown.h"
 
 // Custom signal handler.
 static void signal_handler(int sig)
 {
   (void)sig;
-  run = false;
-  // Deinitialize the application.
-  app_deinit();
+  // Only note the request here, the main loop deinitializes the application.
+  app_shutdown_request();
 }
 
 int main(int argc, char *argv[])
 {
+  if (app_shutdown_init() != SL_STATUS_OK) {
+    return EXIT_FAILURE;
+  }
   // Set up custom signal handler for user interrupt and termination request.
   app_signal(SIGINT, signal_handler);
   app_signal(SIGTERM, signal_handler);
@@ -61,7 +61,7 @@ int main(int argc, char *argv[])
   // task(s) if the kernel is present.
   app_init(argc, argv);
 
-  while (run) {
+  while (!app_shutdown_requested()) {
     // Do not remove this call: Silicon Labs components process action routine
     // must be called from the super loop.
     sl_system_process_action();
@@ -70,5 +70,8 @@ int main(int argc, char *argv[])
     app_process_action();
   }
 
+  // Deinitialize the application.
+  app_deinit();
+
   return EXIT_SUCCESS;
 }
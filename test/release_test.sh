@@ -162,6 +162,29 @@ if [ $COUNT -gt 0 ]; then
 assertion_failure "$TEST_DATA_DIR/advertiser_output.txt"
 assertion_failure "$TEST_DATA_DIR/scanner_output.txt" 
 
+# 5a. Testing an advertising TX power and interval step schedule
+log_message "Test 5a: Performing advertising step schedule test..."
+# Advertiser, two steps of 1.5 seconds, exits after the last step
+"$APP_PATH" -u "$UART1" --adv --adv_steps 100:160:1500,0:320:1500 > "$TEST_DATA_DIR/advertiser_output.txt" 2>&1 &
+PID1=$!
+# Scanner
+"$APP_PATH" -u "$UART2" --advscan --time 2500 > "$TEST_DATA_DIR/scanner_output.txt" 2>&1 &
+PID2=$!
+pid_wait
+# Example line:
+# STEP 1/2 mono_us=8842113501 utc=2026-10-19T09:12:04.511873Z power=10.0 set=10.0 dBm interval=160 (100.000 ms) dwell=1500 ms
+STEPS="$(grep -c '^STEP [12]/2 ' "$TEST_DATA_DIR/advertiser_output.txt")"
+COUNT="$(grep -Foc "MAC $MAC_ADDR1," "$TEST_DATA_DIR/scanner_output.txt" )"
+printf '  Steps logged: %s, target MAC count in scan results %s\n' "${STEPS:-<none>}" "${COUNT:-<none>}"
+if [ $STEPS -eq 2 ] && grep -Fq "Step schedule complete" "$TEST_DATA_DIR/advertiser_output.txt" && [ $COUNT -gt 0 ]; then
+        log_message "SUCCESS: both steps logged, schedule completed and advertiser seen"
+    else
+        log_message "FAILURE: step schedule incomplete or advertiser not seen"
+        exit 1 # Exit on failure
+    fi
+assertion_failure "$TEST_DATA_DIR/advertiser_output.txt"
+assertion_failure "$TEST_DATA_DIR/scanner_output.txt"
+
 # 6. Testing DTM TX->RX
 log_message "Test 6: Performing basic DTM TX->RX test..."
 # DTM RX
@@ -216,6 +239,73 @@ printf '  RX count: %s\n' "${PKT_RX:-<none>}"
 assertion_failure "$TEST_DATA_DIR/tx.txt"
 assertion_failure "$TEST_DATA_DIR/rx.txt"
 
+# 6b. Testing the DTM receive PER against a limit that must pass
+log_message "Test 6b: Performing DTM PER limit test, expecting PASS..."
+# DTM RX, the reference time is the time the transmitter below runs
+"$APP_PATH" -u "$UART2" --time 5000 --rx --per_ref_time 2000 --per_limit 30.8 > "$TEST_DATA_DIR/rx.txt" 2>&1 &
+PID1=$!
+# DTM TX
+"$APP_PATH" -u "$UART1" --time 2000 --packet_type 0 > "$TEST_DATA_DIR/tx.txt" 2>&1 &
+PID2=$!
+wait $PID1
+RX_STATUS=$?
+wait $PID2
+# Example line:
+# PER limit 30.80%: PASS
+grep '^PER' "$TEST_DATA_DIR/rx.txt"
+if [ $RX_STATUS -eq 0 ] && grep -Eq '^PER limit 30\.80%: PASS' "$TEST_DATA_DIR/rx.txt"; then
+        log_message "SUCCESS: PER within the limit and exit status 0"
+    else
+        log_message "FAILURE: PER verdict not PASS or exit status $RX_STATUS"
+        exit 1 # Exit on failure
+    fi
+assertion_failure "$TEST_DATA_DIR/tx.txt"
+assertion_failure "$TEST_DATA_DIR/rx.txt"
+
+# 6c. Testing the DTM receive PER against a limit that must fail
+log_message "Test 6c: Performing DTM PER limit test, expecting FAIL..."
+# DTM RX, claiming twice the time the transmitter runs gives a PER near 50%
+"$APP_PATH" -u "$UART2" --time 5000 --rx --per_ref_time 4000 --per_limit 30.8 > "$TEST_DATA_DIR/rx.txt" 2>&1 &
+PID1=$!
+# DTM TX
+"$APP_PATH" -u "$UART1" --time 2000 --packet_type 0 > "$TEST_DATA_DIR/tx.txt" 2>&1 &
+PID2=$!
+wait $PID1
+RX_STATUS=$?
+wait $PID2
+grep '^PER' "$TEST_DATA_DIR/rx.txt"
+if [ $RX_STATUS -ne 0 ] && grep -Eq '^PER limit 30\.80%: FAIL' "$TEST_DATA_DIR/rx.txt"; then
+        log_message "SUCCESS: PER above the limit and exit status not 0"
+    else
+        log_message "FAILURE: PER verdict not FAIL or exit status $RX_STATUS"
+        exit 1 # Exit on failure
+    fi
+assertion_failure "$TEST_DATA_DIR/tx.txt"
+assertion_failure "$TEST_DATA_DIR/rx.txt"
+
+# 6d. Testing the channel survey against a DTM transmitter
+log_message "Test 6d: Performing channel survey test..."
+# Survey
+"$APP_PATH" -u "$UART2" --survey --time 4000 > "$TEST_DATA_DIR/survey.txt" 2>&1 &
+PID1=$!
+# DTM TX on channel 19 (2440 MHz)
+"$APP_PATH" -u "$UART1" --time 2000 --packet_type 0 --channel 19 > "$TEST_DATA_DIR/tx.txt" 2>&1 &
+PID2=$!
+pid_wait
+# Example line:
+#   19 2440      0.20     1600.0                                  no
+RATE="$(awk '$1 == 19 && $2 == 2440 { print $4; exit }' "$TEST_DATA_DIR/survey.txt")"
+SWEEPS="$(sed -n -E 's/^Channel survey over ([0-9]+) sweeps:$/\1/p' "$TEST_DATA_DIR/survey.txt")"
+printf '  Sweeps: %s, DTM packets/s on channel 19: %s\n' "${SWEEPS:-<none>}" "${RATE:-<none>}"
+if [ "${SWEEPS:-0}" -gt 0 ] && awk -v rate="${RATE:-0}" 'BEGIN { exit !(rate > 0) }'; then
+        log_message "SUCCESS: survey completed and saw the DTM transmitter on channel 19"
+    else
+        log_message "FAILURE: survey incomplete or DTM transmitter not seen on channel 19"
+        exit 1 # Exit on failure
+    fi
+assertion_failure "$TEST_DATA_DIR/tx.txt"
+assertion_failure "$TEST_DATA_DIR/survey.txt"
+
 # 7. Testing CTUNE read/write
 "$APP_PATH" -u "$UART1" --time 1 --ctune_set 0x1a5 > "$TEST_DATA_DIR/ctune.txt" 2>&1
 check_success "CTUNE set"
@@ -248,6 +338,19 @@ if [ $LEN -eq 1 ] && [ "$PAYLOAD" = "04" ]; then
         exit 1 # Exit on failure
     fi
 
+# 8a. Testing custom BGAPI script with pipelining
+log_message "Test 8a: Performing custom BGAPI script test..."
+printf '04 04\n04 04\n04 04\n04 04\n' > "$TEST_DATA_DIR/cust_script.txt"
+"$APP_PATH" -u "$UART1" --cust_script "$TEST_DATA_DIR/cust_script.txt" --cust_depth 2 > "$TEST_DATA_DIR/cust_script_output.txt" 2>&1
+check_success "custom BGAPI script"
+COUNT="$(grep -c 'PASS$' "$TEST_DATA_DIR/cust_script_output.txt")"
+if [ $COUNT -eq 4 ]; then
+        log_message "SUCCESS: all custom script commands passed"
+    else
+        log_message "FAILURE: custom script commands passed: $COUNT of 4"
+        exit 1 # Exit on failure
+    fi
+
 # 9. Testing throughput / GATT connection
 log_message "Test 9: Testing throughput / GATT connection..."
 # Advertiser (20 seconds)
@@ -268,6 +371,78 @@ if [ $COUNT -gt 5 ]; then
         exit 1 # Exit on failure
     fi
 
+# 9a. Testing throughput over an L2CAP connection-oriented channel
+log_message "Test 9a: Testing throughput over L2CAP..."
+# Advertiser accepting the channel (20 seconds)
+"$APP_PATH" -u "$UART1" --adv --l2cap --time 20000 > "$TEST_DATA_DIR/advertiser_output.txt" 2>&1 &
+PID1=$!
+"$APP_PATH" -u "$UART2" --conn="$MAC_ADDR1" --l2cap --time 5000 --report 500 > "$TEST_DATA_DIR/central_output.txt" 2>&1
+check_success "L2CAP throughput test connection established"
+log_message "waiting for background PID"
+wait $PID1
+assertion_failure "$TEST_DATA_DIR/advertiser_output.txt" # check advertiser log for assertion
+assertion_failure "$TEST_DATA_DIR/central_output.txt"
+COUNT="$(grep -Foc "Throughput since last report" "$TEST_DATA_DIR/central_output.txt" )"
+# Example line:
+# L2CAP sent: 3120 SDUs, 764400 bytes
+SDUS="$(sed -n -E 's/^L2CAP sent: ([0-9]+) SDUs.*/\1/p' "$TEST_DATA_DIR/central_output.txt" | head -n1)"
+printf 'Number of throughput reports observed: %s, SDUs sent: %s\n' "${COUNT:-<none>}" "${SDUS:-<none>}"
+if [ $COUNT -gt 5 ] && [ "${SDUS:-0}" -gt 0 ]; then
+        log_message "SUCCESS: 5 or more L2CAP throughput reports observed and SDUs sent"
+    else
+        log_message "Failure: Less than 5 L2CAP throughput reports observed or no SDUs sent"
+        exit 1 # Exit on failure
+    fi
+
+# 9b. Testing throughput over an encrypted link
+log_message "Test 9b: Testing throughput with LE Secure Connections encryption..."
+# Advertiser requiring encryption (20 seconds)
+"$APP_PATH" -u "$UART1" --adv --encrypt sc --time 20000 > "$TEST_DATA_DIR/advertiser_output.txt" 2>&1 &
+PID1=$!
+"$APP_PATH" -u "$UART2" --conn="$MAC_ADDR1" --encrypt sc --time 5000 --report 500 --throughput 0 > "$TEST_DATA_DIR/central_output.txt" 2>&1
+check_success "encrypted throughput test completed without pairing failures"
+log_message "waiting for background PID"
+wait $PID1
+assertion_failure "$TEST_DATA_DIR/advertiser_output.txt" # check advertiser log for assertion
+assertion_failure "$TEST_DATA_DIR/central_output.txt"
+# Example lines:
+# Link encrypted with unauthenticated encryption after 118.4 ms
+# Throughput with unauthenticated encryption (level 2): 183673.47 bps over 19.6 s
+grep -E '^(Link encrypted|Throughput with)' "$TEST_DATA_DIR/central_output.txt"
+if grep -Eq '^Link encrypted with .* after [0-9.]+ ms' "$TEST_DATA_DIR/central_output.txt" \
+    && grep -Eq '^Throughput with .* \(level [2-4]\): [0-9.]+ bps' "$TEST_DATA_DIR/central_output.txt"; then
+        log_message "SUCCESS: link encrypted and throughput measured at an encrypted level"
+    else
+        log_message "FAILURE: link not encrypted or no encrypted throughput reported"
+        exit 1 # Exit on failure
+    fi
+
+# 9c. Testing GATT round trip latency
+log_message "Test 9c: Testing GATT round trip latency..."
+# Advertiser (20 seconds)
+"$APP_PATH" -u "$UART1" --adv --time 20000 > "$TEST_DATA_DIR/advertiser_output.txt" 2>&1 &
+PID1=$!
+"$APP_PATH" -u "$UART2" --conn="$MAC_ADDR1" --gatt_ping 100 --time 15000 > "$TEST_DATA_DIR/central_output.txt" 2>&1
+check_success "GATT round trip test completed"
+log_message "waiting for background PID"
+wait $PID1
+assertion_failure "$TEST_DATA_DIR/advertiser_output.txt" # check advertiser log for assertion
+assertion_failure "$TEST_DATA_DIR/central_output.txt"
+# Example lines:
+#   read     50    23.01    33.49    41.19    65.29    74.13
+#   write    50    23.03    33.19    41.51    73.32    82.81
+READS="$(awk '$1 == "read" && $2 ~ /^[0-9]+$/ { print $2; exit }' "$TEST_DATA_DIR/central_output.txt")"
+WRITES="$(awk '$1 == "write" && $2 ~ /^[0-9]+$/ { print $2; exit }' "$TEST_DATA_DIR/central_output.txt")"
+printf 'Round trips timed: read %s, write %s\n' "${READS:-<none>}" "${WRITES:-<none>}"
+if grep -Fq "GATT round trip test complete" "$TEST_DATA_DIR/central_output.txt" \
+    && [ "${READS:-0}" -eq 50 ] && [ "${WRITES:-0}" -eq 50 ] \
+    && ! grep -Eq '^  (read|write) +[0-9]+ errors' "$TEST_DATA_DIR/central_output.txt"; then
+        log_message "SUCCESS: all 100 GATT round trips timed without errors"
+    else
+        log_message "FAILURE: GATT round trip test incomplete or with errors"
+        exit 1 # Exit on failure
+    fi
+
 # 10. Test setting custom MAC address
 log_message "Test 10: Performing custom MAC address test..."
 "$APP_PATH" -u "$UART1" --addr_set 01:02:03:04:05:06 --time 1 > "$TEST_DATA_DIR/basic_output.txt" 2>&1